@@ -16,7 +16,9 @@ INPUT_STREAM = "testInputs/test_video.mp4"
 print(os.path.exists(INPUT_STREAM))
 
 
-CPU_EXTENSION = "./intel/openvino/deployment_tools/inference_engine/lib/intel64/libcpu_extension_sse4.so"
+# cpu_extension as built by inference_engine/samples/build_samples.sh, override with -l or $CPU_EXTENSION
+CPU_EXTENSION = os.environ.get("CPU_EXTENSION", os.path.join(
+    os.path.expanduser("~"), "inference_engine_samples_build/intel64/Release/lib/libcpu_extension.so"))
 PVB_MODEL = "./models/person-vehicle-bike-detection-crossroad-0078.xml"
 
 
@@ -47,11 +49,17 @@ def get_args():
     i_desc = "The location of the input file"
     d_desc = "The device name, if not 'CPU'"
     p_desc = "Publish statistics, if not 'NO'"
+    n_desc = "The number of infer requests kept in flight"
+    s_desc = "The number of CPU throughput streams, AUTO if not set"
+    l_desc = "The CPU extension library"
 
     # -- Create the arguments
     parser.add_argument("-i", help=i_desc, default=INPUT_STREAM)
     parser.add_argument("-d", help=d_desc, default='CPU')
     parser.add_argument("-p", help=d_desc, default='NO')
+    parser.add_argument("-n", help=n_desc, type=int, default=4)
+    parser.add_argument("-s", help=s_desc, type=int, default=None)
+    parser.add_argument("-l", help=l_desc, default=CPU_EXTENSION)
     args = parser.parse_args()
 
     return args
@@ -123,7 +131,7 @@ def infer_on_video(args, model):
     plugin = Network()
 
     # Load the network model into the IE
-    plugin.load_model(model, args.d, CPU_EXTENSION)
+    plugin.load_model(model, args.d, args.l, args.n, args.s)
     net_input_shape = plugin.get_input_shape()
 
     # Get and open video capture
@@ -150,25 +158,11 @@ def infer_on_video(args, model):
     out = cv2.VideoWriter(outVideoName, 0x00000021, 30, (width,height))
 
 
-    # Process frames until the video ends, or process is exited
-    while cap.isOpened():
-        # Read the next frame
-        flag, frame = cap.read()
-        if not flag:
-            break
-        key_pressed = cv2.waitKey(60)
+    def process_results(results):
+        for frame, result in results:
+            if result is None:
+                continue
 
-        # Pre-process the frame
-        p_frame = cv2.resize(frame, (net_input_shape[3], net_input_shape[2]))
-        p_frame = p_frame.transpose((2,0,1))
-        p_frame = p_frame.reshape(1, *p_frame.shape)
-
-        # Perform inference on the frame
-        plugin.async_inference(p_frame)
-
-        # Get the output of inference
-        if plugin.wait() == 0:
-            result = plugin.extract_output()
             # Draw the output mask onto the input
             out_frame, classes = draw_boxes(frame, result, args, width, height)
             class_names = get_class_names(classes)
@@ -177,7 +171,7 @@ def infer_on_video(args, model):
 
             # write out the frame
             out.write(out_frame_local)
-            
+
             #Send the class names and speed to the MQTT server
             # publish class
             if args.p == "YES":
@@ -203,17 +197,37 @@ def infer_on_video(args, model):
 
                 client.publish("vehicule_counter", personCount)
 
-        if args.p == "YES":
-            #Send frame to the ffmpeg server
-            sys.stdout.buffer.write(out_frame)  
-            sys.stdout.flush()
-        
-        
+                #Send frame to the ffmpeg server
+                sys.stdout.buffer.write(out_frame)
+                sys.stdout.flush()
+
+    # Process frames until the video ends, or process is exited
+    while cap.isOpened():
+        # Read the next frame
+        flag, frame = cap.read()
+        if not flag:
+            break
+        key_pressed = cv2.waitKey(1)
+
+        # Pre-process the frame
+        p_frame = cv2.resize(frame, (net_input_shape[3], net_input_shape[2]))
+        p_frame = p_frame.transpose((2,0,1))
+        p_frame = p_frame.reshape(1, *p_frame.shape)
+
+        # Perform inference on the frame, up to args.n frames in flight
+        plugin.submit_frame(p_frame, frame)
+
+        # Handle the frames whose inference is over, in order
+        process_results(plugin.poll_completed())
 
         # Break if escape key pressed
         if key_pressed == 27:
             break
 
+    # Wait for the frames still in flight
+    while plugin.pending() > 0:
+        process_results(plugin.poll_completed(block=True))
+
     # Release the capture and destroy any OpenCV windows
     cap.release()
     cv2.destroyAllWindows()
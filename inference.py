@@ -7,6 +7,8 @@ the related lesson on the topic.
 import os
 import sys
 import logging as log
+import threading
+from collections import deque
 from openvino.inference_engine import IENetwork, IECore
 
 class Network:
@@ -23,12 +25,23 @@ class Network:
         self.exec_network = None
         self.infer_request = None
 
+        # Ring of infer requests used by submit_frame / poll_completed
+        self.num_requests = 0
+        self.free_requests = deque()
+        self.in_flight = {}
+        self.completed = {}
+        self.next_frame_id = 0
+        self.next_output_id = 0
+        self.completed_cv = threading.Condition()
 
-    def load_model(self, model, device="CPU", cpu_extension=None):
+
+    def load_model(self, model, device="CPU", cpu_extension=None,
+                   num_requests=1, num_streams=None):
         '''
         Load the model given IR files.
         Defaults to CPU as device for use in the workspace.
-        Synchronous requests made within.
+        num_requests infer requests are created; on the CPU they are
+        spread over num_streams throughput streams (AUTO if not given).
         '''
         model_xml = model
         model_bin = os.path.splitext(model_xml)[0] + ".bin"
@@ -40,16 +53,28 @@ class Network:
         if cpu_extension and "CPU" in device:
             self.plugin.add_extension(cpu_extension, device)
 
+        # Let several requests run in parallel on the CPU
+        if "CPU" in device and num_requests > 1:
+            streams = str(num_streams) if num_streams else "CPU_THROUGHPUT_AUTO"
+            self.plugin.set_config({"CPU_THROUGHPUT_STREAMS": streams}, "CPU")
+
         # Read the IR as a IENetwork
         self.network = IENetwork(model=model_xml, weights=model_bin)
 
         # Load the IENetwork into the plugin
-        self.exec_network = self.plugin.load_network(self.network, device)
+        self.exec_network = self.plugin.load_network(self.network, device,
+            num_requests=num_requests)
 
         # Get the input layer
         self.input_blob = next(iter(self.network.inputs))
         self.output_blob = next(iter(self.network.outputs))
 
+        # Every request reports back through a completion callback
+        self.num_requests = len(self.exec_network.requests)
+        self.free_requests = deque(range(self.num_requests))
+        for request_id, request in enumerate(self.exec_network.requests):
+            request.set_completion_callback(self._on_completed, request_id)
+
         return
 
 
@@ -60,6 +85,78 @@ class Network:
         return self.network.inputs[self.input_blob].shape
 
 
+    def submit_frame(self, image, user_data=None):
+        '''
+        Starts inference of a preprocessed image on the next free request,
+        blocking while all requests are busy. user_data (e.g. the original
+        frame) is handed back with the result. Returns the frame id.
+        '''
+        with self.completed_cv:
+            while not self.free_requests:
+                self.completed_cv.wait()
+            request_id = self.free_requests.popleft()
+            frame_id = self.next_frame_id
+            self.next_frame_id += 1
+            self.in_flight[request_id] = (frame_id, user_data)
+
+        self.exec_network.requests[request_id].async_infer(
+            {self.input_blob: image})
+
+        return frame_id
+
+
+    def poll_completed(self, block=False):
+        '''
+        Returns the (user_data, output) pairs of the finished frames, in
+        submission order. With block=True, waits for at least one frame
+        unless nothing is in flight.
+        '''
+        results = []
+        with self.completed_cv:
+            if block:
+                while (self.next_output_id not in self.completed
+                       and self.next_output_id < self.next_frame_id):
+                    self.completed_cv.wait()
+            while self.next_output_id in self.completed:
+                results.append(self.completed.pop(self.next_output_id))
+                self.next_output_id += 1
+
+        return results
+
+
+    def pending(self):
+        '''
+        Number of submitted frames not returned by poll_completed yet.
+        '''
+        with self.completed_cv:
+            return self.next_frame_id - self.next_output_id
+
+
+    def _on_completed(self, status, request_id):
+        '''
+        Completion callback: copies the output out of the request and puts
+        the request back into the ring.
+        '''
+        with self.completed_cv:
+            frame_id, user_data = self.in_flight.pop(request_id, (None, None))
+        if frame_id is None:
+            # request started through async_inference
+            return
+
+        output = None
+        if status == 0:
+            output = self.exec_network.requests[request_id] \
+                .outputs[self.output_blob].copy()
+        else:
+            log.error("Request {} failed with status code {}".format(
+                request_id, status))
+
+        with self.completed_cv:
+            self.completed[frame_id] = (user_data, output)
+            self.free_requests.append(request_id)
+            self.completed_cv.notify_all()
+
+
     def async_inference(self, image):
         '''
         Makes an asynchronous inference request, given an input image.
@@ -37,6 +37,10 @@ static const char infer_requests_count_message[] = "Optional. Number of infer re
 /// @brief message for execution time
 static const char execution_time_message[] = "Optional. Time in seconds to execute topology.";
 
+/// @brief message for warm-up iterations
+static const char warmup_message[] = "Optional. Number of warm-up iterations run before measurements. They are excluded from "
+                                     "latency and throughput statistics. Default value is 1.";
+
 /// @brief message for #threads for CPU inference
 static const char infer_num_threads_message[] = "Optional. Number of threads to use for inference on the CPU "
                                                 "(including HETERO and MULTI cases).";
@@ -120,6 +124,9 @@ DEFINE_uint32(niter, 0, iterations_count_message);
 /// @brief Time to execute topology in seconds
 DEFINE_uint32(t, 0, execution_time_message);
 
+/// @brief Number of warm-up iterations excluded from statistics
+DEFINE_uint32(warmup, 1, warmup_message);
+
 /// @brief Number of infer requests in parallel
 DEFINE_uint32(nireq, 0, infer_requests_count_message);
 
@@ -175,6 +182,7 @@ static void showUsage() {
     std::cout << "    -b \"<integer>\"            " << batch_size_message << std::endl;
     std::cout << "    -stream_output            " << stream_output_message << std::endl;
     std::cout << "    -t                        " << execution_time_message << std::endl;
+    std::cout << "    -warmup \"<integer>\"       " << warmup_message << std::endl;
     std::cout << "    -progress                 " << progress_message << std::endl;
     std::cout << std::endl << "  device-specific performance options:" << std::endl;
     std::cout << "    -nstreams \"<integer>\"     " << infer_num_streams_message << std::endl;
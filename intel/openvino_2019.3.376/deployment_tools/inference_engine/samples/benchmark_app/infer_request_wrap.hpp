@@ -16,6 +16,7 @@
 #include <functional>
 
 #include "inference_engine.hpp"
+#include "latency_histogram.hpp"
 #include "statistics_report.hpp"
 
 typedef std::chrono::high_resolution_clock Time;
@@ -83,6 +84,7 @@ public:
                                                                                  std::placeholders::_2)));
             _idleIds.push(id);
         }
+        _requestLatencies.resize(nireq);
         resetTimes();
     }
     ~InferRequestsQueue() = default;
@@ -91,6 +93,10 @@ public:
         _startTime = Time::time_point::max();
         _endTime = Time::time_point::min();
         _latencies.clear();
+        _latencyHistogram.reset();
+        for (auto& histogram : _requestLatencies) {
+            histogram.reset();
+        }
     }
 
     double getDurationInMilliseconds() {
@@ -101,6 +107,8 @@ public:
                         const double latency) {
         std::unique_lock<std::mutex> lock(_mutex);
         _latencies.push_back(latency);
+        _latencyHistogram.record(latency);
+        _requestLatencies[id].record(latency);
         _idleIds.push(id);
         _endTime = std::max(Time::now(), _endTime);
         _cv.notify_one();
@@ -124,6 +132,15 @@ public:
         return _latencies;
     }
 
+    const LatencyHistogram& getLatencyHistogram() const {
+        return _latencyHistogram;
+    }
+
+    /// @brief Latencies of each infer request separately, indexed by request id
+    const std::vector<LatencyHistogram>& getRequestLatencyHistograms() const {
+        return _requestLatencies;
+    }
+
     std::vector<InferReqWrap::Ptr> requests;
 
 private:
@@ -133,4 +150,6 @@ private:
     Time::time_point _startTime;
     Time::time_point _endTime;
     std::vector<double> _latencies;
+    LatencyHistogram _latencyHistogram;
+    std::vector<LatencyHistogram> _requestLatencies;
 };
@@ -0,0 +1,112 @@
+// Copyright (C) 2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+/// @brief Latency recorder with log-linear buckets in the spirit of HdrHistogram.
+/// Values are kept in microseconds with a relative error below 0.2%, so memory does not grow with the
+/// number of recorded iterations and any percentile can be read back.
+class LatencyHistogram {
+public:
+    LatencyHistogram() : _count(0), _sum(0.0),
+                         _min(std::numeric_limits<uint64_t>::max()), _max(0) {}
+
+    /// @brief Records one latency given in milliseconds
+    void record(double latencyMs) {
+        const uint64_t value = static_cast<uint64_t>(std::llround(std::max(latencyMs, 0.0) * 1000.0));
+        const size_t index = bucketIndex(value);
+        if (index >= _counts.size()) {
+            _counts.resize(index + 1, 0);
+        }
+        _counts[index]++;
+        _count++;
+        _sum += latencyMs;
+        _min = std::min(_min, value);
+        _max = std::max(_max, value);
+    }
+
+    void reset() {
+        *this = LatencyHistogram();
+    }
+
+    uint64_t count() const {
+        return _count;
+    }
+
+    double minMs() const {
+        return _count ? toMs(_min) : 0.0;
+    }
+
+    double maxMs() const {
+        return toMs(_max);
+    }
+
+    double meanMs() const {
+        return _count ? _sum / _count : 0.0;
+    }
+
+    /// @brief Smallest recorded latency (up to the bucket precision) that percentile % of iterations do not exceed
+    double percentileMs(double percentile) const {
+        if (_count == 0) {
+            return 0.0;
+        }
+        const uint64_t target = std::max<uint64_t>(1,
+                static_cast<uint64_t>(std::ceil(percentile / 100.0 * static_cast<double>(_count))));
+        uint64_t seen = 0;
+        for (size_t index = 0; index < _counts.size(); index++) {
+            seen += _counts[index];
+            if (seen >= target) {
+                return toMs(std::min(highestEquivalentValue(index), _max));
+            }
+        }
+        return toMs(_max);
+    }
+
+private:
+    // Values below 2^subBucketBits us are exact, every next power of two is split into 2^(subBucketBits - 1) buckets
+    static constexpr unsigned subBucketBits = 10;
+    static constexpr uint64_t subBucketCount = 1ULL << subBucketBits;
+    static constexpr uint64_t subBucketHalfCount = subBucketCount >> 1;
+
+    static unsigned highestBit(uint64_t value) {
+        unsigned bit = 0;
+        while (value >>= 1) {
+            bit++;
+        }
+        return bit;
+    }
+
+    static size_t bucketIndex(uint64_t value) {
+        if (value < subBucketCount) {
+            return static_cast<size_t>(value);
+        }
+        const unsigned shift = highestBit(value) - subBucketBits + 1;
+        return static_cast<size_t>(shift * subBucketHalfCount + (value >> shift));
+    }
+
+    static uint64_t highestEquivalentValue(size_t index) {
+        if (index < subBucketCount) {
+            return index;
+        }
+        const unsigned shift = static_cast<unsigned>(index / subBucketHalfCount) - 1;
+        const uint64_t subBucket = index - shift * subBucketHalfCount;
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    static double toMs(uint64_t valueUs) {
+        return static_cast<double>(valueUs) * 0.001;
+    }
+
+    std::vector<uint64_t> _counts;
+    uint64_t _count;
+    double _sum;
+    uint64_t _min;
+    uint64_t _max;
+};
@@ -414,15 +414,18 @@ int main(int argc, char *argv[]) {
         next_step(ss.str());
 
         // warming up - out of scope
-        auto inferRequest = inferRequestsQueue.getIdleRequest();
-        if (!inferRequest) {
-            THROW_IE_EXCEPTION << "No idle Infer Requests!";
-        }
+        InferReqWrap::Ptr inferRequest;
+        for (uint32_t warmupIteration = 0; warmupIteration < FLAGS_warmup; warmupIteration++) {
+            inferRequest = inferRequestsQueue.getIdleRequest();
+            if (!inferRequest) {
+                THROW_IE_EXCEPTION << "No idle Infer Requests!";
+            }
 
-        if (FLAGS_api == "sync") {
-            inferRequest->infer();
-        } else {
-            inferRequest->startAsync();
+            if (FLAGS_api == "sync") {
+                inferRequest->infer();
+            } else {
+                inferRequest->startAsync();
+            }
         }
         inferRequestsQueue.waitAll();
         inferRequestsQueue.resetTimes();
@@ -468,6 +471,7 @@ int main(int argc, char *argv[]) {
         inferRequestsQueue.waitAll();
 
         double latency = getMedianValue<double>(inferRequestsQueue.getLatencies());
+        const LatencyHistogram& latencyHistogram = inferRequestsQueue.getLatencyHistogram();
         double totalDuration = inferRequestsQueue.getDurationInMilliseconds();
         double fps = (FLAGS_api == "sync") ? batchSize * 1000.0 / latency :
                                              batchSize * 1000.0 * iteration / totalDuration;
@@ -482,7 +486,12 @@ int main(int argc, char *argv[]) {
                 statistics->addParameters(StatisticsReport::Category::EXECUTION_RESULTS,
                                           {
                                             {"latency (ms)", float_to_string(latency)},
+                                            {"latency p90 (ms)", float_to_string(latencyHistogram.percentileMs(90.0))},
+                                            {"latency p99 (ms)", float_to_string(latencyHistogram.percentileMs(99.0))},
+                                            {"latency p99.9 (ms)", float_to_string(latencyHistogram.percentileMs(99.9))},
+                                            {"latency max (ms)", float_to_string(latencyHistogram.maxMs())},
                                           });
+                statistics->addLatencies(latencyHistogram, inferRequestsQueue.getRequestLatencyHistograms());
             }
             statistics->addParameters(StatisticsReport::Category::EXECUTION_RESULTS,
                                       {
@@ -525,8 +534,15 @@ int main(int argc, char *argv[]) {
 
         std::cout << "Count:      " << iteration << " iterations" << std::endl;
         std::cout << "Duration:   " << float_to_string(totalDuration) << " ms" << std::endl;
-        if (device_name.find("MULTI") == std::string::npos)
+        if (device_name.find("MULTI") == std::string::npos) {
             std::cout << "Latency:    " << float_to_string(latency) << " ms" << std::endl;
+            // p50 is the exact median printed above, the histogram would round it to its bucket
+            std::cout << "Latency percentiles: p50 " << float_to_string(latency) << " ms"
+                      << ", p90 " << float_to_string(latencyHistogram.percentileMs(90.0)) << " ms"
+                      << ", p99 " << float_to_string(latencyHistogram.percentileMs(99.0)) << " ms"
+                      << ", p99.9 " << float_to_string(latencyHistogram.percentileMs(99.9)) << " ms"
+                      << ", max " << float_to_string(latencyHistogram.maxMs()) << " ms" << std::endl;
+        }
         std::cout << "Throughput: " << float_to_string(fps) << " FPS" << std::endl;
     } catch (const std::exception& ex) {
         slog::err << ex.what() << slog::endl;
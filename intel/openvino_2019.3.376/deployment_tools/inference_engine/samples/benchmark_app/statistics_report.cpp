@@ -7,9 +7,59 @@
 #include <utility>
 #include <map>
 #include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
 
 #include "statistics_report.hpp"
 
+namespace {
+const std::vector<std::pair<std::string, double>> latencyPercentiles = {
+    {"p50", 50.0}, {"p90", 90.0}, {"p99", 99.0}, {"p99.9", 99.9}
+};
+
+std::string msToString(double value) {
+    std::stringstream ss;
+    ss << std::fixed << std::setprecision(3) << value;
+    return ss.str();
+}
+
+std::string jsonString(const std::string& value) {
+    std::stringstream ss;
+    ss << '"';
+    for (char c : value) {
+        switch (c) {
+            case '"': ss << "\\\""; break;
+            case '\\': ss << "\\\\"; break;
+            case '\n': ss << "\\n"; break;
+            case '\r': ss << "\\r"; break;
+            case '\t': ss << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    ss << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+                       << std::dec << std::setfill(' ');
+                } else {
+                    ss << c;
+                }
+        }
+    }
+    ss << '"';
+    return ss.str();
+}
+
+std::string latencyJson(const LatencyHistogram& histogram) {
+    std::stringstream ss;
+    ss << "{\"count\": " << histogram.count()
+       << ", \"min\": " << msToString(histogram.minMs())
+       << ", \"mean\": " << msToString(histogram.meanMs());
+    for (const auto& percentile : latencyPercentiles) {
+        ss << ", " << jsonString(percentile.first) << ": " << msToString(histogram.percentileMs(percentile.second));
+    }
+    ss << ", \"max\": " << msToString(histogram.maxMs()) << "}";
+    return ss.str();
+}
+}  // namespace
+
 void StatisticsReport::addParameters(const Category &category, const Parameters& parameters) {
     if (_parameters.count(category) == 0)
         _parameters[category] = parameters;
@@ -17,6 +67,12 @@ void StatisticsReport::addParameters(const Category &category, const Parameters&
         _parameters[category].insert(_parameters[category].end(), parameters.begin(), parameters.end());
 }
 
+void StatisticsReport::addLatencies(const LatencyHistogram& total, const std::vector<LatencyHistogram>& perRequest) {
+    _hasLatencies = true;
+    _latency = total;
+    _requestLatencies = perRequest;
+}
+
 void StatisticsReport::dump() {
     CsvDumper dumper(true, _config.report_folder + _separator + "benchmark_report.csv");
 
@@ -50,7 +106,77 @@ void StatisticsReport::dump() {
         dumper.endLine();
     }
 
+    if (_hasLatencies) {
+        dumper << "Latency (ms)";
+        dumper.endLine();
+
+        dumper << "" << "count" << "min" << "mean";
+        for (const auto& percentile : latencyPercentiles) {
+            dumper << percentile.first;
+        }
+        dumper << "max";
+        dumper.endLine();
+
+        auto dump_latency = [ &dumper ] (const std::string& name, const LatencyHistogram& histogram) {
+            dumper << name << histogram.count() << msToString(histogram.minMs()) << msToString(histogram.meanMs());
+            for (const auto& percentile : latencyPercentiles) {
+                dumper << msToString(histogram.percentileMs(percentile.second));
+            }
+            dumper << msToString(histogram.maxMs());
+            dumper.endLine();
+        };
+        dump_latency("all requests", _latency);
+        for (size_t i = 0; i < _requestLatencies.size(); i++) {
+            dump_latency("request " + std::to_string(i), _requestLatencies[i]);
+        }
+        dumper.endLine();
+    }
+
     slog::info << "Statistics report is stored to " << dumper.getFilename() << slog::endl;
+
+    dumpJson();
+}
+
+void StatisticsReport::dumpJson() const {
+    const std::string filename = _config.report_folder + _separator + "benchmark_report.json";
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        slog::warn << "Cannot create " << filename << " file" << slog::endl;
+        return;
+    }
+
+    const std::vector<std::pair<Category, std::string>> sections = {
+        {Category::COMMAND_LINE_PARAMETERS, "command_line_parameters"},
+        {Category::RUNTIME_CONFIG, "configuration_setup"},
+        {Category::EXECUTION_RESULTS, "execution_results"},
+    };
+
+    file << "{";
+    bool firstSection = true;
+    for (const auto& section : sections) {
+        if (!_parameters.count(section.first))
+            continue;
+        file << (firstSection ? "" : ",") << "\n  " << jsonString(section.second) << ": {";
+        bool firstParameter = true;
+        for (const auto& parameter : _parameters.at(section.first)) {
+            file << (firstParameter ? "" : ",") << "\n    "
+                 << jsonString(parameter.first) << ": " << jsonString(parameter.second);
+            firstParameter = false;
+        }
+        file << "\n  }";
+        firstSection = false;
+    }
+    if (_hasLatencies) {
+        file << (firstSection ? "" : ",") << "\n  \"latency_ms\": {\n    \"all_requests\": " << latencyJson(_latency)
+             << ",\n    \"per_request\": [";
+        for (size_t i = 0; i < _requestLatencies.size(); i++) {
+            file << (i ? "," : "") << "\n      " << latencyJson(_requestLatencies[i]);
+        }
+        file << "\n    ]\n  }";
+    }
+    file << "\n}\n";
+
+    slog::info << "Statistics report is stored to " << filename << slog::endl;
 }
 
 void StatisticsReport::dumpPerformanceCountersRequest(CsvDumper& dumper,
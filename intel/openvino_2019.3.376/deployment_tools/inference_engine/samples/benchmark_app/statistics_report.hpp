@@ -14,12 +14,14 @@
 #include <samples/slog.hpp>
 #include <samples/csv_dumper.hpp>
 
+#include "latency_histogram.hpp"
+
 // @brief statistics reports types
 static constexpr char noCntReport[] = "no_counters";
 static constexpr char averageCntReport[] = "average_counters";
 static constexpr char detailedCntReport[] = "detailed_counters";
 
-/// @brief Responsible for collecting of statistics and dumping to .csv file
+/// @brief Responsible for collecting of statistics and dumping to .csv and .json files
 class StatisticsReport {
 public:
     typedef std::map<std::string, InferenceEngine::InferenceEngineProfileInfo> PerformaceCounters;
@@ -53,6 +55,9 @@ public:
 
     void addParameters(const Category &category, const Parameters& parameters);
 
+    /// @brief Adds latency percentiles of all iterations and of every infer request separately
+    void addLatencies(const LatencyHistogram& total, const std::vector<LatencyHistogram>& perRequest);
+
     void dump();
 
     void dumpPerformanceCounters(const std::vector<PerformaceCounters> &perfCounts);
@@ -61,12 +66,19 @@ private:
     void dumpPerformanceCountersRequest(CsvDumper& dumper,
                                         const PerformaceCounters& perfCounts);
 
+    void dumpJson() const;
+
     // configuration of current benchmark execution
     const Config _config;
 
     // parameters
     std::map<Category, Parameters> _parameters;
 
+    // latencies
+    bool _hasLatencies = false;
+    LatencyHistogram _latency;
+    std::vector<LatencyHistogram> _requestLatencies;
+
     // csv separator
     std::string _separator;
 };
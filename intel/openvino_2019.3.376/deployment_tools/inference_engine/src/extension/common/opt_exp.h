@@ -21,6 +21,58 @@
 #define EXP_P4 1.6666665459e-1f
 #define EXP_P5 5.0000001201e-1f
 
+#if defined(HAVE_AVX512F)
+static inline __m512 _avx512_opt_exp_ps(__m512 vsrc) {
+    const __m512 vc_one    = _mm512_set1_ps(1.0f);
+    const __m512 vc_half   = _mm512_set1_ps(0.5f);
+
+    const __m512 vc_exp_hi = _mm512_set1_ps(EXP_HI);
+    const __m512 vc_exp_lo = _mm512_set1_ps(EXP_LO);
+
+    const __m512 vc_log2e  = _mm512_set1_ps(LOG2EF);
+
+    const __m512 vc_exp_c1 = _mm512_set1_ps(EXP_C1);
+    const __m512 vc_exp_c2 = _mm512_set1_ps(EXP_C2);
+
+    const __m512 vc_exp_p0 = _mm512_set1_ps(EXP_P0);
+    const __m512 vc_exp_p1 = _mm512_set1_ps(EXP_P1);
+    const __m512 vc_exp_p2 = _mm512_set1_ps(EXP_P2);
+    const __m512 vc_exp_p3 = _mm512_set1_ps(EXP_P3);
+    const __m512 vc_exp_p4 = _mm512_set1_ps(EXP_P4);
+    const __m512 vc_exp_p5 = _mm512_set1_ps(EXP_P5);
+
+    // 1: shrink to a meaningful range
+    __m512 vsrc0 = _mm512_max_ps(_mm512_min_ps(vsrc, vc_exp_hi), vc_exp_lo);
+
+    // 2. express exp(i) as exp(g + n*log(2))
+    __m512 fx = _mm512_fmadd_ps(vsrc0, vc_log2e, vc_half);
+
+    // 3. get the significand
+    __m512 fx_ = _mm512_cvtepi32_ps(_mm512_cvtps_epi32(fx));
+    __mmask16 mask = _mm512_cmp_ps_mask(fx_, fx, _CMP_GT_OS);
+    fx = _mm512_mask_sub_ps(fx_, mask, fx_, vc_one);
+
+    __m512 x_ = _mm512_fnmadd_ps(fx, vc_exp_c1, vsrc0);
+    x_ = _mm512_fnmadd_ps(fx, vc_exp_c2, x_);
+
+    // 4. rational approximation for exponential of the fractional part:
+    __m512 z = _mm512_mul_ps(x_, x_);
+    __m512 y = _mm512_fmadd_ps(vc_exp_p0, x_, vc_exp_p1);
+    y = _mm512_fmadd_ps(y, x_, vc_exp_p2);
+    y = _mm512_fmadd_ps(y, x_, vc_exp_p3);
+    y = _mm512_fmadd_ps(y, x_, vc_exp_p4);
+    y = _mm512_fmadd_ps(y, x_, vc_exp_p5);
+    y = _mm512_fmadd_ps(y, z, x_);
+    y = _mm512_add_ps(y, vc_one);
+
+    // 5. multiply by power of 2
+    __m512i pow2n = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(fx), _mm512_set1_epi32(0x7f)), 23);
+
+    __m512 vdst = _mm512_mul_ps(y, _mm512_castsi512_ps(pow2n));
+    return vdst;
+}
+#endif
+
 #if defined(HAVE_AVX2)
 static inline __m256 _avx_opt_exp_ps(__m256 vsrc) {
     const __m256 vc_one    = _mm256_set1_ps(1.0f);
@@ -6,123 +6,276 @@
 
 #define USE_FAST_EXP 0
 
+#include "opt_exp.h"
 #if USE_FAST_EXP
 #include "fast_exp.h"
-#else
-
-#include "opt_exp.h"
-
 #endif
 
 #include <cmath>
+#include <algorithm>
 #include "defs.h"
 #include "ie_parallel.hpp"
 
+#if defined(HAVE_AVX512F)
+static inline __m512 _avx512_softmax_exp_ps(__m512 vsrc) {
+    return _avx512_opt_exp_ps(vsrc);
+}
 
+static inline float _avx512_reduce_max(__m512 vsrc) {
+    __m256 vmax = _mm256_max_ps(_mm512_castps512_ps256(vsrc),
+                                _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(vsrc), 1)));
+    __m128 vmax4 = _mm_max_ps(_mm256_castps256_ps128(vmax), _mm256_extractf128_ps(vmax, 1));
+    vmax4 = _mm_max_ps(vmax4, _mm_movehl_ps(vmax4, vmax4));
+    vmax4 = _mm_max_ss(vmax4, _mm_shuffle_ps(vmax4, vmax4, 1));
+    return _mm_cvtss_f32(vmax4);
+}
+
+static inline float _avx512_reduce_add(__m512 vsrc) {
+    __m256 vsum = _mm256_add_ps(_mm512_castps512_ps256(vsrc),
+                                _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(vsrc), 1)));
+    __m128 vsum4 = _mm_add_ps(_mm256_castps256_ps128(vsum), _mm256_extractf128_ps(vsum, 1));
+    vsum4 = _mm_add_ps(vsum4, _mm_movehl_ps(vsum4, vsum4));
+    vsum4 = _mm_add_ss(vsum4, _mm_shuffle_ps(vsum4, vsum4, 1));
+    return _mm_cvtss_f32(vsum4);
+}
+#elif defined(HAVE_AVX2)
+static inline __m256 _avx_softmax_exp_ps(__m256 vsrc) {
+#if USE_FAST_EXP
+    return _avx_fast_exp_ps(vsrc);
+#else
+    return _avx_opt_exp_ps(vsrc);
+#endif
+}
+
+static inline float _avx_reduce_max(__m256 vsrc) {
+    __m128 vmax = _mm_max_ps(_mm256_castps256_ps128(vsrc), _mm256_extractf128_ps(vsrc, 1));
+    vmax = _mm_max_ps(vmax, _mm_movehl_ps(vmax, vmax));
+    vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, 1));
+    return _mm_cvtss_f32(vmax);
+}
+
+static inline float _avx_reduce_add(__m256 vsrc) {
+    __m128 vsum = _mm_add_ps(_mm256_castps256_ps128(vsrc), _mm256_extractf128_ps(vsrc, 1));
+    vsum = _mm_add_ps(vsum, _mm_movehl_ps(vsum, vsum));
+    vsum = _mm_add_ss(vsum, _mm_shuffle_ps(vsum, vsum, 1));
+    return _mm_cvtss_f32(vsum);
+}
+#elif defined(HAVE_SSE)
+static inline __m128 _sse_softmax_exp_ps(__m128 vsrc) {
+#if USE_FAST_EXP
+    return _sse_fast_exp_ps(vsrc);
+#else
+    return _sse_opt_exp_ps(vsrc);
+#endif
+}
+
+static inline float _sse_reduce_max(__m128 vsrc) {
+    __m128 vmax = _mm_max_ps(vsrc, _mm_movehl_ps(vsrc, vsrc));
+    vmax = _mm_max_ss(vmax, _mm_shuffle_ps(vmax, vmax, 1));
+    return _mm_cvtss_f32(vmax);
+}
+
+static inline float _sse_reduce_add(__m128 vsrc) {
+    __m128 vsum = _mm_add_ps(vsrc, _mm_movehl_ps(vsrc, vsrc));
+    vsum = _mm_add_ss(vsum, _mm_shuffle_ps(vsum, vsum, 1));
+    return _mm_cvtss_f32(vsum);
+}
+#endif
+
+// Softmax over C channels lying `stride` floats apart, computed for `count` neighbouring positions
+// (the NCHW layout: one call handles a run of pixels). Vectorized across positions,
+// src_data and dst_data may be the same buffer.
 static inline
-void softmax_many_batches(const float *src_data, float *dst_data, int B, int C, int H, int W) {
-    InferenceEngine::parallel_for(B * H * W, [&](size_t i) {
-        const float *psrc = src_data + (i / (H * W)) * C * H * W - (i / (H * W)) * H * W;
-        float *pdst = dst_data + (i / (H * W)) * C * H * W - (i / (H * W)) * H * W;
+void softmax_planar(const float *src_data, float *dst_data, int C, int stride, int count) {
+    int i = 0;
+#if defined(HAVE_AVX512F)
+    for (; i + 16 <= count; i += 16) {
+        __m512 vmax = _mm512_loadu_ps(src_data + i);
+        for (int c = 1; c < C; c++)
+            vmax = _mm512_max_ps(vmax, _mm512_loadu_ps(src_data + c*stride + i));
+
+        __m512 vexpSum = _mm512_setzero_ps();
+        for (int c = 0; c < C; c++) {
+            __m512 vres = _avx512_softmax_exp_ps(_mm512_sub_ps(_mm512_loadu_ps(src_data + c*stride + i), vmax));
+            vexpSum = _mm512_add_ps(vexpSum, vres);
+            _mm512_storeu_ps(dst_data + c*stride + i, vres);
+        }
+
+        __m512 vscale = _mm512_div_ps(_mm512_set1_ps(1.0f), vexpSum);
+        for (int c = 0; c < C; c++)
+            _mm512_storeu_ps(dst_data + c*stride + i, _mm512_mul_ps(_mm512_loadu_ps(dst_data + c*stride + i), vscale));
+    }
+#elif defined(HAVE_AVX2)
+    for (; i + 8 <= count; i += 8) {
+        __m256 vmax = _mm256_loadu_ps(src_data + i);
+        for (int c = 1; c < C; c++)
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(src_data + c*stride + i));
+
+        __m256 vexpSum = _mm256_setzero_ps();
+        for (int c = 0; c < C; c++) {
+            __m256 vres = _avx_softmax_exp_ps(_mm256_sub_ps(_mm256_loadu_ps(src_data + c*stride + i), vmax));
+            vexpSum = _mm256_add_ps(vexpSum, vres);
+            _mm256_storeu_ps(dst_data + c*stride + i, vres);
+        }
 
-        float max = psrc[i];
+        __m256 vscale = _mm256_div_ps(_mm256_set1_ps(1.0f), vexpSum);
+        for (int c = 0; c < C; c++)
+            _mm256_storeu_ps(dst_data + c*stride + i, _mm256_mul_ps(_mm256_loadu_ps(dst_data + c*stride + i), vscale));
+    }
+#elif defined(HAVE_SSE)
+    for (; i + 4 <= count; i += 4) {
+        __m128 vmax = _mm_loadu_ps(src_data + i);
+        for (int c = 1; c < C; c++)
+            vmax = _mm_max_ps(vmax, _mm_loadu_ps(src_data + c*stride + i));
+
+        __m128 vexpSum = _mm_setzero_ps();
         for (int c = 0; c < C; c++) {
-            float val = psrc[c * H * W + i];
+            __m128 vres = _sse_softmax_exp_ps(_mm_sub_ps(_mm_loadu_ps(src_data + c*stride + i), vmax));
+            vexpSum = _mm_add_ps(vexpSum, vres);
+            _mm_storeu_ps(dst_data + c*stride + i, vres);
+        }
+
+        __m128 vscale = _mm_div_ps(_mm_set1_ps(1.0f), vexpSum);
+        for (int c = 0; c < C; c++)
+            _mm_storeu_ps(dst_data + c*stride + i, _mm_mul_ps(_mm_loadu_ps(dst_data + c*stride + i), vscale));
+    }
+#endif
+    for (; i < count; i++) {
+        float max = src_data[i];
+        for (int c = 1; c < C; c++) {
+            float val = src_data[c*stride + i];
             if (val > max) max = val;
         }
 
         float expSum = 0;
         for (int c = 0; c < C; c++) {
-            pdst[c * H * W + i] = exp(psrc[c * H * W + i] - max);
-            expSum += pdst[c * H * W + i];
+            dst_data[c*stride + i] = std::exp(src_data[c*stride + i] - max);
+            expSum += dst_data[c*stride + i];
         }
 
+        float scale = 1.0f / expSum;
         for (int c = 0; c < C; c++) {
-            pdst[c * H * W + i] = pdst[c * H * W + i] / expSum;
+            dst_data[c*stride + i] *= scale;
         }
-    });
+    }
 }
 
+// Softmax over C contiguous values (the NHWC / [N, priors, classes] layout, one call per position).
+// Vectorized along C, src_data and dst_data may be the same buffer.
 static inline
-void softmax_generic(const float *src_data, float *dst_data, int B, int C, int H, int W) {
-    for (int b = 0; b < B; b++) {
-#if defined(HAVE_AVX2)
-        for (int i = 0; i <= H*W - 8; i += 8) {
-            __m256 vmax = _mm256_loadu_ps(src_data + b*C*H*W + i);
-            for (int c = 0; c < C; c++) {
-                __m256 vval = _mm256_loadu_ps(src_data + b*C*H*W + c*H*W + i);
-                __m256 vmask = _mm256_cmp_ps(vval, vmax, _CMP_GT_OS);
-                vmax = _mm256_blendv_ps(vmax, vval, vmask);
-            }
-
-            __m256 vexpSum = _mm256_setzero_ps();
-            for (int c = 0; c < C; c++) {
-                __m256 vval = _mm256_loadu_ps(src_data + b*C*H*W + c*H*W + i);
-#if USE_FAST_EXP
-                __m256 vres = _avx_fast_exp_ps(_mm256_sub_ps(vval, vmax));
-#else
-                __m256 vres = _avx_opt_exp_ps(_mm256_sub_ps(vval, vmax));
-#endif
-                vexpSum = _mm256_add_ps(vexpSum, vres);
-                _mm256_storeu_ps(dst_data + b*C*H*W + c*H*W + i, vres);
-            }
-
-            for (int c = 0; c < C; c++) {
-                __m256 vval = _mm256_loadu_ps(dst_data + b*C*H*W + c*H*W + i);
-                _mm256_storeu_ps(dst_data + b*C*H*W + c*H*W + i, _mm256_div_ps(vval, vexpSum));
-            }
-        }
+void softmax_contiguous(const float *src_data, float *dst_data, int C) {
+    int c = 0;
+    float max = src_data[0];
+#if defined(HAVE_AVX512F)
+    if (C >= 16) {
+        __m512 vmax = _mm512_loadu_ps(src_data);
+        for (c = 16; c + 16 <= C; c += 16)
+            vmax = _mm512_max_ps(vmax, _mm512_loadu_ps(src_data + c));
+        max = _avx512_reduce_max(vmax);
+    }
+#elif defined(HAVE_AVX2)
+    if (C >= 8) {
+        __m256 vmax = _mm256_loadu_ps(src_data);
+        for (c = 8; c + 8 <= C; c += 8)
+            vmax = _mm256_max_ps(vmax, _mm256_loadu_ps(src_data + c));
+        max = _avx_reduce_max(vmax);
+    }
 #elif defined(HAVE_SSE)
-        for (int i = 0; i <= H*W - 4; i += 4) {
-            __m128 vmax = _mm_loadu_ps(src_data + b*C*H*W + i);
-            for (int c = 0; c < C; c++) {
-                __m128 vval = _mm_loadu_ps(src_data + b*C*H*W + c*H*W + i);
-                __m128 vmask = _mm_cmpgt_ps(vval, vmax);
-                vmax = _mm_blendv_ps(vmax, vval, vmask);
-            }
-
-            __m128 vexpSum = _mm_setzero_ps();
-            for (int c = 0; c < C; c++) {
-                __m128 vval = _mm_loadu_ps(src_data + b*C*H*W + c*H*W + i);
-#if USE_FAST_EXP
-                __m128 vres = _sse_fast_exp_ps(_mm_sub_ps(vval, vmax));
-#else
-                __m128 vres = _sse_opt_exp_ps(_mm_sub_ps(vval, vmax));
+    if (C >= 4) {
+        __m128 vmax = _mm_loadu_ps(src_data);
+        for (c = 4; c + 4 <= C; c += 4)
+            vmax = _mm_max_ps(vmax, _mm_loadu_ps(src_data + c));
+        max = _sse_reduce_max(vmax);
+    }
 #endif
-                vexpSum = _mm_add_ps(vexpSum, vres);
-                _mm_storeu_ps(dst_data + b*C*H*W + c*H*W + i, vres);
-            }
-
-            for (int c = 0; c < C; c++) {
-                __m128 vval = _mm_loadu_ps(dst_data + b*C*H*W + c*H*W + i);
-                _mm_storeu_ps(dst_data + b*C*H*W + c*H*W + i, _mm_div_ps(vval, vexpSum));
-            }
-        }
+    for (; c < C; c++) {
+        if (src_data[c] > max) max = src_data[c];
+    }
+
+    c = 0;
+    float expSum = 0;
+#if defined(HAVE_AVX512F)
+    __m512 vmax = _mm512_set1_ps(max);
+    __m512 vexpSum = _mm512_setzero_ps();
+    for (; c + 16 <= C; c += 16) {
+        __m512 vres = _avx512_softmax_exp_ps(_mm512_sub_ps(_mm512_loadu_ps(src_data + c), vmax));
+        vexpSum = _mm512_add_ps(vexpSum, vres);
+        _mm512_storeu_ps(dst_data + c, vres);
+    }
+    expSum = _avx512_reduce_add(vexpSum);
+#elif defined(HAVE_AVX2)
+    __m256 vmax = _mm256_set1_ps(max);
+    __m256 vexpSum = _mm256_setzero_ps();
+    for (; c + 8 <= C; c += 8) {
+        __m256 vres = _avx_softmax_exp_ps(_mm256_sub_ps(_mm256_loadu_ps(src_data + c), vmax));
+        vexpSum = _mm256_add_ps(vexpSum, vres);
+        _mm256_storeu_ps(dst_data + c, vres);
+    }
+    expSum = _avx_reduce_add(vexpSum);
+#elif defined(HAVE_SSE)
+    __m128 vmax = _mm_set1_ps(max);
+    __m128 vexpSum = _mm_setzero_ps();
+    for (; c + 4 <= C; c += 4) {
+        __m128 vres = _sse_softmax_exp_ps(_mm_sub_ps(_mm_loadu_ps(src_data + c), vmax));
+        vexpSum = _mm_add_ps(vexpSum, vres);
+        _mm_storeu_ps(dst_data + c, vres);
+    }
+    expSum = _sse_reduce_add(vexpSum);
 #endif
+    for (; c < C; c++) {
+        dst_data[c] = std::exp(src_data[c] - max);
+        expSum += dst_data[c];
+    }
 
-#if defined(HAVE_AVX2)
-        int start = (H*W / 8) * 8;
+    c = 0;
+    float scale = 1.0f / expSum;
+#if defined(HAVE_AVX512F)
+    __m512 vscale = _mm512_set1_ps(scale);
+    for (; c + 16 <= C; c += 16)
+        _mm512_storeu_ps(dst_data + c, _mm512_mul_ps(_mm512_loadu_ps(dst_data + c), vscale));
+#elif defined(HAVE_AVX2)
+    __m256 vscale = _mm256_set1_ps(scale);
+    for (; c + 8 <= C; c += 8)
+        _mm256_storeu_ps(dst_data + c, _mm256_mul_ps(_mm256_loadu_ps(dst_data + c), vscale));
 #elif defined(HAVE_SSE)
-        int start = (H*W / 4) * 4;
-#else
-        int start = 0;
+    __m128 vscale = _mm_set1_ps(scale);
+    for (; c + 4 <= C; c += 4)
+        _mm_storeu_ps(dst_data + c, _mm_mul_ps(_mm_loadu_ps(dst_data + c), vscale));
 #endif
-        for (int i = start; i < H * W; i++) {
-            float max = src_data[b * C * H * W + i];
-            for (int c = 0; c < C; c++) {
-                float val = src_data[b * C * H * W + c * H * W + i];
-                if (val > max) max = val;
-            }
-
-            float expSum = 0;
-            for (int c = 0; c < C; c++) {
-                dst_data[b * C * H * W + c * H * W + i] = exp(src_data[b * C * H * W + c * H * W + i] - max);
-                expSum += dst_data[b * C * H * W + c * H * W + i];
-            }
-
-            for (int c = 0; c < C; c++) {
-                dst_data[b * C * H * W + c * H * W + i] = dst_data[b * C * H * W + c * H * W + i] / expSum;
-            }
-        }
+    for (; c < C; c++) {
+        dst_data[c] *= scale;
+    }
+}
+
+// Number of positions one planar task covers: a few cache lines per channel keeps the C rows
+// of a task in L1 between the max, exp and scale passes
+#define SOFTMAX_PLANAR_TASK 64
+
+// Softmax over channels for B batches lying `batch_stride` floats apart, parallel over batches
+// and runs of positions
+static inline
+void softmax_planar_batches(const float *src_data, float *dst_data, int B, int C, int HW, int batch_stride) {
+    if (HW == 1) {
+        InferenceEngine::parallel_for(B, [&](int b) {
+            softmax_contiguous(src_data + b*batch_stride, dst_data + b*batch_stride, C);
+        });
+        return;
     }
-}
\ No newline at end of file
+
+    const int num_tasks = (HW + SOFTMAX_PLANAR_TASK - 1) / SOFTMAX_PLANAR_TASK;
+    InferenceEngine::parallel_for2d(B, num_tasks, [&](int b, int t) {
+        const int start = t * SOFTMAX_PLANAR_TASK;
+        const int count = std::min(HW - start, SOFTMAX_PLANAR_TASK);
+        softmax_planar(src_data + b*batch_stride + start, dst_data + b*batch_stride + start, C, HW, count);
+    });
+}
+
+static inline
+void softmax_many_batches(const float *src_data, float *dst_data, int B, int C, int H, int W) {
+    softmax_planar_batches(src_data, dst_data, B, C, H * W, C * H * W);
+}
+
+static inline
+void softmax_generic(const float *src_data, float *dst_data, int B, int C, int H, int W) {
+    softmax_many_batches(src_data, dst_data, B, C, H, W);
+}
@@ -19,6 +19,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class ArgMaxImpl: public ExtLayerBase {
 public:
@@ -430,6 +431,7 @@ private:
 
 REG_FACTORY_FOR(ImplFactory<ArgMaxImpl>, ArgMax);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
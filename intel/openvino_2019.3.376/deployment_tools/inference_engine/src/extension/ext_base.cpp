@@ -12,6 +12,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 inline int div_up(const int a, const int b) {
     assert(b);
@@ -123,6 +124,7 @@ void ExtLayerBase::addConfig(const CNNLayer* layer, std::vector<DataConfigurator
 }
 
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
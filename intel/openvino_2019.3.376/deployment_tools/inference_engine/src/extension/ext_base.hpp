@@ -5,6 +5,7 @@
 #pragma once
 
 #include <ie_iextension.h>
+#include "ext_list.hpp"
 
 #include <string>
 #include <vector>
@@ -15,6 +16,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class ExtLayerBase: public ILayerExecImpl {
 public:
@@ -390,6 +392,7 @@ protected:
     CNNLayer cnnLayer;
 };
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
@@ -6,16 +6,22 @@
 #include "ext_base.hpp"
 
 #include <cfloat>
+#include <cstdint>
 #include <vector>
 #include <cmath>
 #include <string>
 #include <utility>
 #include <algorithm>
 #include "ie_parallel.hpp"
+#include "softmax.h"
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+#include <immintrin.h>
+#endif
 
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 template <typename T>
 static bool SortScorePairDescend(const std::pair<float, T>& pair1,
@@ -47,6 +53,8 @@ public:
             _normalized = layer->GetParamAsBool("normalized", true);
             _image_height = layer->GetParamAsInt("input_height", 1);
             _image_width = layer->GetParamAsInt("input_width", 1);
+            // softmax over classes is applied to raw confidences during the reorder instead of by a separate layer
+            _conf_softmax = layer->GetParamAsBool("conf_softmax", false);
             _prior_size = _normalized ? 4 : 5;
             _offset = _normalized ? 0 : 1;
             _num_loc_classes = _share_location ? 1 : _num_classes;
@@ -110,6 +118,13 @@ public:
             _num_priors_actual = InferenceEngine::make_shared_blob<int>({Precision::I32, num_priors_actual_size, C});
             _num_priors_actual->allocate();
 
+            // nms never keeps more boxes per class than it takes candidates
+            _max_kept = _top_k == -1 ? _num_priors : std::min(_top_k, _num_priors);
+            _kept_boxes.resize(static_cast<size_t>(_num_classes) * 5 * _max_kept);
+            _active_priors.resize(_num_priors);
+            _is_prior_active.resize(_num_priors);
+            _conf_index_class_map.reserve(static_cast<size_t>(_num_classes) * _max_kept);
+
             addConfig(layer, {DataConfigurator(ConfLayout::PLN),
                        DataConfigurator(ConfLayout::PLN),
                        DataConfigurator(ConfLayout::PLN)}, {DataConfigurator(ConfLayout::PLN)});
@@ -136,6 +151,13 @@ public:
         int *indices_data          = _indices->buffer();
         int *num_priors_actual     = _num_priors_actual->buffer();
 
+        // conf is reordered first so that priors whose every class is below the threshold
+        // can be skipped by the decoder, nms never looks at them
+        for (int n = 0; n < N; ++n) {
+            reorderConfidences(conf_data + n*_num_priors*_num_classes,
+                               reordered_conf_data + n*_num_priors*_num_classes);
+        }
+
         for (int n = 0; n < N; ++n) {
             const float *ppriors = prior_data;
             const float *prior_variances = prior_data + _num_priors*_prior_size;
@@ -144,11 +166,14 @@ public:
                 prior_variances += _variance_encoded_in_target ? 0 : n*_num_priors*_prior_size;
             }
 
+            num_priors_actual[n] = countActualPriors(ppriors);
+            const int num_active = findActivePriors(reordered_conf_data + n*_num_priors*_num_classes, num_priors_actual[n]);
+
             if (_share_location) {
                 const float *ploc = loc_data + n*4*_num_priors;
                 float *pboxes = decoded_bboxes_data + n*4*_num_priors;
                 float *psizes = bbox_sizes_data + n*_num_priors;
-                decodeBBoxes(ppriors, ploc, prior_variances, pboxes, psizes, num_priors_actual, n);
+                decodeBBoxes(ppriors, ploc, prior_variances, pboxes, psizes, num_active);
             } else {
                 for (int c = 0; c < _num_loc_classes; ++c) {
                     if (c == _background_label_id) {
@@ -158,15 +183,7 @@ public:
                     const float *ploc = loc_data + n*4*_num_loc_classes*_num_priors + c*4;
                     float *pboxes = decoded_bboxes_data + n*4*_num_loc_classes*_num_priors + c*4*_num_priors;
                     float *psizes = bbox_sizes_data + n*_num_loc_classes*_num_priors + c*_num_priors;
-                    decodeBBoxes(ppriors, ploc, prior_variances, pboxes, psizes, num_priors_actual, n);
-                }
-            }
-        }
-
-        for (int n = 0; n < N; ++n) {
-            for (int c = 0; c < _num_classes; ++c) {
-                for (int p = 0; p < _num_priors; ++p) {
-                    reordered_conf_data[n*_num_priors*_num_classes + c*_num_priors + p] = conf_data[n*_num_priors*_num_classes + p*_num_classes + c];
+                    decodeBBoxes(ppriors, ploc, prior_variances, pboxes, psizes, num_active);
                 }
             }
         }
@@ -195,7 +212,9 @@ public:
                             psizes = bbox_sizes_data + n*_num_classes*_num_priors + c*_num_priors;
                         }
 
-                        nms_cf(pconf, pboxes, psizes, pbuffer, pindices, *pdetections, num_priors_actual[n]);
+                        float *pkept = _kept_boxes.data() + static_cast<size_t>(c) * 5 * _max_kept;
+
+                        nms_cf(pconf, pboxes, psizes, pbuffer, pindices, pkept, *pdetections, num_priors_actual[n]);
                     }
                 });
             } else {
@@ -216,7 +235,8 @@ public:
             }
 
             if (_keep_top_k > -1 && detections_total > _keep_top_k) {
-                std::vector<std::pair<float, std::pair<int, int>>> conf_index_class_map;
+                std::vector<std::pair<float, std::pair<int, int>>>& conf_index_class_map = _conf_index_class_map;
+                conf_index_class_map.clear();
 
                 for (int c = 0; c < _num_classes; ++c) {
                     int detections = detections_data[n*_num_classes + c];
@@ -229,8 +249,9 @@ public:
                     }
                 }
 
-                std::sort(conf_index_class_map.begin(), conf_index_class_map.end(),
-                          SortScorePairDescend<std::pair<int, int>>);
+                // only the first keep_top_k are needed in order
+                std::partial_sort(conf_index_class_map.begin(), conf_index_class_map.begin() + _keep_top_k,
+                                  conf_index_class_map.end(), SortScorePairDescend<std::pair<int, int>>);
                 conf_index_class_map.resize(_keep_top_k);
 
                 // Store the new indices.
@@ -324,6 +345,7 @@ private:
     bool _clip_before_nms   = false;  // clip bounding boxes before nms step
     bool _clip_after_nms    = false;  // clip bounding boxes after nms step
     bool _decrease_label_id = false;
+    bool _conf_softmax      = false;  // confidences are logits, softmax is fused into the reorder
 
     int _image_width = 0;
     int _image_height = 0;
@@ -344,11 +366,17 @@ private:
         CENTER_SIZE = 2,
     };
 
+    int countActualPriors(const float *prior_data) const;
+
+    void reorderConfidences(const float *conf_data, float *reordered_conf_data) const;
+
+    int findActivePriors(const float *reordered_conf_data, int num_priors_actual);
+
     void decodeBBoxes(const float *prior_data, const float *loc_data, const float *variance_data,
-                      float *decoded_bboxes, float *decoded_bbox_sizes, int* num_priors_actual, int n);
+                      float *decoded_bboxes, float *decoded_bbox_sizes, int num_active);
 
     void nms_cf(const float *conf_data, const float *bboxes, const float *sizes,
-                int *buffer, int *indices, int &detections, int num_priors_actual);
+                int *buffer, int *indices, float *kept_boxes, int &detections, int num_priors_actual);
 
     void nms_mx(const float *conf_data, const float *bboxes, const float *sizes,
                 int *buffer, int *indices, int *detections, int num_priors_actual);
@@ -360,6 +388,12 @@ private:
     InferenceEngine::Blob::Ptr _reordered_conf;
     InferenceEngine::Blob::Ptr _bbox_sizes;
     InferenceEngine::Blob::Ptr _num_priors_actual;
+
+    int _max_kept = 0;
+    std::vector<float> _kept_boxes;  // per class: xmin, ymin, xmax, ymax and size planes of boxes kept by nms_cf
+    std::vector<int> _active_priors;
+    std::vector<uint8_t> _is_prior_active;
+    std::vector<std::pair<float, std::pair<int, int>>> _conf_index_class_map;
 };
 
 struct ConfidenceComparator {
@@ -411,26 +445,247 @@ static inline float JaccardOverlap(const float *decoded_bbox,
     return intersect_size / (bbox1_size + bbox2_size - intersect_size);
 }
 
-void DetectionOutputImpl::decodeBBoxes(const float *prior_data,
-                                   const float *loc_data,
-                                   const float *variance_data,
-                                   float *decoded_bboxes,
-                                   float *decoded_bbox_sizes,
-                                   int* num_priors_actual,
-                                   int n) {
-    num_priors_actual[n] = _num_priors;
+#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+static inline void transpose8x8(const float *src, int src_stride, float *dst, int dst_stride) {
+    __m256 r0 = _mm256_loadu_ps(src + 0*src_stride);
+    __m256 r1 = _mm256_loadu_ps(src + 1*src_stride);
+    __m256 r2 = _mm256_loadu_ps(src + 2*src_stride);
+    __m256 r3 = _mm256_loadu_ps(src + 3*src_stride);
+    __m256 r4 = _mm256_loadu_ps(src + 4*src_stride);
+    __m256 r5 = _mm256_loadu_ps(src + 5*src_stride);
+    __m256 r6 = _mm256_loadu_ps(src + 6*src_stride);
+    __m256 r7 = _mm256_loadu_ps(src + 7*src_stride);
+
+    __m256 t0 = _mm256_unpacklo_ps(r0, r1);
+    __m256 t1 = _mm256_unpackhi_ps(r0, r1);
+    __m256 t2 = _mm256_unpacklo_ps(r2, r3);
+    __m256 t3 = _mm256_unpackhi_ps(r2, r3);
+    __m256 t4 = _mm256_unpacklo_ps(r4, r5);
+    __m256 t5 = _mm256_unpackhi_ps(r4, r5);
+    __m256 t6 = _mm256_unpacklo_ps(r6, r7);
+    __m256 t7 = _mm256_unpackhi_ps(r6, r7);
+
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, 0x44);
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, 0xEE);
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, 0x44);
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, 0xEE);
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, 0x44);
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, 0xEE);
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, 0x44);
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, 0xEE);
+
+    _mm256_storeu_ps(dst + 0*dst_stride, _mm256_permute2f128_ps(s0, s4, 0x20));
+    _mm256_storeu_ps(dst + 1*dst_stride, _mm256_permute2f128_ps(s1, s5, 0x20));
+    _mm256_storeu_ps(dst + 2*dst_stride, _mm256_permute2f128_ps(s2, s6, 0x20));
+    _mm256_storeu_ps(dst + 3*dst_stride, _mm256_permute2f128_ps(s3, s7, 0x20));
+    _mm256_storeu_ps(dst + 4*dst_stride, _mm256_permute2f128_ps(s0, s4, 0x31));
+    _mm256_storeu_ps(dst + 5*dst_stride, _mm256_permute2f128_ps(s1, s5, 0x31));
+    _mm256_storeu_ps(dst + 6*dst_stride, _mm256_permute2f128_ps(s2, s6, 0x31));
+    _mm256_storeu_ps(dst + 7*dst_stride, _mm256_permute2f128_ps(s3, s7, 0x31));
+}
+#elif defined(HAVE_SSE)
+static inline void transpose4x4(const float *src, int src_stride, float *dst, int dst_stride) {
+    __m128 r0 = _mm_loadu_ps(src + 0*src_stride);
+    __m128 r1 = _mm_loadu_ps(src + 1*src_stride);
+    __m128 r2 = _mm_loadu_ps(src + 2*src_stride);
+    __m128 r3 = _mm_loadu_ps(src + 3*src_stride);
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    _mm_storeu_ps(dst + 0*dst_stride, r0);
+    _mm_storeu_ps(dst + 1*dst_stride, r1);
+    _mm_storeu_ps(dst + 2*dst_stride, r2);
+    _mm_storeu_ps(dst + 3*dst_stride, r3);
+}
+#endif
+
+// Checks the box against all boxes kept so far, the kept ones are stored as
+// xmin, ymin, xmax, ymax and size planes of kept_stride elements each.
+// Gives the same result as JaccardOverlap(...) > nms_threshold for every pair.
+static inline bool isSuppressed(const float *kept_boxes, int kept_stride, int num_kept,
+                                const float *box, float box_size, float nms_threshold) {
+    const float *kept_xmin = kept_boxes;
+    const float *kept_ymin = kept_boxes + kept_stride;
+    const float *kept_xmax = kept_boxes + 2*kept_stride;
+    const float *kept_ymax = kept_boxes + 3*kept_stride;
+    const float *kept_size = kept_boxes + 4*kept_stride;
+
+    int k = 0;
+#if defined(HAVE_AVX512F)
+    const __m512 vxmin = _mm512_set1_ps(box[0]);
+    const __m512 vymin = _mm512_set1_ps(box[1]);
+    const __m512 vxmax = _mm512_set1_ps(box[2]);
+    const __m512 vymax = _mm512_set1_ps(box[3]);
+    const __m512 vsize = _mm512_set1_ps(box_size);
+    const __m512 vthreshold = _mm512_set1_ps(nms_threshold);
+    const __m512 vzero = _mm512_setzero_ps();
+    for (; k + 16 <= num_kept; k += 16) {
+        __m512 vwidth = _mm512_sub_ps(_mm512_min_ps(vxmax, _mm512_loadu_ps(kept_xmax + k)),
+                                      _mm512_max_ps(vxmin, _mm512_loadu_ps(kept_xmin + k)));
+        __m512 vheight = _mm512_sub_ps(_mm512_min_ps(vymax, _mm512_loadu_ps(kept_ymax + k)),
+                                       _mm512_max_ps(vymin, _mm512_loadu_ps(kept_ymin + k)));
+        __m512 vintersect = _mm512_mul_ps(vwidth, vheight);
+        __m512 voverlap = _mm512_div_ps(vintersect,
+                                        _mm512_sub_ps(_mm512_add_ps(vsize, _mm512_loadu_ps(kept_size + k)), vintersect));
+        __mmask16 vmask = _mm512_cmp_ps_mask(vwidth, vzero, _CMP_GT_OS) &
+                          _mm512_cmp_ps_mask(vheight, vzero, _CMP_GT_OS) &
+                          _mm512_cmp_ps_mask(voverlap, vthreshold, _CMP_GT_OS);
+        if (vmask) {
+            return true;
+        }
+    }
+#elif defined(HAVE_AVX2)
+    const __m256 vxmin = _mm256_set1_ps(box[0]);
+    const __m256 vymin = _mm256_set1_ps(box[1]);
+    const __m256 vxmax = _mm256_set1_ps(box[2]);
+    const __m256 vymax = _mm256_set1_ps(box[3]);
+    const __m256 vsize = _mm256_set1_ps(box_size);
+    const __m256 vthreshold = _mm256_set1_ps(nms_threshold);
+    const __m256 vzero = _mm256_setzero_ps();
+    for (; k + 8 <= num_kept; k += 8) {
+        __m256 vwidth = _mm256_sub_ps(_mm256_min_ps(vxmax, _mm256_loadu_ps(kept_xmax + k)),
+                                      _mm256_max_ps(vxmin, _mm256_loadu_ps(kept_xmin + k)));
+        __m256 vheight = _mm256_sub_ps(_mm256_min_ps(vymax, _mm256_loadu_ps(kept_ymax + k)),
+                                       _mm256_max_ps(vymin, _mm256_loadu_ps(kept_ymin + k)));
+        __m256 vintersect = _mm256_mul_ps(vwidth, vheight);
+        __m256 voverlap = _mm256_div_ps(vintersect,
+                                        _mm256_sub_ps(_mm256_add_ps(vsize, _mm256_loadu_ps(kept_size + k)), vintersect));
+        __m256 vmask = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(vwidth, vzero, _CMP_GT_OS),
+                                                   _mm256_cmp_ps(vheight, vzero, _CMP_GT_OS)),
+                                     _mm256_cmp_ps(voverlap, vthreshold, _CMP_GT_OS));
+        if (_mm256_movemask_ps(vmask)) {
+            return true;
+        }
+    }
+#elif defined(HAVE_SSE)
+    const __m128 vxmin = _mm_set1_ps(box[0]);
+    const __m128 vymin = _mm_set1_ps(box[1]);
+    const __m128 vxmax = _mm_set1_ps(box[2]);
+    const __m128 vymax = _mm_set1_ps(box[3]);
+    const __m128 vsize = _mm_set1_ps(box_size);
+    const __m128 vthreshold = _mm_set1_ps(nms_threshold);
+    const __m128 vzero = _mm_setzero_ps();
+    for (; k + 4 <= num_kept; k += 4) {
+        __m128 vwidth = _mm_sub_ps(_mm_min_ps(vxmax, _mm_loadu_ps(kept_xmax + k)),
+                                   _mm_max_ps(vxmin, _mm_loadu_ps(kept_xmin + k)));
+        __m128 vheight = _mm_sub_ps(_mm_min_ps(vymax, _mm_loadu_ps(kept_ymax + k)),
+                                    _mm_max_ps(vymin, _mm_loadu_ps(kept_ymin + k)));
+        __m128 vintersect = _mm_mul_ps(vwidth, vheight);
+        __m128 voverlap = _mm_div_ps(vintersect,
+                                     _mm_sub_ps(_mm_add_ps(vsize, _mm_loadu_ps(kept_size + k)), vintersect));
+        __m128 vmask = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(vwidth, vzero), _mm_cmpgt_ps(vheight, vzero)),
+                                  _mm_cmpgt_ps(voverlap, vthreshold));
+        if (_mm_movemask_ps(vmask)) {
+            return true;
+        }
+    }
+#endif
+    for (; k < num_kept; ++k) {
+        float intersect_width  = std::min(box[2], kept_xmax[k]) - std::max(box[0], kept_xmin[k]);
+        float intersect_height = std::min(box[3], kept_ymax[k]) - std::max(box[1], kept_ymin[k]);
+        if (intersect_width <= 0 || intersect_height <= 0) {
+            continue;
+        }
+        float intersect_size = intersect_width * intersect_height;
+        if (intersect_size / (box_size + kept_size[k] - intersect_size) > nms_threshold) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DetectionOutputImpl::countActualPriors(const float *prior_data) const {
     if (!_normalized) {
-        int num = 0;
-        for (; num < _num_priors; ++num) {
+        for (int num = 0; num < _num_priors; ++num) {
             float batch_id = prior_data[num * _prior_size + 0];
             if (batch_id == -1.f) {
-                num_priors_actual[n] = num;
-                break;
+                return num;
             }
         }
     }
+    return _num_priors;
+}
+
+// p x c -> c x p transpose done in register blocks of 8x8 (AVX2, AVX512) or 4x4 (SSE),
+// optionally followed by softmax over classes of the block
+void DetectionOutputImpl::reorderConfidences(const float *conf_data, float *reordered_conf_data) const {
+#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+    const int block = 8;
+#elif defined(HAVE_SSE)
+    const int block = 4;
+#else
+    const int block = 1;
+#endif
+    const int num_blocks = (_num_priors + block - 1) / block;
+    parallel_for(num_blocks, [&](int ib) {
+        const int p_start = ib * block;
+        const int p_end = std::min(p_start + block, _num_priors);
+        int c = 0;
+        if (p_end - p_start == block) {
+#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+            for (; c + block <= _num_classes; c += block) {
+                transpose8x8(conf_data + p_start*_num_classes + c, _num_classes,
+                             reordered_conf_data + c*_num_priors + p_start, _num_priors);
+            }
+#elif defined(HAVE_SSE)
+            for (; c + block <= _num_classes; c += block) {
+                transpose4x4(conf_data + p_start*_num_classes + c, _num_classes,
+                             reordered_conf_data + c*_num_priors + p_start, _num_priors);
+            }
+#endif
+        }
+        for (; c < _num_classes; ++c) {
+            for (int p = p_start; p < p_end; ++p) {
+                reordered_conf_data[c*_num_priors + p] = conf_data[p*_num_classes + c];
+            }
+        }
+        // the block is still in cache, its priors lie next to each other in every class row
+        if (_conf_softmax) {
+            softmax_planar(reordered_conf_data + p_start, reordered_conf_data + p_start,
+                           _num_classes, _num_priors, p_end - p_start);
+        }
+    });
+}
+
+// Collects priors that have at least one non background class passing the confidence threshold,
+// only they can become nms candidates in both Caffe and MXNet styles
+int DetectionOutputImpl::findActivePriors(const float *reordered_conf_data, int num_priors_actual) {
+    int *active_priors = _active_priors.data();
+    if (_confidence_threshold == -FLT_MAX) {
+        for (int p = 0; p < num_priors_actual; ++p) {
+            active_priors[p] = p;
+        }
+        return num_priors_actual;
+    }
+
+    uint8_t *is_active = _is_prior_active.data();
+    std::fill(is_active, is_active + num_priors_actual, 0);
+    for (int c = 0; c < _num_classes; ++c) {
+        if (c == _background_label_id) {
+            continue;
+        }
+        const float *pconf = reordered_conf_data + c*_num_priors;
+        for (int p = 0; p < num_priors_actual; ++p) {
+            is_active[p] |= static_cast<uint8_t>(pconf[p] >= _confidence_threshold);
+        }
+    }
 
-    parallel_for(num_priors_actual[n], [&](int p) {
+    int num_active = 0;
+    for (int p = 0; p < num_priors_actual; ++p) {
+        if (is_active[p]) {
+            active_priors[num_active++] = p;
+        }
+    }
+    return num_active;
+}
+
+void DetectionOutputImpl::decodeBBoxes(const float *prior_data,
+                                   const float *loc_data,
+                                   const float *variance_data,
+                                   float *decoded_bboxes,
+                                   float *decoded_bbox_sizes,
+                                   int num_active) {
+    const int *active_priors = _active_priors.data();
+    parallel_for(num_active, [&](int i) {
+        const int p = active_priors[i];
         float new_xmin = 0.0f;
         float new_ymin = 0.0f;
         float new_xmax = 0.0f;
@@ -516,6 +771,7 @@ void DetectionOutputImpl::nms_cf(const float* conf_data,
                           const float* sizes,
                           int* buffer,
                           int* indices,
+                          float* kept_boxes,
                           int& detections,
                           int num_priors_actual) {
     int count = 0;
@@ -534,17 +790,14 @@ void DetectionOutputImpl::nms_cf(const float* conf_data,
 
     for (int i = 0; i < num_output_scores; ++i) {
         const int idx = buffer[i];
-
-        bool keep = true;
-        for (int k = 0; k < detections; ++k) {
-            const int kept_idx = indices[k];
-            float overlap = JaccardOverlap(bboxes, sizes, idx, kept_idx);
-            if (overlap > _nms_threshold) {
-                keep = false;
-                break;
-            }
-        }
-        if (keep) {
+        const float *box = bboxes + idx*4;
+
+        if (!isSuppressed(kept_boxes, _max_kept, detections, box, sizes[idx], _nms_threshold)) {
+            kept_boxes[0*_max_kept + detections] = box[0];
+            kept_boxes[1*_max_kept + detections] = box[1];
+            kept_boxes[2*_max_kept + detections] = box[2];
+            kept_boxes[3*_max_kept + detections] = box[3];
+            kept_boxes[4*_max_kept + detections] = sizes[idx];
             indices[detections] = idx;
             detections++;
         }
@@ -606,6 +859,7 @@ void DetectionOutputImpl::nms_mx(const float* conf_data,
 
 REG_FACTORY_FOR(ImplFactory<DetectionOutputImpl>, DetectionOutput);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
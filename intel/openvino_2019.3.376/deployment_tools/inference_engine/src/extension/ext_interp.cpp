@@ -15,6 +15,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class InterpImpl: public ExtLayerBase {
 public:
@@ -68,6 +69,10 @@ public:
                 blk_layout = ConfLayout::BLK8;
 #endif
                 addConfig(layer, { DataConfigurator(blk_layout) }, { DataConfigurator(blk_layout) });
+#if defined(HAVE_AVX2)
+                // the planar kernel gathers along W, without gathers the blocked one is faster
+                addConfig(layer, { DataConfigurator(ConfLayout::PLN) }, { DataConfigurator(ConfLayout::PLN) });
+#endif
             }
         } catch (InferenceEngine::details::InferenceEngineException &ex) {
             errorMsg = ex.what();
@@ -87,20 +92,25 @@ public:
 
         auto *dst_data = outputs[0]->buffer().as<float *>();
 
+        prepareTables(IH_pad, IW_pad, OH, OW);
+
         switch (inputs[0]->getTensorDesc().getPrecision()) {
         case Precision::FP32:
         {
-            size_t IC = inputs[0]->getTensorDesc().getBlockingDesc().getBlockDims()[1] *
-                        inputs[0]->getTensorDesc().getBlockingDesc().getBlockDims()[4];
-            interpolate(IN, IC, inputs[0]->buffer().as<const float *>(),
-                -pad_beg, -pad_beg, IH_pad, IW_pad, IH, IW, dst_data, 0, 0, OH, OW, OH, OW);
+            if (inputs[0]->getTensorDesc().getLayout() == NCHW) {
+                size_t IC = inputs[0]->getTensorDesc().getDims()[1];
+                interpolate_pln(IN, IC, inputs[0]->buffer().as<const float *>(), IH, IW, dst_data, OH, OW);
+            } else {
+                size_t IC = inputs[0]->getTensorDesc().getBlockingDesc().getBlockDims()[1] *
+                            inputs[0]->getTensorDesc().getBlockingDesc().getBlockDims()[4];
+                interpolate(IN, IC, inputs[0]->buffer().as<const float *>(), IH, IW, dst_data, OH, OW);
+            }
         }
         break;
         case Precision::U8:
         {
             size_t IC = inputs[0]->getTensorDesc().getDims()[1];
-            interpolate_8u(inputs[0]->getTensorDesc().getLayout(), IN, IC, inputs[0]->buffer().as<const uint8_t *>(),
-                -pad_beg, -pad_beg, IH_pad, IW_pad, IH, IW, dst_data, 0, 0, OH, OW, OH, OW);
+            interpolate_pln(IN, IC, inputs[0]->buffer().as<const uint8_t *>(), IH, IW, dst_data, OH, OW);
         }
         break;
         default:
@@ -119,17 +129,36 @@ private:
     int pad_end;
     bool align_corners;
 
-    void interpolate(const size_t N, const size_t C,
-                     const float *src, const int x1, const int y1,
-                     const int IH_pad, const int IW_pad, const size_t IH, const size_t IW,
-                     float *dst, const int x2, const int y2,
-                     const int OH_pad, const int OW_pad, const size_t OH, const size_t OW) {
-        if (IH_pad == OH_pad && IW_pad == OW_pad) {
-            for (size_t i = 0; i < N * C * OH * OW; i++) {
-                dst[i] = src[i];
-            }
-            return;
+    // Source coordinates and weights along one axis, shifted by -pad_beg
+    struct InterpTable {
+        std::vector<int> idx0;
+        std::vector<int> idx1;
+        std::vector<float> lambda0;  // weight of idx1, idx0 gets 1 - lambda0
+    };
+
+    InterpTable table_h;
+    InterpTable table_w;
+    // padded input and output sizes the tables were built for
+    std::vector<int> table_dims;
+
+    void buildTable(InterpTable& table, int in_pad, int out_pad, float ratio) {
+        table.idx0.resize(out_pad);
+        table.idx1.resize(out_pad);
+        table.lambda0.resize(out_pad);
+        for (int o = 0; o < out_pad; o++) {
+            float f = ratio * o;
+            int i0 = static_cast<int>(f);
+            int i1 = (i0 < in_pad - 1) ? i0 + 1 : i0;
+            table.idx0[o] = i0 - pad_beg;
+            table.idx1[o] = i1 - pad_beg;
+            table.lambda0[o] = f - i0;
         }
+    }
+
+    void prepareTables(int IH_pad, int IW_pad, int OH_pad, int OW_pad) {
+        std::vector<int> dims = {IH_pad, IW_pad, OH_pad, OW_pad};
+        if (dims == table_dims)
+            return;
 
         float rh;
         float rw;
@@ -141,6 +170,24 @@ private:
             rw = static_cast<float>(IW_pad) / (OW_pad);
         }
 
+        buildTable(table_h, IH_pad, OH_pad, rh);
+        buildTable(table_w, IW_pad, OW_pad, rw);
+        table_dims = dims;
+    }
+
+    bool isIdentity(const size_t OH, const size_t OW) const {
+        return static_cast<size_t>(table_dims[0]) == OH && static_cast<size_t>(table_dims[1]) == OW;
+    }
+
+    void interpolate(const size_t N, const size_t C, const float *src, const size_t IH, const size_t IW,
+                     float *dst, const size_t OH, const size_t OW) {
+        if (isIdentity(OH, OW)) {
+            for (size_t i = 0; i < N * C * OH * OW; i++) {
+                dst[i] = src[i];
+            }
+            return;
+        }
+
 #if defined(HAVE_AVX512F)
         const int block_size = 16;
 #else
@@ -152,35 +199,24 @@ private:
 
         size_t CH = (C + block_size - 1) / block_size;
 
-        parallel_for3d(N, CH, OH_pad, [&](size_t n, size_t cb, size_t h) {
-                    const float *psrc = src + n * CB * IH * IW;
+        parallel_for3d(N, CH, OH, [&](size_t n, size_t cb, size_t h) {
+                    const float *psrc = src + n * CB * IH * IW + cb * block_size * IW * IH;
+                    const float *psrc0 = psrc + table_h.idx0[h] * static_cast<int>(IW * block_size);
+                    const float *psrc1 = psrc + table_h.idx1[h] * static_cast<int>(IW * block_size);
 
-                    float fh = rh * h;
-                    int ih0 = static_cast<int>(fh);
-                    int ih1 = (ih0 < IH_pad - 1) ? ih0 + 1 : ih0;
-
-                    float h_lambda0 = fh - ih0;
+                    float h_lambda0 = table_h.lambda0[h];
                     float h_lambda1 = 1.0f - h_lambda0;
 
-                    for (int w = 0; w < OW_pad; ++w) {
-                        float fw = rw * w;
-                        int iw0 = static_cast<int>(fw);
-                        int iw1 = (iw0 < IW_pad - 1) ? iw0 + 1 : iw0;
+                    float *pdst = dst + n * CB * OH * OW + cb * block_size * OW * OH + h * OW * block_size;
 
-                        float w_lambda0 = fw - iw0;
+                    for (size_t w = 0; w < OW; ++w, pdst += block_size) {
+                        float w_lambda0 = table_w.lambda0[w];
                         float w_lambda1 = 1.0f - w_lambda0;
 
-                        const float *psrc00 =
-                                psrc + cb * block_size * IW * IH + (y1 + ih0) * IW * block_size + (x1 + iw0) * block_size;
-                        const float *psrc01 =
-                                psrc + cb * block_size * IW * IH + (y1 + ih0) * IW * block_size + (x1 + iw1) * block_size;
-                        const float *psrc10 =
-                                psrc + cb * block_size * IW * IH + (y1 + ih1) * IW * block_size + (x1 + iw0) * block_size;
-                        const float *psrc11 =
-                                psrc + cb * block_size * IW * IH + (y1 + ih1) * IW * block_size + (x1 + iw1) * block_size;
-
-                        float *pdst = dst + n * CB * OH * OW + cb * block_size * OW * OH + (y2 + h) * OW * block_size +
-                                      (x2 + w) * block_size;
+                        const float *psrc00 = psrc0 + table_w.idx0[w] * block_size;
+                        const float *psrc01 = psrc0 + table_w.idx1[w] * block_size;
+                        const float *psrc10 = psrc1 + table_w.idx0[w] * block_size;
+                        const float *psrc11 = psrc1 + table_w.idx1[w] * block_size;
 
 #if defined(HAVE_AVX512F)
                         __m512 vwl0 = _mm512_set1_ps(w_lambda0);
@@ -245,51 +281,97 @@ private:
         });
     }
 
-    void interpolate_8u(Layout layout, const size_t N, const size_t C,
-        const uint8_t *src, const int x1, const int y1,
-        const int IH_pad, const int IW_pad, const size_t IH, const size_t IW,
-        float *dst, const int x2, const int y2,
-        const int OH_pad, const int OW_pad, const size_t OH, const size_t OW) {
-        if (IH_pad == OH_pad && IW_pad == OW_pad) {
+    // Interpolates the start of an FP32 output row with gathers and returns the number of
+    // computed outputs, the rest is left to the scalar loop of interpolate_pln
+    size_t interpolate_row(const float *psrc0, const float *psrc1, float h_lambda0,
+                           float *pdst, const size_t OW) const {
+        size_t w = 0;
+#if defined(HAVE_AVX2)
+        const int *iw0 = table_w.idx0.data();
+        const int *iw1 = table_w.idx1.data();
+        const float *w_lambda0 = table_w.lambda0.data();
+
+#if defined(HAVE_AVX512F)
+        __m512 vone = _mm512_set1_ps(1.0f);
+        __m512 vhl0 = _mm512_set1_ps(h_lambda0);
+        __m512 vhl1 = _mm512_set1_ps(1.0f - h_lambda0);
+        for (; w + 16 <= OW; w += 16) {
+            __m512i vidx0 = _mm512_loadu_si512(iw0 + w);
+            __m512i vidx1 = _mm512_loadu_si512(iw1 + w);
+            __m512 vwl0 = _mm512_loadu_ps(w_lambda0 + w);
+            __m512 vwl1 = _mm512_sub_ps(vone, vwl0);
+            __m512 vsrc00 = _mm512_i32gather_ps(vidx0, psrc0, sizeof(float));
+            __m512 vsrc01 = _mm512_i32gather_ps(vidx1, psrc0, sizeof(float));
+            __m512 vsrc10 = _mm512_i32gather_ps(vidx0, psrc1, sizeof(float));
+            __m512 vsrc11 = _mm512_i32gather_ps(vidx1, psrc1, sizeof(float));
+
+            __m512 vdst0 = _mm512_fmadd_ps(vwl1, vsrc00, _mm512_mul_ps(vwl0, vsrc01));
+            __m512 vdst1 = _mm512_fmadd_ps(vwl1, vsrc10, _mm512_mul_ps(vwl0, vsrc11));
+            __m512 vdst  = _mm512_fmadd_ps(vhl1, vdst0, _mm512_mul_ps(vhl0, vdst1));
+
+            _mm512_storeu_ps(pdst + w, vdst);
+        }
+#else
+        __m256 vone = _mm256_set1_ps(1.0f);
+        __m256 vhl0 = _mm256_set1_ps(h_lambda0);
+        __m256 vhl1 = _mm256_set1_ps(1.0f - h_lambda0);
+        for (; w + 8 <= OW; w += 8) {
+            __m256i vidx0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(iw0 + w));
+            __m256i vidx1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(iw1 + w));
+            __m256 vwl0 = _mm256_loadu_ps(w_lambda0 + w);
+            __m256 vwl1 = _mm256_sub_ps(vone, vwl0);
+            __m256 vsrc00 = _mm256_i32gather_ps(psrc0, vidx0, sizeof(float));
+            __m256 vsrc01 = _mm256_i32gather_ps(psrc0, vidx1, sizeof(float));
+            __m256 vsrc10 = _mm256_i32gather_ps(psrc1, vidx0, sizeof(float));
+            __m256 vsrc11 = _mm256_i32gather_ps(psrc1, vidx1, sizeof(float));
+
+            __m256 vdst0 = _mm256_fmadd_ps(vwl1, vsrc00, _mm256_mul_ps(vwl0, vsrc01));
+            __m256 vdst1 = _mm256_fmadd_ps(vwl1, vsrc10, _mm256_mul_ps(vwl0, vsrc11));
+            __m256 vdst  = _mm256_fmadd_ps(vhl1, vdst0, _mm256_mul_ps(vhl0, vdst1));
+
+            _mm256_storeu_ps(pdst + w, vdst);
+        }
+#endif
+#endif
+        return w;
+    }
+
+    // U8 rows are converted while interpolating and have no vector path
+    size_t interpolate_row(const uint8_t *, const uint8_t *, float, float *, const size_t) const {
+        return 0;
+    }
+
+    // NCHW kernel for FP32 and U8 inputs, U8 is converted to FP32 while interpolating
+    template <typename T>
+    void interpolate_pln(const size_t N, const size_t C, const T *src, const size_t IH, const size_t IW,
+                         float *dst, const size_t OH, const size_t OW) {
+        if (isIdentity(OH, OW)) {
             for (size_t i = 0; i < N * C * OH * OW; i++) {
                 dst[i] = static_cast<float>(src[i]);
             }
             return;
         }
 
-        float rh;
-        float rw;
-        if (align_corners) {
-            rh = (OH_pad > 1) ? static_cast<float>(IH_pad - 1) / (OH_pad - 1) : 0.0f;
-            rw = (OW_pad > 1) ? static_cast<float>(IW_pad - 1) / (OW_pad - 1) : 0.0f;
-        } else {
-            rh = static_cast<float>(IH_pad) / (OH_pad);
-            rw = static_cast<float>(IW_pad) / (OW_pad);
-        }
+        const int *iw0 = table_w.idx0.data();
+        const int *iw1 = table_w.idx1.data();
+        const float *w_lambda0 = table_w.lambda0.data();
 
-        parallel_for3d(N, C, OH_pad, [&](size_t n, size_t cb, size_t h) {
-            const uint8_t *psrc = src + n * C * IH * IW;
+        parallel_for3d(N, C, OH, [&](size_t n, size_t c, size_t h) {
+            const T *psrc = src + (n * C + c) * IH * IW;
+            const T *psrc0 = psrc + table_h.idx0[h] * static_cast<int>(IW);
+            const T *psrc1 = psrc + table_h.idx1[h] * static_cast<int>(IW);
 
-            float fh = rh * h;
-            int ih0 = static_cast<int>(fh);
-            int ih1 = (ih0 < IH_pad - 1) ? ih0 + 1 : ih0;
-
-            float h_lambda0 = fh - ih0;
+            float h_lambda0 = table_h.lambda0[h];
             float h_lambda1 = 1.0f - h_lambda0;
 
-            for (int w = 0; w < OW_pad; ++w) {
-                float fw = rw * w;
-                int iw0 = static_cast<int>(fw);
-                int iw1 = (iw0 < IW_pad - 1) ? iw0 + 1 : iw0;
-
-                float w_lambda0 = fw - iw0;
-                float w_lambda1 = 1.0f - w_lambda0;
+            float *pdst = dst + (n * C + c) * OH * OW + h * OW;
 
-                dst[n * C * OH * OW + cb * OW * OH + (y2 + h) * OW + (x2 + w)] =
-                    h_lambda1 * (w_lambda1 * static_cast<float>(psrc[cb * IW * IH + (y1 + ih0) * IW + (x1 + iw0)]) +
-                    w_lambda0 * static_cast<float>(psrc[cb * IW * IH + (y1 + ih0) * IW + (x1 + iw1)])) +
-                    h_lambda0 * (w_lambda1 * static_cast<float>(psrc[cb * IW * IH + (y1 + ih1) * IW + (x1 + iw0)]) +
-                    w_lambda0 * static_cast<float>(psrc[cb * IW * IH + (y1 + ih1) * IW + (x1 + iw1)]));
+            for (size_t w = interpolate_row(psrc0, psrc1, h_lambda0, pdst, OW); w < OW; ++w) {
+                float w_lambda1 = 1.0f - w_lambda0[w];
+                pdst[w] = h_lambda1 * (w_lambda1 * static_cast<float>(psrc0[iw0[w]]) +
+                                       w_lambda0[w] * static_cast<float>(psrc0[iw1[w]])) +
+                          h_lambda0 * (w_lambda1 * static_cast<float>(psrc1[iw0[w]]) +
+                                       w_lambda0[w] * static_cast<float>(psrc1[iw1[w]]));
             }
         });
     }
@@ -297,6 +379,7 @@ private:
 
 REG_FACTORY_FOR(ImplFactory<InterpImpl>, Interp);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
@@ -5,9 +5,19 @@
 #include "ext_list.hpp"
 
 #include <string>
+#include <iostream>
+#include <cstdlib>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <cstdint>
 #include <algorithm>
+#if defined(_WIN32)
+#include <intrin.h>
+#include <immintrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
 
 namespace InferenceEngine {
 namespace Extensions {
@@ -25,10 +35,104 @@ void CpuExtensions::AddExt(std::string name, ext_factory factory) {
     GetExtensionsHolder()->list[name] = factory;
 }
 
+void CpuExtensions::AddExt(std::string name, ext_factory factory, CpuIsa isa) {
+    GetExtensionsHolder()->isa_list[name][isa] = factory;
+}
+
 void CpuExtensions::AddShapeInferImpl(std::string name, const IShapeInferImpl::Ptr& impl) {
     GetExtensionsHolder()->si_list[name] = impl;
 }
 
+static const char* isaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::SSE42: return "SSE4.2";
+        case CpuIsa::AVX2: return "AVX2";
+        case CpuIsa::AVX512F: return "AVX512F";
+    }
+    return "unknown";
+}
+
+CpuIsa CpuExtensions::GetHostIsa() {
+#if defined(_WIN32) || defined(__x86_64__) || defined(__i386__)
+    auto cpuid = [](unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#if defined(_WIN32)
+        int r[4];
+        __cpuidex(r, static_cast<int>(leaf), static_cast<int>(subleaf));
+        for (int i = 0; i < 4; i++)
+            regs[i] = static_cast<unsigned>(r[i]);
+#else
+        __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+    };
+
+    unsigned regs[4] = {0, 0, 0, 0};
+    cpuid(0, 0, regs);
+    const unsigned max_leaf = regs[0];
+    if (max_leaf < 1)
+        return CpuIsa::SSE42;
+
+    cpuid(1, 0, regs);
+    const bool osxsave = (regs[2] >> 27) & 1;
+    const bool avx = (regs[2] >> 28) & 1;
+    const bool fma = (regs[2] >> 12) & 1;
+    if (!osxsave || !avx || !fma || max_leaf < 7)
+        return CpuIsa::SSE42;
+
+    // the OS must save the upper halves of the vector registers on context switch
+#if defined(_WIN32)
+    const uint64_t xcr0 = _xgetbv(0);
+#else
+    uint32_t xcr0_lo, xcr0_hi;
+    __asm__ __volatile__("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    const uint64_t xcr0 = (static_cast<uint64_t>(xcr0_hi) << 32) | xcr0_lo;
+#endif
+    const uint64_t ymm_state = 0x6;
+    const uint64_t zmm_state = 0xe6;
+
+    cpuid(7, 0, regs);
+    const bool avx2 = (regs[1] >> 5) & 1;
+    const bool avx512f = (regs[1] >> 16) & 1;
+    if (avx512f && (xcr0 & zmm_state) == zmm_state)
+        return CpuIsa::AVX512F;
+    if (avx2 && (xcr0 & ymm_state) == ymm_state)
+        return CpuIsa::AVX2;
+#endif
+    return CpuIsa::SSE42;
+}
+
+CpuExtensions::CpuExtensions() {
+    static std::once_flag selected;
+    std::call_once(selected, &CpuExtensions::SelectIsaImplementations);
+}
+
+void CpuExtensions::SelectIsaImplementations() {
+    auto holder = GetExtensionsHolder();
+    const CpuIsa host_isa = GetHostIsa();
+
+    std::string log = std::string("ie-cpu-ext: host supports ") + isaName(host_isa) + ", kernels:";
+    for (auto& layer : holder->isa_list) {
+        // builds are ordered from the oldest instruction set, take the newest one the host can run
+        auto best = layer.second.end();
+        for (auto it = layer.second.begin(); it != layer.second.end() && it->first <= host_isa; it++)
+            best = it;
+        if (best == layer.second.end()) {
+            holder->dispatch_errors.push_back(std::string("ie-cpu-ext: no build of ") + layer.first +
+                                              " runs on a host with " + isaName(host_isa));
+            continue;
+        }
+
+        holder->list[layer.first] = best->second;
+        log += std::string(" ") + layer.first + "(" + isaName(best->first) + ")";
+    }
+    if (!holder->isa_list.empty() && std::getenv("IE_CPU_EXTENSION_QUIET") == nullptr)
+        std::cout << "[ INFO ] " << log << std::endl;
+}
+
+void CpuExtensions::SetLogCallback(IErrorListener& listener) noexcept {
+    for (auto& error : CpuExtensions::GetExtensionsHolder()->dispatch_errors)
+        listener.onError(error.c_str());
+}
+
 void CpuExtensions::GetVersion(const Version*& versionInfo) const noexcept {
     static Version ExtensionDescription = {
             { 2, 1 },    // extension API version
@@ -10,6 +10,7 @@
 #include <map>
 #include <memory>
 #include <algorithm>
+#include <vector>
 
 namespace InferenceEngine {
 namespace Extensions {
@@ -17,13 +18,23 @@ namespace Cpu {
 
 using ext_factory = std::function<InferenceEngine::ILayerImplFactory*(const InferenceEngine::CNNLayer*)>;
 
+/**
+ * @brief Instruction sets the hot kernels are built for, from the oldest to the newest.
+ * The best one supported by the host is selected when CpuExtensions is created.
+ */
+enum class CpuIsa { SSE42, AVX2, AVX512F };
+
 struct ExtensionsHolder {
     std::map<std::string, ext_factory> list;
     std::map<std::string, IShapeInferImpl::Ptr> si_list;
+    std::map<std::string, std::map<CpuIsa, ext_factory>> isa_list;
+    std::vector<std::string> dispatch_errors;
 };
 
 class INFERENCE_ENGINE_API_CLASS(CpuExtensions) : public IExtension {
 public:
+    CpuExtensions();
+
     StatusCode getPrimitiveTypes(char**& types, unsigned int& size, ResponseDesc* resp) noexcept override;
 
     StatusCode
@@ -35,7 +46,7 @@ public:
 
     void GetVersion(const InferenceEngine::Version*& versionInfo) const noexcept override;
 
-    void SetLogCallback(InferenceEngine::IErrorListener& /*listener*/) noexcept override {}
+    void SetLogCallback(InferenceEngine::IErrorListener& listener) noexcept override;
 
     void Unload() noexcept override {}
 
@@ -45,11 +56,17 @@ public:
 
     static void AddExt(std::string name, ext_factory factory);
 
+    static void AddExt(std::string name, ext_factory factory, CpuIsa isa);
+
     static void AddShapeInferImpl(std::string name, const IShapeInferImpl::Ptr& impl);
 
     static std::shared_ptr<ExtensionsHolder> GetExtensionsHolder();
 
+    static CpuIsa GetHostIsa();
+
 private:
+    static void SelectIsaImplementations();
+
     template<class T>
     void collectTypes(char**& types, unsigned int& size, const std::map<std::string, T> &factories);
 };
@@ -63,10 +80,35 @@ public:
                                   return new Ext(layer);
                               });
     }
+
+    ExtRegisterBase(const std::string& type, CpuIsa isa) {
+        CpuExtensions::AddExt(type,
+                              [](const CNNLayer* layer) -> InferenceEngine::ILayerImplFactory* {
+                                  return new Ext(layer);
+                              }, isa);
+    }
 };
 
+/*
+ * Sources listed in DISPATCH_SRC of CMakeLists.txt are compiled once per CpuIsa with CPU_EXT_ISA
+ * set to its name. Everything they define goes to an inline namespace of that name, so the
+ * builds do not clash at link time, and REG_FACTORY_FOR registers them as candidates for dispatch.
+ */
+#if defined(CPU_EXT_ISA)
+#define CPU_EXT_ISA_CONCAT_IMPL(__a, __b) __a##__b
+#define CPU_EXT_ISA_CONCAT(__a, __b) CPU_EXT_ISA_CONCAT_IMPL(__a, __b)
+#define CPU_EXT_ISA_NAMESPACE_BEGIN inline namespace CPU_EXT_ISA_CONCAT(isa_, CPU_EXT_ISA) {
+#define CPU_EXT_ISA_NAMESPACE_END }
+
+#define REG_FACTORY_FOR(__prim, __type) \
+static ExtRegisterBase<__prim> __reg__##__type(#__type, CpuIsa::CPU_EXT_ISA)
+#else
+#define CPU_EXT_ISA_NAMESPACE_BEGIN
+#define CPU_EXT_ISA_NAMESPACE_END
+
 #define REG_FACTORY_FOR(__prim, __type) \
 static ExtRegisterBase<__prim> __reg__##__type(#__type)
+#endif
 
 }  // namespace Cpu
 }  // namespace Extensions
@@ -10,7 +10,7 @@
 #include <vector>
 #include <cassert>
 #include <algorithm>
-#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
 #include <immintrin.h>
 #endif
 #include "ie_parallel.hpp"
@@ -18,6 +18,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 inline int div_up(const int a, const int b) {
     assert(b);
@@ -62,14 +63,171 @@ public:
     }
 
 private:
+    // Count, mean and sum of squared deviations of a set of values. Partial results of disjoint sets
+    // are combined with Chan's update, so the sets can be reduced by different threads in any order.
+    struct Moments {
+        double count = 0.0;
+        double mean = 0.0;
+        double m2 = 0.0;
+
+        // n values whose differences from shift add up to sum and whose squared differences add up to sqr
+        static Moments from_sums(size_t n, double sum, double sqr, float shift) {
+            Moments result;
+            if (n) {
+                result.count = static_cast<double>(n);
+                result.mean = shift + sum / result.count;
+                result.m2 = (std::max)(sqr - sum * sum / result.count, 0.0);
+            }
+            return result;
+        }
+
+        void merge(const Moments& other) {
+            if (other.count == 0.0)
+                return;
+            if (count == 0.0) {
+                *this = other;
+                return;
+            }
+            double total = count + other.count;
+            double delta = other.mean - mean;
+            mean += delta * other.count / total;
+            m2 += other.m2 + delta * delta * count * other.count / total;
+            count = total;
+        }
+    };
+
+    // Mean and the factor that normalizes (x - mean) of one reduction group
+    struct Stats {
+        float mean;
+        float scale;
+    };
+
+#if defined(HAVE_AVX512F)
+    typedef __m512 vec_type;
+    static const size_t vec_size = 16;
+#elif defined(HAVE_AVX2)
+    typedef __m256 vec_type;
+    static const size_t vec_size = 8;
+#elif defined(HAVE_SSE)
+    typedef __m128 vec_type;
+    static const size_t vec_size = 4;
+#endif
+
+#if defined(HAVE_AVX512F)
+    static const size_t blk_size = 16;
+#else
+    static const size_t blk_size = 8;
+#endif
+
+    // Values one task reads: enough to amortize scheduling, small enough to split a 1080p plane
+    static const size_t task_size = 16384;
+    // Vectors accumulated in float before the partial sums are folded into double moments
+    static const size_t flush_size = 256;
+
     void mvn_pln(const float* src_data, float* dst_data, const SizeVector& dims);
     void mvn_blk(const float* src_data, float* dst_data, const SizeVector& dims);
 
+    Moments moments_pln(const float* src_data, size_t count, float shift) const;
+    void moments_blk(const float* src_data, size_t count, const float* shift, Moments* lanes) const;
+    Stats finalize(const Moments& moments) const;
+
     bool across_channels = false;
     bool normalize_variance = true;
     float eps = 1e-9f;
+
+    std::vector<Moments> partials;
+    std::vector<Stats> stats;
 };
 
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+const size_t MVNImpl::vec_size;
+#endif
+const size_t MVNImpl::blk_size;
+const size_t MVNImpl::task_size;
+const size_t MVNImpl::flush_size;
+
+MVNImpl::Moments MVNImpl::moments_pln(const float* src_data, size_t count, float shift) const {
+    Moments result;
+    size_t i = 0;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+    const vec_type vshift = _mm_uni_set1_ps(shift);
+    while (i + vec_size <= count) {
+        size_t n = (std::min)((count - i) / vec_size, flush_size);
+        vec_type vsum = _mm_uni_setzero_ps();
+        vec_type vsqr = _mm_uni_setzero_ps();
+        for (size_t end = i + n * vec_size; i < end; i += vec_size) {
+            vec_type vsrc = _mm_uni_sub_ps(_mm_uni_loadu_ps(src_data + i), vshift);
+            vsum = _mm_uni_add_ps(vsum, vsrc);
+            vsqr = _mm_uni_add_ps(vsqr, _mm_uni_mul_ps(vsrc, vsrc));
+        }
+
+        float sum[vec_size], sqr[vec_size];
+        _mm_uni_storeu_ps(sum, vsum);
+        _mm_uni_storeu_ps(sqr, vsqr);
+        for (size_t l = 0; l < vec_size; l++)
+            result.merge(Moments::from_sums(n, sum[l], sqr[l], shift));
+    }
+#endif
+    double sum = 0.0, sqr = 0.0;
+    size_t tail = count - i;
+    for (; i < count; i++) {
+        double value = static_cast<double>(src_data[i]) - shift;
+        sum += value;
+        sqr += value * value;
+    }
+    result.merge(Moments::from_sums(tail, sum, sqr, shift));
+    return result;
+}
+
+// count vectors of blk_size channels, moments are accumulated per channel
+void MVNImpl::moments_blk(const float* src_data, size_t count, const float* shift, Moments* lanes) const {
+    size_t l0 = 0;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+    for (; l0 + vec_size <= blk_size; l0 += vec_size) {
+        const vec_type vshift = _mm_uni_loadu_ps(shift + l0);
+        for (size_t i = 0; i < count;) {
+            size_t n = (std::min)(count - i, flush_size);
+            vec_type vsum = _mm_uni_setzero_ps();
+            vec_type vsqr = _mm_uni_setzero_ps();
+            for (size_t end = i + n; i < end; i++) {
+                vec_type vsrc = _mm_uni_sub_ps(_mm_uni_loadu_ps(src_data + i * blk_size + l0), vshift);
+                vsum = _mm_uni_add_ps(vsum, vsrc);
+                vsqr = _mm_uni_add_ps(vsqr, _mm_uni_mul_ps(vsrc, vsrc));
+            }
+
+            float sum[vec_size], sqr[vec_size];
+            _mm_uni_storeu_ps(sum, vsum);
+            _mm_uni_storeu_ps(sqr, vsqr);
+            for (size_t l = 0; l < vec_size; l++)
+                lanes[l0 + l].merge(Moments::from_sums(n, sum[l], sqr[l], shift[l0 + l]));
+        }
+    }
+#endif
+    for (; l0 < blk_size; l0++) {
+        double sum = 0.0, sqr = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            double value = static_cast<double>(src_data[i * blk_size + l0]) - shift[l0];
+            sum += value;
+            sqr += value * value;
+        }
+        lanes[l0].merge(Moments::from_sums(count, sum, sqr, shift[l0]));
+    }
+}
+
+MVNImpl::Stats MVNImpl::finalize(const Moments& moments) const {
+    Stats result;
+    result.mean = static_cast<float>(moments.mean);
+    result.scale = 1.f;
+    if (normalize_variance && moments.count > 0.0) {
+        double variance = moments.m2 / moments.count;
+        result.scale = static_cast<float>(1.0 / std::sqrt(variance + eps));
+    }
+    return result;
+}
+
+// Statistics come from one sweep over the input: every (batch, channel) plane is cut into tasks of
+// task_size values whose moments are computed in parallel and merged afterwards, per plane or over
+// all planes of a batch when across_channels is set. A second sweep writes (x - mean) * scale.
 void MVNImpl::mvn_pln(const float* src_data, float* dst_data, const SizeVector& dims) {
     size_t dims_size = dims.size();
     size_t N = (dims_size > 0) ? dims[0] : 1lu;
@@ -78,154 +236,48 @@ void MVNImpl::mvn_pln(const float* src_data, float* dst_data, const SizeVector&
     size_t H = (dims_size > 3) ? dims[dims_size - 2] : 1lu;
     size_t W = (dims_size > 2) ? dims[dims_size - 1] : 1lu;
 
-    size_t C1 = H * W;
-    size_t C2 = C1 * D;
-    size_t C3 = C2 * C;
-
-    for (size_t b = 0lu; b < N; b++) {
-        // Calculate mean value
-        size_t cb = b * C3;
-        if (across_channels) {
-            double mean = 0.0;
-            mean = parallel_sum(C, mean, [&](size_t c)->double {
-                double mean_internal = 0.0;
-                size_t cc = cb + c * C2;
-                for (size_t d = 0lu; d < D; d++) {
-                    size_t cd = cc + d * C1;
-                    for (size_t h = 0lu; h < H; h++) {
-                        size_t ch = cd + h * W;
-                        for (size_t w = 0lu; w < W; w++) {
-                            mean_internal += src_data[ch + w];
-                        }
-                    }
-                }
-                return mean_internal;
-            });
-
-            mean /= C3;
-            parallel_for(C, [&](int c) {
-                size_t cc = cb + c * C2;
-                for (size_t d = 0lu; d < D; d++) {
-                    size_t cd = cc + d * C1;
-                    for (size_t h = 0lu; h < H; h++) {
-                        size_t ch = cd + h * W;
-                        for (size_t w = 0lu; w < W; w++) {
-                            size_t cw = ch + w;
-                            dst_data[cw] = src_data[cw] - static_cast<float>(mean);
-                        }
-                    }
-                }
-            });
-        } else {
-            parallel_for(C, [&](size_t c) {
-                double mean = 0.f;
-                size_t cc = cb + c * C2;
-                for (size_t d = 0lu; d < D; d++) {
-                    size_t cd = cc + d * C1;
-                    for (size_t h = 0lu; h < H; h++) {
-                        size_t ch = cd + h * W;
-                        for (size_t w = 0lu; w < W; w++) {
-                            mean += src_data[ch + w];
-                        }
-                    }
-                }
-
-                mean /= static_cast<double>(C2);
-
-                for (size_t d = 0lu; d < D; d++) {
-                    size_t cd = cc + d * C1;
-                    for (size_t h = 0lu; h < H; h++) {
-                        size_t ch = cd + h * W;
-                        for (size_t w = 0lu; w < W; w++) {
-                            size_t cw = ch + w;
-                            dst_data[cw] = src_data[cw] - static_cast<float>(mean);
-                        }
-                    }
-                }
-            });
+    size_t C2 = D * H * W;
+    size_t tasks = static_cast<size_t>(div_up(static_cast<int>(C2), static_cast<int>(task_size)));
+
+    partials.resize(N * C * tasks);
+    parallel_for3d(N, C, tasks, [&](size_t b, size_t c, size_t t) {
+        const float* plane = src_data + (b * C + c) * C2;
+        size_t start = t * task_size;
+        partials[(b * C + c) * tasks + t] = moments_pln(plane + start, (std::min)(task_size, C2 - start), plane[0]);
+    });
+
+    size_t groups = across_channels ? N : N * C;
+    size_t group_partials = across_channels ? C * tasks : tasks;
+    stats.resize(groups);
+    parallel_for(groups, [&](size_t g) {
+        Moments moments;
+        for (size_t i = 0; i < group_partials; i++)
+            moments.merge(partials[g * group_partials + i]);
+        stats[g] = finalize(moments);
+    });
+
+    parallel_for3d(N, C, tasks, [&](size_t b, size_t c, size_t t) {
+        const Stats& s = stats[across_channels ? b : b * C + c];
+        size_t start = (b * C + c) * C2 + t * task_size;
+        size_t end = start + (std::min)(task_size, C2 - t * task_size);
+        size_t i = start;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+        vec_type vmean = _mm_uni_set1_ps(s.mean);
+        vec_type vscale = _mm_uni_set1_ps(s.scale);
+        for (; i + vec_size <= end; i += vec_size) {
+            vec_type vsrc = _mm_uni_sub_ps(_mm_uni_loadu_ps(src_data + i), vmean);
+            _mm_uni_storeu_ps(dst_data + i, _mm_uni_mul_ps(vsrc, vscale));
         }
-    }
-
-    if (normalize_variance) {
-        for (size_t b = 0lu; b < N; b++) {
-            // Calculate variances value
-            size_t cb = b * C3;
-            if (across_channels) {
-                double variance = 0.0;
-                variance = parallel_sum(C, variance, [&](size_t c)->double {
-                    double variance_internal = 0.0;
-                    size_t cc = cb + c * C2;
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = cc + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * W;
-                            for (size_t w = 0lu; w < W; w++) {
-                                variance_internal += std::pow(dst_data[ch + w], 2);
-                            }
-                        }
-                    }
-                    return variance_internal;
-                });
-
-                variance /= C3;
-                variance += eps;
-                variance = std::pow(variance, 0.5f);
-                parallel_for(C, [&](int c) {
-                    size_t cc = cb + c * C2;
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = cc + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * W;
-                            for (size_t w = 0lu; w < W; w++) {
-                                dst_data[ch + w] /= static_cast<float>(variance);
-                            }
-                        }
-                    }
-                });
-            } else {
-                parallel_for(C, [&](size_t c) {
-                    double variance = 0.0;
-                    size_t cc = cb + c * C2;
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = cc + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * W;
-                            for (size_t w = 0lu; w < W; w++) {
-                                variance += std::pow(dst_data[ch + w], 2);
-                            }
-                        }
-                    }
-
-                    variance /= static_cast<double>(C2);
-                    variance += eps;
-                    variance = std::pow(variance, 0.5f);
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = cc + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * W;
-                            for (size_t w = 0lu; w < W; w++) {
-                                dst_data[ch + w] /= static_cast<float>(variance);
-                            }
-                        }
-                    }
-                });
-            }
-        }
-    }
+#endif
+        for (; i < end; i++)
+            dst_data[i] = (src_data[i] - s.mean) * s.scale;
+    });
 }
 
+// Same scheme on the blocked layout: a task covers a run of blk_size-channel vectors of one channel
+// block and keeps moments per channel. Padding channels of the last block are left out of
+// the across_channels statistics.
 void MVNImpl::mvn_blk(const float* src_data, float* dst_data, const SizeVector& dims) {
-#if defined(HAVE_AVX512F)
-    size_t blk_size = 16;
-#else
-    size_t blk_size = 8lu;
-#endif
-
-#if defined(HAVE_AVX512F)
-    typedef __m512 vec_type;
-#elif defined(HAVE_AVX2)
-    typedef __m256 vec_type;
-#endif
     size_t dims_size = dims.size();
     size_t N = (dims_size > 0) ? dims[0] : 1lu;
     size_t C = (dims_size > 1) ? dims[1] : 1lu;
@@ -233,260 +285,81 @@ void MVNImpl::mvn_blk(const float* src_data, float* dst_data, const SizeVector&
     size_t H = (dims_size > 3) ? dims[dims_size - 2] : 1lu;
     size_t W = (dims_size > 2) ? dims[dims_size - 1] : 1lu;
 
-    int CB = div_up(static_cast<int>(C), static_cast<int>(blk_size));
-
-    size_t C0 = W * blk_size;
-    size_t C1 = C0 * H;
-    size_t C2 = C1 * D;
-    size_t C3 = C2 * CB;
-    size_t C5 = C * D * H * W;
-
-    if (normalize_variance) {
-        for (size_t b = 0lu; b < N; b++) {
-            size_t ccb = b * C3;
-            if (across_channels) {
-                double mean = 0.0;
-                mean = parallel_sum3d(CB, D, H, mean, [&](size_t cb, size_t d, size_t h)->double {
-                    size_t ccbd = ccb + cb * C2 + d * C1 + h * C0;
-                    size_t min_cb = std::min(blk_size, C - cb * blk_size);
-                    double mean_internal = 0.0;
-                    for (size_t w = 0lu; w < W; w++) {
-                        size_t cw = ccbd + w * blk_size;
-                        for (size_t c = 0lu; c < min_cb; c++) {
-                            mean_internal += src_data[cw + c];
-                        }
-                    }
-                    return mean_internal;
-                });
-
-                mean /= static_cast<double>(C5);
-
-                double variance = 0.0;
-                variance = parallel_sum3d(CB, D, H, variance, [&](size_t cb, size_t d, size_t h)->double {
-                    size_t ccbd = ccb + cb * C2 + d * C1 + h * C0;
-                    double variance_internal = 0.0;
-                    for (size_t w = 0lu, min_cb = std::min(blk_size, C - cb * blk_size); w < W; w++) {
-                        size_t cw = ccbd + w * blk_size;
-                        for (size_t c = 0lu; c < min_cb; c++) {
-                            variance_internal += std::pow(static_cast<double>(src_data[cw + c]) - mean, 2);
-                        }
-                    }
-                    return variance_internal;
-                });
-
-                variance /= static_cast<double>(C5);
-                variance += eps;
-                variance = std::pow(variance, 0.5f);
-
-                parallel_for3d(CB, D, H, [&](size_t cb, size_t d, size_t h) {
-                    size_t ccbd = ccb + cb * C2 + d * C1 + h * C0;
-                    for (size_t w = 0lu, min_cb = std::min(blk_size, C - cb * blk_size); w < W; w++) {
-                        size_t cw = ccbd + w * blk_size;
-                        for (size_t c = 0lu; c < min_cb; c++) {
-                            size_t src_offset = cw + c;
-
-                            dst_data[src_offset] = static_cast<float>((static_cast<double>(src_data[src_offset]) - mean) / variance);
-                        }
-                    }
-                });
-            } else {
-                parallel_for(CB, [&](size_t cb) {
-                    size_t src_off = ccb + cb * C2;
-#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
-                    vec_type vmean = _mm_uni_setzero_ps();
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = src_off + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * C0;
-                            for (size_t w = 0lu; w < W; w++) {
-                                vec_type vsrc = _mm_uni_loadu_ps(src_data + ch + w * blk_size);
-                                vmean = _mm_uni_add_ps(vmean, vsrc);
-                            }
-                        }
-                    }
-
-                    vec_type vsize = _mm_uni_set1_ps(static_cast<float>(D * H * W));
-                    vmean = _mm_uni_div_ps(vmean, vsize);
-
-                    vec_type vvariance = _mm_uni_setzero_ps();
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = src_off + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * C0;
-                            for (size_t w = 0lu; w < W; w++) {
-                                vec_type vsrc = _mm_uni_loadu_ps(src_data + ch + w * blk_size);
-                                vsrc = _mm_uni_sub_ps(vsrc, vmean);
-                                vvariance = _mm_uni_add_ps(vvariance, _mm_uni_mul_ps(vsrc, vsrc));
-                            }
-                        }
-                    }
-                    vvariance = _mm_uni_div_ps(vvariance, vsize);
-
-                    vec_type veps = _mm_uni_set1_ps(eps);
-                    vvariance = _mm_uni_add_ps(vvariance, veps);
-
-                    vvariance = _mm_uni_sqrt_ps(vvariance);
-
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = src_off + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * C0;
-                            for (size_t w = 0lu; w < W; w++) {
-                                size_t offset = ch + w * blk_size;
-                                vec_type vsrc = _mm_uni_loadu_ps(src_data + offset);
-                                vsrc = _mm_uni_sub_ps(vsrc, vmean);
-                                _mm_uni_storeu_ps(dst_data + offset, _mm_uni_div_ps(vsrc, vvariance));
-                            }
-                        }
-                    }
-#else
-                    size_t min_cb = std::min(blk_size, C - cb * blk_size);
-                    for (size_t c = 0; c < min_cb; c++) {
-                        size_t cc = src_off + c;
-
-                        double mean = 0.0;
-                        for (size_t d = 0; d < D; d++) {
-                            size_t cd = cc + d * C1;
-                            for (size_t h = 0; h < H; h++) {
-                                size_t ch = cd + h * C0;
-                                for (size_t w = 0; w < W; w++) {
-                                    mean += src_data[ch + w * blk_size];
-                                }
-                            }
-                        }
-
-                        size_t C4 = D * H * W;
-                        mean /= static_cast<double>(C4);
-
-                        double variance = 0.0;
-                        for (size_t d = 0lu; d < D; d++) {
-                            size_t cd = cc + d * C1;
-                            for (size_t h = 0lu; h < H; h++) {
-                                size_t ch = cd + h * C0;
-                                for (size_t w = 0lu; w < W; w++) {
-                                    double value = static_cast<double>(src_data[ch + w * blk_size]) - mean;
-                                    variance += std::pow(value, 2);
-                                }
-                            }
-                        }
-
-                        variance /= static_cast<double>(C4);
-                        variance += eps;
-                        variance = std::pow(variance, 0.5f);
-
-                        for (size_t d = 0lu; d < D; d++) {
-                            size_t cd = cc + d * C1;
-                            for (size_t h = 0lu; h < H; h++) {
-                                size_t ch = cd + h * C0;
-                                for (size_t w = 0lu; w < W; w++) {
-                                    size_t index = ch + w * blk_size;
-                                    dst_data[index] = (src_data[index] - static_cast<float>(mean)) / static_cast<float>(variance);
-                                }
-                            }
-                        }
-                    }
-#endif
-                });
+    size_t CB = static_cast<size_t>(div_up(static_cast<int>(C), static_cast<int>(blk_size)));
+
+    size_t C4 = D * H * W;            // vectors in one channel block
+    size_t C2 = C4 * blk_size;        // values in one channel block
+    size_t task_vectors = task_size / blk_size;
+    size_t tasks = static_cast<size_t>(div_up(static_cast<int>(C4), static_cast<int>(task_vectors)));
+
+    partials.assign(N * CB * tasks * blk_size, Moments());
+    parallel_for3d(N, CB, tasks, [&](size_t b, size_t cb, size_t t) {
+        const float* block = src_data + (b * CB + cb) * C2;
+        size_t start = t * task_vectors;
+        moments_blk(block + start * blk_size, (std::min)(task_vectors, C4 - start), block,
+                    &partials[((b * CB + cb) * tasks + t) * blk_size]);
+    });
+
+    stats.resize(N * CB * blk_size);
+    if (across_channels) {
+        parallel_for(N, [&](size_t b) {
+            Moments moments;
+            for (size_t cb = 0; cb < CB; cb++) {
+                size_t lanes = (std::min)(blk_size, C - cb * blk_size);
+                for (size_t t = 0; t < tasks; t++) {
+                    for (size_t l = 0; l < lanes; l++)
+                        moments.merge(partials[((b * CB + cb) * tasks + t) * blk_size + l]);
+                }
             }
-        }
+            Stats s = finalize(moments);
+            std::fill(stats.begin() + b * CB * blk_size, stats.begin() + (b + 1) * CB * blk_size, s);
+        });
     } else {
-        for (size_t b = 0; b < N; b++) {
-            size_t ccb = b * C3;
-            if (across_channels) {
-                double mean = 0.0;
-                mean = parallel_sum3d(CB, D, H, mean, [&](size_t cb, size_t d, size_t h)->double {
-                    size_t ccbd = ccb + cb * C2 + d * C1 + h * C0;
-                    double mean_internal = 0.f;
-                    for (size_t w = 0lu, min_cb = std::min(blk_size, C - cb * blk_size); w < W; w++) {
-                        size_t cw = ccbd + w * blk_size;
-                        for (size_t c = 0lu; c < min_cb; c++) {
-                            mean_internal += src_data[cw + c];
-                        }
-                    }
-                    return mean_internal;
-                });
-
-                mean /= static_cast<double>(C5);
-
-                parallel_for3d(CB, D, H, [&](size_t cb, size_t d, size_t h) {
-                    size_t ccbd = ccb + cb * C2 + d * C1 + h * C0;
-                    for (size_t w = 0lu, min_cb = std::min(blk_size, C - cb * blk_size); w < W; w++) {
-                        size_t cw = ccbd + w * blk_size;
-                        for (size_t c = 0lu; c < min_cb; c++) {
-                            size_t src_offset = cw + c;
-
-                            dst_data[src_offset] = src_data[src_offset] - static_cast<float>(mean);
-                        }
-                    }
-                });
-            } else {
-                parallel_for(CB, [&](size_t cb) {
-                    size_t src_off = ccb + cb * C2;
-#if defined(HAVE_AVX2) || defined(HAVE_AVX512F)
-                    vec_type vmean = _mm_uni_setzero_ps();
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = src_off + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * C0;
-                            for (size_t w = 0lu; w < W; w++) {
-                                vec_type vsrc = _mm_uni_loadu_ps(src_data + ch + w * blk_size);
-                                vmean = _mm_uni_add_ps(vmean, vsrc);
-                            }
-                        }
-                    }
-
-                    vec_type vsize = _mm_uni_set1_ps(static_cast<float>(D * H * W));
-                    vmean = _mm_uni_div_ps(vmean, vsize);
-
-                    for (size_t d = 0lu; d < D; d++) {
-                        size_t cd = src_off + d * C1;
-                        for (size_t h = 0lu; h < H; h++) {
-                            size_t ch = cd + h * C0;
-                            for (size_t w = 0lu; w < W; w++) {
-                                size_t offset = ch + w * blk_size;
-                                vec_type vsrc = _mm_uni_loadu_ps(src_data + offset);
-                                _mm_uni_storeu_ps(dst_data + offset, _mm_uni_sub_ps(vsrc, vmean));
-                            }
-                        }
-                    }
-#else
-                    size_t min_cb = std::min(blk_size, C - cb * blk_size);
-                    for (size_t c = 0lu; c < min_cb; c++) {
-                        size_t cc = src_off + c;
-                        double mean = 0.0;
-                        for (size_t d = 0lu; d < D; d++) {
-                            size_t cd = cc + d * C1;
-                            for (size_t h = 0lu; h < H; h++) {
-                                size_t ch = cd + h * C0;
-                                for (size_t w = 0lu; w < W; w++) {
-                                    mean += src_data[ch + w * blk_size];
-                                }
-                            }
-                        }
-
-                        size_t C4 = D * H * W;
-                        mean /= static_cast<double>(C4);
-
-                        for (size_t d = 0lu; d < D; d++) {
-                            size_t cd = cc + d * C1;
-                            for (size_t h = 0lu; h < H; h++) {
-                                size_t ch = cd + h * C0;
-                                for (size_t w = 0lu; w < W; w++) {
-                                    size_t index = ch + w * blk_size;
-                                    dst_data[index] = src_data[index] - static_cast<float>(mean);
-                                }
-                            }
-                        }
-                    }
+        parallel_for2d(N, CB, [&](size_t b, size_t cb) {
+            for (size_t l = 0; l < blk_size; l++) {
+                Moments moments;
+                for (size_t t = 0; t < tasks; t++)
+                    moments.merge(partials[((b * CB + cb) * tasks + t) * blk_size + l]);
+                stats[(b * CB + cb) * blk_size + l] = finalize(moments);
+            }
+        });
+    }
+
+    parallel_for3d(N, CB, tasks, [&](size_t b, size_t cb, size_t t) {
+        const Stats* s = &stats[(b * CB + cb) * blk_size];
+        float mean[blk_size], scale[blk_size];
+        for (size_t l = 0; l < blk_size; l++) {
+            mean[l] = s[l].mean;
+            scale[l] = s[l].scale;
+        }
+
+        size_t start = t * task_vectors;
+        size_t end = start + (std::min)(task_vectors, C4 - start);
+        size_t offset = (b * CB + cb) * C2;
+        size_t l0 = 0;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+        for (; l0 + vec_size <= blk_size; l0 += vec_size) {
+            vec_type vmean = _mm_uni_loadu_ps(mean + l0);
+            vec_type vscale = _mm_uni_loadu_ps(scale + l0);
+            for (size_t i = start; i < end; i++) {
+                size_t index = offset + i * blk_size + l0;
+                vec_type vsrc = _mm_uni_sub_ps(_mm_uni_loadu_ps(src_data + index), vmean);
+                _mm_uni_storeu_ps(dst_data + index, _mm_uni_mul_ps(vsrc, vscale));
+            }
+        }
 #endif
-                });
+        for (; l0 < blk_size; l0++) {
+            for (size_t i = start; i < end; i++) {
+                size_t index = offset + i * blk_size + l0;
+                dst_data[index] = (src_data[index] - mean[l0]) * scale[l0];
             }
         }
-    }
+    });
 }
 
 REG_FACTORY_FOR(ImplFactory<MVNImpl>, MVN);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
@@ -12,10 +12,14 @@
 #include <algorithm>
 #include <utility>
 #include "ie_parallel.hpp"
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+#include <immintrin.h>
+#endif
 
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class NonMaxSuppressionImpl: public ExtLayerBase {
 public:
@@ -93,47 +97,12 @@ public:
         }
     }
 
-    static float intersectionOverUnion(float* boxesI, float* boxesJ, bool center_point_box) {
-        float yminI, xminI, ymaxI, xmaxI, yminJ, xminJ, ymaxJ, xmaxJ;
-        if (center_point_box) {
-            //  box format: x_center, y_center, width, height
-            yminI = boxesI[1] - boxesI[3] / 2.f;
-            xminI = boxesI[0] - boxesI[2] / 2.f;
-            ymaxI = boxesI[1] + boxesI[3] / 2.f;
-            xmaxI = boxesI[0] + boxesI[2] / 2.f;
-            yminJ = boxesJ[1] - boxesJ[3] / 2.f;
-            xminJ = boxesJ[0] - boxesJ[2] / 2.f;
-            ymaxJ = boxesJ[1] + boxesJ[3] / 2.f;
-            xmaxJ = boxesJ[0] + boxesJ[2] / 2.f;
-        } else {
-            //  box format: y1, x1, y2, x2
-            yminI = (std::min)(boxesI[0], boxesI[2]);
-            xminI = (std::min)(boxesI[1], boxesI[3]);
-            ymaxI = (std::max)(boxesI[0], boxesI[2]);
-            xmaxI = (std::max)(boxesI[1], boxesI[3]);
-            yminJ = (std::min)(boxesJ[0], boxesJ[2]);
-            xminJ = (std::min)(boxesJ[1], boxesJ[3]);
-            ymaxJ = (std::max)(boxesJ[0], boxesJ[2]);
-            xmaxJ = (std::max)(boxesJ[1], boxesJ[3]);
-        }
-
-        float areaI = (ymaxI - yminI) * (xmaxI - xminI);
-        float areaJ = (ymaxJ - yminJ) * (xmaxJ - xminJ);
-        if (areaI <= 0.f || areaJ <= 0.f)
-            return 0.f;
-
-        float intersection_area =
-            (std::max)((std::min)(ymaxI, ymaxJ) - (std::max)(yminI, yminJ), 0.f) *
-            (std::max)((std::min)(xmaxI, xmaxJ) - (std::max)(xminI, xminJ), 0.f);
-        return intersection_area / (areaI + areaJ - intersection_area);
-    }
-
-    typedef struct {
+    struct filteredBoxes {
         float score;
         int batch_index;
         int class_index;
         int box_index;
-    } filteredBoxes;
+    };
 
     StatusCode execute(std::vector<Blob::Ptr>& inputs, std::vector<Blob::Ptr>& outputs, ResponseDesc *resp) noexcept override {
         float *boxes = inputs[NMS_BOXES]->cbuffer().as<float *>() +
@@ -148,6 +117,7 @@ public:
             max_output_boxes_per_class = (std::min)(max_output_boxes_per_class,
                 (inputs[NMS_MAXOUTPUTBOXESPERCLASS]->cbuffer().as<int *>() +
                 inputs[NMS_MAXOUTPUTBOXESPERCLASS]->getTensorDesc().getBlockingDesc().getOffsetPadding())[0]);
+        max_output_boxes_per_class = (std::max)(max_output_boxes_per_class, 0);
 
         float iou_threshold = 1.f;  //  Value range [0, 1]
         if (inputs.size() > 3)
@@ -169,53 +139,112 @@ public:
         // scores shape: {num_batches, num_classes, num_boxes}
         int num_batches = static_cast<int>(scores_dims[0]);
         int num_classes = static_cast<int>(scores_dims[1]);
-        std::vector<filteredBoxes> fb;
 
-        for (int batch = 0; batch < num_batches; batch++) {
-            float *boxesPtr = boxes + batch * boxesStrides[0];
-            for (int class_idx = 0; class_idx < num_classes; class_idx++) {
-                float *scoresPtr = scores + batch * scoresStrides[0] + class_idx * scoresStrides[1];
-                std::vector<std::pair<float, int> > scores_vector;
+        // Corners and areas are the same for every class of a batch, so they are normalized once
+        // into planes of ymin, xmin, ymax, xmax, area
+        _boxes_soa.resize(static_cast<size_t>(num_batches) * NMS_PLANES * num_boxes);
+        parallel_for(num_batches, [&](int batch) {
+            const float *boxesPtr = boxes + batch * boxesStrides[0];
+            float *soa = &_boxes_soa[static_cast<size_t>(batch) * NMS_PLANES * num_boxes];
+            for (int box_idx = 0; box_idx < num_boxes; box_idx++) {
+                const float *box = boxesPtr + box_idx * 4;
+                float ymin, xmin, ymax, xmax;
+                if (center_point_box) {
+                    //  box format: x_center, y_center, width, height
+                    ymin = box[1] - box[3] / 2.f;
+                    xmin = box[0] - box[2] / 2.f;
+                    ymax = box[1] + box[3] / 2.f;
+                    xmax = box[0] + box[2] / 2.f;
+                } else {
+                    //  box format: y1, x1, y2, x2
+                    ymin = (std::min)(box[0], box[2]);
+                    xmin = (std::min)(box[1], box[3]);
+                    ymax = (std::max)(box[0], box[2]);
+                    xmax = (std::max)(box[1], box[3]);
+                }
+                soa[0 * num_boxes + box_idx] = ymin;
+                soa[1 * num_boxes + box_idx] = xmin;
+                soa[2 * num_boxes + box_idx] = ymax;
+                soa[3 * num_boxes + box_idx] = xmax;
+                soa[4 * num_boxes + box_idx] = (ymax - ymin) * (xmax - xmin);
+            }
+        });
+
+        // Each thread takes a contiguous range of (batch, class) pairs, so concatenating
+        // the per-thread results in thread order keeps the serial batch-major order
+        const int work_amount = num_batches * num_classes;
+        _thread_scratch.resize(parallel_get_max_threads());
+        for (auto &scratch : _thread_scratch)
+            scratch.selected.clear();
+
+        parallel_nt(0, [&](const int ithr, const int nthr) {
+            int start = 0, end = 0;
+            splitter(work_amount, nthr, ithr, start, end);
+            if (start >= end)
+                return;
+
+            ThreadScratch &scratch = _thread_scratch[ithr];
+            scratch.kept.resize(NMS_PLANES * static_cast<size_t>(max_output_boxes_per_class));
+            for (int iwork = start; iwork < end; iwork++) {
+                const int batch = iwork / num_classes;
+                const int class_idx = iwork % num_classes;
+                const float *soa = &_boxes_soa[static_cast<size_t>(batch) * NMS_PLANES * num_boxes];
+                const float *scoresPtr = scores + batch * scoresStrides[0] + class_idx * scoresStrides[1];
+
+                scratch.candidates.clear();
                 for (int box_idx = 0; box_idx < num_boxes; box_idx++) {
                     if (scoresPtr[box_idx] > score_threshold)
-                        scores_vector.push_back(std::make_pair(scoresPtr[box_idx], box_idx));
+                        scratch.candidates.push_back(std::make_pair(scoresPtr[box_idx], box_idx));
                 }
-
-                if (scores_vector.size()) {
-                    parallel_sort(scores_vector.begin(), scores_vector.end(),
-                        [](const std::pair<float, int>& l, const std::pair<float, int>& r) { return l.first > r.first; });
-
-                    int io_selection_size = 1;
-                    fb.push_back({ scores_vector[0].first, batch, class_idx, scores_vector[0].second });
-                    for (int box_idx = 1; (box_idx < static_cast<int>(scores_vector.size()) && io_selection_size < max_output_boxes_per_class); box_idx++) {
-                        bool box_is_selected = true;
-                        for (int idx = io_selection_size - 1; idx >= 0; idx--) {
-                            float iou = intersectionOverUnion(&boxesPtr[scores_vector[box_idx].second * 4],
-                                             &boxesPtr[scores_vector[idx].second * 4], center_point_box);
-                            if (iou > iou_threshold) {
-                                box_is_selected = false;
-                                break;
-                            }
-                        }
-
-                        if (box_is_selected) {
-                            scores_vector[io_selection_size] = scores_vector[box_idx];
-                            io_selection_size++;
-                            fb.push_back({ scores_vector[box_idx].first, batch, class_idx, scores_vector[box_idx].second });
+                std::sort(scratch.candidates.begin(), scratch.candidates.end(),
+                    [](const std::pair<float, int>& l, const std::pair<float, int>& r) { return l.first > r.first; });
+
+                // Only boxes with a positive area take part in the overlap test: the others
+                // have zero IoU with everything and can neither suppress nor be suppressed
+                // unless the threshold is negative
+                int io_selection_size = 0;
+                int num_kept = 0;
+                for (size_t cand = 0; cand < scratch.candidates.size() && io_selection_size < max_output_boxes_per_class; cand++) {
+                    const int box_idx = scratch.candidates[cand].second;
+                    const float box[NMS_PLANES] = { soa[0 * num_boxes + box_idx], soa[1 * num_boxes + box_idx],
+                                                    soa[2 * num_boxes + box_idx], soa[3 * num_boxes + box_idx],
+                                                    soa[4 * num_boxes + box_idx] };
+                    bool box_is_selected;
+                    if (io_selection_size == 0)
+                        box_is_selected = true;
+                    else if (iou_threshold < 0.f)
+                        box_is_selected = false;
+                    else if (box[4] <= 0.f)
+                        box_is_selected = true;
+                    else
+                        box_is_selected = !isSuppressed(scratch.kept.data(), max_output_boxes_per_class, num_kept, box, iou_threshold);
+
+                    if (box_is_selected) {
+                        if (box[4] > 0.f) {
+                            for (int plane = 0; plane < NMS_PLANES; plane++)
+                                scratch.kept[plane * max_output_boxes_per_class + num_kept] = box[plane];
+                            num_kept++;
                         }
+                        io_selection_size++;
+                        scratch.selected.push_back({ scratch.candidates[cand].first, batch, class_idx, box_idx });
                     }
                 }
             }
-        }
+        });
+
+        _filtered_boxes.clear();
+        for (const auto &scratch : _thread_scratch)
+            _filtered_boxes.insert(_filtered_boxes.end(), scratch.selected.begin(), scratch.selected.end());
 
-        parallel_sort(fb.begin(), fb.end(), [](const filteredBoxes& l, const filteredBoxes& r) { return l.score > r.score; });
+        std::stable_sort(_filtered_boxes.begin(), _filtered_boxes.end(),
+                         [](const filteredBoxes& l, const filteredBoxes& r) { return l.score > r.score; });
         int selected_indicesStride = outputs[0]->getTensorDesc().getBlockingDesc().getStrides()[0];
         int* selected_indicesPtr = selected_indices;
         size_t idx;
-        for (idx = 0; idx < (std::min)(selected_indices_dims[0], fb.size()); idx++) {
-            selected_indicesPtr[0] = fb[idx].batch_index;
-            selected_indicesPtr[1] = fb[idx].class_index;
-            selected_indicesPtr[2] = fb[idx].box_index;
+        for (idx = 0; idx < (std::min)(selected_indices_dims[0], _filtered_boxes.size()); idx++) {
+            selected_indicesPtr[0] = _filtered_boxes[idx].batch_index;
+            selected_indicesPtr[1] = _filtered_boxes[idx].class_index;
+            selected_indicesPtr[2] = _filtered_boxes[idx].box_index;
             selected_indicesPtr += selected_indicesStride;
         }
         for (; idx < selected_indices_dims[0]; idx++) {
@@ -229,16 +258,110 @@ public:
     }
 
 private:
+    static const int NMS_PLANES = 5;
+
+    //  Returns true if the box overlaps any of the num_kept boxes stored as planes of
+    //  ymin, xmin, ymax, xmax, area with the given stride by more than iou_threshold.
+    //  Both the box and the kept boxes must have a positive area.
+    static inline bool isSuppressed(const float *kept, int kept_stride, int num_kept,
+                                    const float *box, float iou_threshold) {
+        const float *kept_ymin = kept;
+        const float *kept_xmin = kept + kept_stride;
+        const float *kept_ymax = kept + 2 * kept_stride;
+        const float *kept_xmax = kept + 3 * kept_stride;
+        const float *kept_area = kept + 4 * kept_stride;
+
+        int k = 0;
+#if defined(HAVE_AVX512F)
+        const __m512 vymin = _mm512_set1_ps(box[0]);
+        const __m512 vxmin = _mm512_set1_ps(box[1]);
+        const __m512 vymax = _mm512_set1_ps(box[2]);
+        const __m512 vxmax = _mm512_set1_ps(box[3]);
+        const __m512 varea = _mm512_set1_ps(box[4]);
+        const __m512 vthreshold = _mm512_set1_ps(iou_threshold);
+        const __m512 vzero = _mm512_setzero_ps();
+        for (; k + 16 <= num_kept; k += 16) {
+            __m512 vheight = _mm512_max_ps(_mm512_sub_ps(_mm512_min_ps(vymax, _mm512_loadu_ps(kept_ymax + k)),
+                                                         _mm512_max_ps(vymin, _mm512_loadu_ps(kept_ymin + k))), vzero);
+            __m512 vwidth = _mm512_max_ps(_mm512_sub_ps(_mm512_min_ps(vxmax, _mm512_loadu_ps(kept_xmax + k)),
+                                                        _mm512_max_ps(vxmin, _mm512_loadu_ps(kept_xmin + k))), vzero);
+            __m512 vintersection = _mm512_mul_ps(vheight, vwidth);
+            __m512 viou = _mm512_div_ps(vintersection,
+                                        _mm512_sub_ps(_mm512_add_ps(varea, _mm512_loadu_ps(kept_area + k)), vintersection));
+            if (_mm512_cmp_ps_mask(viou, vthreshold, _CMP_GT_OS))
+                return true;
+        }
+#elif defined(HAVE_AVX2)
+        const __m256 vymin = _mm256_set1_ps(box[0]);
+        const __m256 vxmin = _mm256_set1_ps(box[1]);
+        const __m256 vymax = _mm256_set1_ps(box[2]);
+        const __m256 vxmax = _mm256_set1_ps(box[3]);
+        const __m256 varea = _mm256_set1_ps(box[4]);
+        const __m256 vthreshold = _mm256_set1_ps(iou_threshold);
+        const __m256 vzero = _mm256_setzero_ps();
+        for (; k + 8 <= num_kept; k += 8) {
+            __m256 vheight = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(vymax, _mm256_loadu_ps(kept_ymax + k)),
+                                                         _mm256_max_ps(vymin, _mm256_loadu_ps(kept_ymin + k))), vzero);
+            __m256 vwidth = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(vxmax, _mm256_loadu_ps(kept_xmax + k)),
+                                                        _mm256_max_ps(vxmin, _mm256_loadu_ps(kept_xmin + k))), vzero);
+            __m256 vintersection = _mm256_mul_ps(vheight, vwidth);
+            __m256 viou = _mm256_div_ps(vintersection,
+                                        _mm256_sub_ps(_mm256_add_ps(varea, _mm256_loadu_ps(kept_area + k)), vintersection));
+            if (_mm256_movemask_ps(_mm256_cmp_ps(viou, vthreshold, _CMP_GT_OS)))
+                return true;
+        }
+#elif defined(HAVE_SSE)
+        const __m128 vymin = _mm_set1_ps(box[0]);
+        const __m128 vxmin = _mm_set1_ps(box[1]);
+        const __m128 vymax = _mm_set1_ps(box[2]);
+        const __m128 vxmax = _mm_set1_ps(box[3]);
+        const __m128 varea = _mm_set1_ps(box[4]);
+        const __m128 vthreshold = _mm_set1_ps(iou_threshold);
+        const __m128 vzero = _mm_setzero_ps();
+        for (; k + 4 <= num_kept; k += 4) {
+            __m128 vheight = _mm_max_ps(_mm_sub_ps(_mm_min_ps(vymax, _mm_loadu_ps(kept_ymax + k)),
+                                                   _mm_max_ps(vymin, _mm_loadu_ps(kept_ymin + k))), vzero);
+            __m128 vwidth = _mm_max_ps(_mm_sub_ps(_mm_min_ps(vxmax, _mm_loadu_ps(kept_xmax + k)),
+                                                  _mm_max_ps(vxmin, _mm_loadu_ps(kept_xmin + k))), vzero);
+            __m128 vintersection = _mm_mul_ps(vheight, vwidth);
+            __m128 viou = _mm_div_ps(vintersection,
+                                     _mm_sub_ps(_mm_add_ps(varea, _mm_loadu_ps(kept_area + k)), vintersection));
+            if (_mm_movemask_ps(_mm_cmpgt_ps(viou, vthreshold)))
+                return true;
+        }
+#endif
+        for (; k < num_kept; k++) {
+            float intersection_area =
+                (std::max)((std::min)(box[2], kept_ymax[k]) - (std::max)(box[0], kept_ymin[k]), 0.f) *
+                (std::max)((std::min)(box[3], kept_xmax[k]) - (std::max)(box[1], kept_xmin[k]), 0.f);
+            if (intersection_area / (box[4] + kept_area[k] - intersection_area) > iou_threshold)
+                return true;
+        }
+        return false;
+    }
+
+    struct ThreadScratch {
+        std::vector<std::pair<float, int>> candidates;
+        std::vector<float> kept;
+        std::vector<filteredBoxes> selected;
+    };
+
     const size_t NMS_BOXES = 0;
     const size_t NMS_SCORES = 1;
     const size_t NMS_MAXOUTPUTBOXESPERCLASS = 2;
     const size_t NMS_IOUTHRESHOLD = 3;
     const size_t NMS_SCORETHRESHOLD = 4;
     bool center_point_box = false;
+
+    //  Scratch reused across execute() calls
+    std::vector<float> _boxes_soa;
+    std::vector<ThreadScratch> _thread_scratch;
+    std::vector<filteredBoxes> _filtered_boxes;
 };
 
 REG_FACTORY_FOR(ImplFactory<NonMaxSuppressionImpl>, NonMaxSuppression);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
@@ -17,6 +17,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class NormalizeImpl: public ExtLayerBase {
 public:
@@ -224,6 +225,7 @@ private:
 
 REG_FACTORY_FOR(ImplFactory<NormalizeImpl>, Normalize);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
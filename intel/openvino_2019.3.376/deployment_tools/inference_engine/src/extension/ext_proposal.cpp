@@ -6,6 +6,8 @@
 #include "ext_base.hpp"
 
 #include <cmath>
+#include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <utility>
@@ -18,6 +20,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 static
 void generate_anchors(int base_size, float* ratios,
@@ -82,28 +85,37 @@ void enumerate_proposals_cpu(const float* bottom4d, const float* d_anchor4d, con
     const float* p_anchors_wp = anchors + 2 * num_anchors;
     const float* p_anchors_hp = anchors + 3 * num_anchors;
 
-    parallel_for2d(bottom_H, bottom_W, [&](size_t h, size_t w) {
-            const float x = static_cast<float>((swap_xy ? h : w) * feat_stride);
-            const float y = static_cast<float>((swap_xy ? w : h) * feat_stride);
+    // walk each anchor plane along W so the deltas and scores are read contiguously
+    parallel_for2d(bottom_H, num_anchors, [&](size_t h, size_t anchor) {
+            const float* p_dx      = d_anchor4d + (anchor * 4 + 0) * bottom_area + h * bottom_W;
+            const float* p_dy      = d_anchor4d + (anchor * 4 + 1) * bottom_area + h * bottom_W;
+            const float* p_d_log_w = d_anchor4d + (anchor * 4 + 2) * bottom_area + h * bottom_W;
+            const float* p_d_log_h = d_anchor4d + (anchor * 4 + 3) * bottom_area + h * bottom_W;
+            const float* p_score   = bottom4d + anchor * bottom_area + h * bottom_W;
 
-            const float* p_box   = d_anchor4d + h * bottom_W + w;
-            const float* p_score = bottom4d   + h * bottom_W + w;
+            const float anchor_wm = p_anchors_wm[anchor];
+            const float anchor_hm = p_anchors_hm[anchor];
+            const float anchor_wp = p_anchors_wp[anchor];
+            const float anchor_hp = p_anchors_hp[anchor];
 
-            float* p_proposal = proposals + (h * bottom_W + w) * num_anchors * 5;
+            float* p_proposal = proposals + (h * bottom_W * num_anchors + anchor) * 5;
 
-            for (int anchor = 0; anchor < num_anchors; ++anchor) {
-                const float dx = p_box[(anchor * 4 + 0) * bottom_area] / box_coordinate_scale;
-                const float dy = p_box[(anchor * 4 + 1) * bottom_area] / box_coordinate_scale;
+            for (int w = 0; w < bottom_W; ++w, p_proposal += num_anchors * 5) {
+                const float x = static_cast<float>((swap_xy ? h : w) * feat_stride);
+                const float y = static_cast<float>((swap_xy ? w : h) * feat_stride);
 
-                const float d_log_w = p_box[(anchor * 4 + 2) * bottom_area] / box_size_scale;
-                const float d_log_h = p_box[(anchor * 4 + 3) * bottom_area] / box_size_scale;
+                const float dx = p_dx[w] / box_coordinate_scale;
+                const float dy = p_dy[w] / box_coordinate_scale;
 
-                const float score = p_score[anchor * bottom_area];
+                const float d_log_w = p_d_log_w[w] / box_size_scale;
+                const float d_log_h = p_d_log_h[w] / box_size_scale;
 
-                float x0 = x + p_anchors_wm[anchor];
-                float y0 = y + p_anchors_hm[anchor];
-                float x1 = x + p_anchors_wp[anchor];
-                float y1 = y + p_anchors_hp[anchor];
+                const float score = p_score[w];
+
+                float x0 = x + anchor_wm;
+                float y0 = y + anchor_hm;
+                float x1 = x + anchor_wp;
+                float y1 = y + anchor_hp;
 
                 if (initial_clip) {
                     // adjust new corner locations to be within the image region
@@ -146,11 +158,11 @@ void enumerate_proposals_cpu(const float* bottom4d, const float* d_anchor4d, con
                 const float box_w = x1 - x0 + coordinates_offset;
                 const float box_h = y1 - y0 + coordinates_offset;
 
-                p_proposal[5*anchor + 0] = x0;
-                p_proposal[5*anchor + 1] = y0;
-                p_proposal[5*anchor + 2] = x1;
-                p_proposal[5*anchor + 3] = y1;
-                p_proposal[5*anchor + 4] = (min_box_W <= box_w) * (min_box_H <= box_h) * score;
+                p_proposal[0] = x0;
+                p_proposal[1] = y0;
+                p_proposal[2] = x1;
+                p_proposal[3] = y1;
+                p_proposal[4] = (min_box_W <= box_w) * (min_box_H <= box_h) * score;
             }
     });
 }
@@ -174,12 +186,120 @@ static void unpack_boxes(const float* p_proposals, float* unpacked_boxes, int pr
     }
 }
 
+// NMS works on tiles of 64 boxes, one bit per box
+static const int nms_tile = 64;
+
+// Returns a mask of the boxes in [col_begin, col_end) following 'box' whose IoU with it exceeds nms_thresh,
+// bit k stands for box col_begin + k
+static inline
+uint64_t nms_suppress_mask(const float* x0, const float* y0, const float* x1, const float* y1,
+                           const int box, const int col_begin, const int col_end,
+                           const float nms_thresh, const float coordinates_offset) {
+    const float x0i = x0[box];
+    const float y0i = y0[box];
+    const float x1i = x1[box];
+    const float y1i = y1[box];
+
+    const float A_area = (x1i - x0i + coordinates_offset) * (y1i - y0i + coordinates_offset);
+
+    uint64_t mask = 0;
+    int tail = std::max(col_begin, box + 1);
+
+#if defined(HAVE_AVX2)
+    __m256 vc_fone = _mm256_set1_ps(coordinates_offset);
+    __m256 vc_zero = _mm256_set1_ps(0.0f);
+    __m256 vc_nms_thresh = _mm256_set1_ps(nms_thresh);
+
+    __m256 vx0i = _mm256_set1_ps(x0i);
+    __m256 vy0i = _mm256_set1_ps(y0i);
+    __m256 vx1i = _mm256_set1_ps(x1i);
+    __m256 vy1i = _mm256_set1_ps(y1i);
+
+    __m256 vA_width  = _mm256_sub_ps(vx1i, vx0i);
+    __m256 vA_height = _mm256_sub_ps(vy1i, vy0i);
+    __m256 vA_area   = _mm256_mul_ps(_mm256_add_ps(vA_width, vc_fone), _mm256_add_ps(vA_height, vc_fone));
+
+    for (; tail <= col_end - 8; tail += 8) {
+        __m256 vx0j = _mm256_loadu_ps(x0 + tail);
+        __m256 vy0j = _mm256_loadu_ps(y0 + tail);
+        __m256 vx1j = _mm256_loadu_ps(x1 + tail);
+        __m256 vy1j = _mm256_loadu_ps(y1 + tail);
+
+        __m256 vx0 = _mm256_max_ps(vx0i, vx0j);
+        __m256 vy0 = _mm256_max_ps(vy0i, vy0j);
+        __m256 vx1 = _mm256_min_ps(vx1i, vx1j);
+        __m256 vy1 = _mm256_min_ps(vy1i, vy1j);
+
+        __m256 vwidth  = _mm256_add_ps(_mm256_sub_ps(vx1, vx0), vc_fone);
+        __m256 vheight = _mm256_add_ps(_mm256_sub_ps(vy1, vy0), vc_fone);
+        __m256 varea = _mm256_mul_ps(_mm256_max_ps(vc_zero, vwidth), _mm256_max_ps(vc_zero, vheight));
+
+        __m256 vB_width  = _mm256_sub_ps(vx1j, vx0j);
+        __m256 vB_height = _mm256_sub_ps(vy1j, vy0j);
+        __m256 vB_area   = _mm256_mul_ps(_mm256_add_ps(vB_width, vc_fone), _mm256_add_ps(vB_height, vc_fone));
+
+        __m256 vdivisor = _mm256_sub_ps(_mm256_add_ps(vA_area, vB_area), varea);
+        __m256 vintersection_area = _mm256_div_ps(varea, vdivisor);
+
+        __m256 vcmp_0 = _mm256_cmp_ps(vx0i, vx1j, _CMP_LE_OS);
+        __m256 vcmp_1 = _mm256_cmp_ps(vy0i, vy1j, _CMP_LE_OS);
+        __m256 vcmp_2 = _mm256_cmp_ps(vx0j, vx1i, _CMP_LE_OS);
+        __m256 vcmp_3 = _mm256_cmp_ps(vy0j, vy1i, _CMP_LE_OS);
+        __m256 vcmp_4 = _mm256_cmp_ps(vc_nms_thresh, vintersection_area, _CMP_LT_OS);
+
+        vcmp_0 = _mm256_and_ps(vcmp_0, vcmp_1);
+        vcmp_2 = _mm256_and_ps(vcmp_2, vcmp_3);
+        vcmp_4 = _mm256_and_ps(vcmp_4, vcmp_0);
+        vcmp_4 = _mm256_and_ps(vcmp_4, vcmp_2);
+
+        mask |= static_cast<uint64_t>(_mm256_movemask_ps(vcmp_4)) << (tail - col_begin);
+    }
+#endif
+
+    for (; tail < col_end; ++tail) {
+        float res = 0.0f;
+
+        const float x0j = x0[tail];
+        const float y0j = y0[tail];
+        const float x1j = x1[tail];
+        const float y1j = y1[tail];
+
+        if (x0i <= x1j && y0i <= y1j && x0j <= x1i && y0j <= y1i) {
+            // overlapped region (= box)
+            const float x0 = std::max<float>(x0i, x0j);
+            const float y0 = std::max<float>(y0i, y0j);
+            const float x1 = std::min<float>(x1i, x1j);
+            const float y1 = std::min<float>(y1i, y1j);
+
+            // intersection area
+            const float width  = std::max<float>(0.0f,  x1 - x0 + coordinates_offset);
+            const float height = std::max<float>(0.0f,  y1 - y0 + coordinates_offset);
+            const float area   = width * height;
+
+            // area of B
+            const float B_area = (x1j - x0j + coordinates_offset) * (y1j - y0j + coordinates_offset);
+
+            // IoU
+            res = area / (A_area + B_area - area);
+        }
+
+        if (nms_thresh < res)
+            mask |= static_cast<uint64_t>(1) << (tail - col_begin);
+    }
+
+    return mask;
+}
+
+// Greedy NMS over boxes sorted by score, taken a tile of 64 boxes at a time. The tile is resolved
+// sequentially against itself, then its kept boxes suppress the following tiles in parallel,
+// one task per tile of the suppressed bitset (div_up(num_boxes, 64) words).
 static
-void nms_cpu(const int num_boxes, int is_dead[],
+void nms_cpu(const int num_boxes, uint64_t suppressed[],
              const float* boxes, int index_out[], int* const num_out,
              const int base_index, const float nms_thresh, const int max_num_out,
              float coordinates_offset) {
     const int num_proposals = num_boxes;
+    const int num_tiles = (num_boxes + nms_tile - 1) / nms_tile;
     int count = 0;
 
     const float* x0 = boxes + 0 * num_proposals;
@@ -187,112 +307,40 @@ void nms_cpu(const int num_boxes, int is_dead[],
     const float* x1 = boxes + 2 * num_proposals;
     const float* y1 = boxes + 3 * num_proposals;
 
-    memset(is_dead, 0, num_boxes * sizeof(int));
-
-#if defined(HAVE_AVX2)
-    __m256  vc_fone = _mm256_set1_ps(coordinates_offset);
-    __m256i vc_ione = _mm256_set1_epi32(1);
-    __m256  vc_zero = _mm256_set1_ps(0.0f);
-
-    __m256 vc_nms_thresh = _mm256_set1_ps(nms_thresh);
-#endif
+    memset(suppressed, 0, num_tiles * sizeof(uint64_t));
 
-    for (int box = 0; box < num_boxes; ++box) {
-        if (is_dead[box])
-            continue;
+    for (int row_tile = 0; row_tile < num_tiles; ++row_tile) {
+        const int row_begin = row_tile * nms_tile;
+        const int row_end = std::min(num_boxes, row_begin + nms_tile);
 
-        index_out[count++] = base_index + box;
-        if (count == max_num_out)
-            break;
+        int kept[nms_tile];
+        int num_kept = 0;
+        for (int box = row_begin; box < row_end; ++box) {
+            if ((suppressed[row_tile] >> (box - row_begin)) & 1)
+                continue;
 
-        int tail = box + 1;
+            index_out[count++] = base_index + box;
+            if (count == max_num_out) {
+                *num_out = count;
+                return;
+            }
 
-#if defined(HAVE_AVX2)
-        __m256 vx0i = _mm256_set1_ps(x0[box]);
-        __m256 vy0i = _mm256_set1_ps(y0[box]);
-        __m256 vx1i = _mm256_set1_ps(x1[box]);
-        __m256 vy1i = _mm256_set1_ps(y1[box]);
-
-        __m256 vA_width  = _mm256_sub_ps(vx1i, vx0i);
-        __m256 vA_height = _mm256_sub_ps(vy1i, vy0i);
-        __m256 vA_area   = _mm256_mul_ps(_mm256_add_ps(vA_width, vc_fone), _mm256_add_ps(vA_height, vc_fone));
-
-        for (; tail <= num_boxes - 8; tail += 8) {
-            __m256i *pdst = reinterpret_cast<__m256i*>(is_dead + tail);
-            __m256i  vdst = _mm256_loadu_si256(pdst);
-
-            __m256 vx0j = _mm256_loadu_ps(x0 + tail);
-            __m256 vy0j = _mm256_loadu_ps(y0 + tail);
-            __m256 vx1j = _mm256_loadu_ps(x1 + tail);
-            __m256 vy1j = _mm256_loadu_ps(y1 + tail);
-
-            __m256 vx0 = _mm256_max_ps(vx0i, vx0j);
-            __m256 vy0 = _mm256_max_ps(vy0i, vy0j);
-            __m256 vx1 = _mm256_min_ps(vx1i, vx1j);
-            __m256 vy1 = _mm256_min_ps(vy1i, vy1j);
-
-            __m256 vwidth  = _mm256_add_ps(_mm256_sub_ps(vx1, vx0), vc_fone);
-            __m256 vheight = _mm256_add_ps(_mm256_sub_ps(vy1, vy0), vc_fone);
-            __m256 varea = _mm256_mul_ps(_mm256_max_ps(vc_zero, vwidth), _mm256_max_ps(vc_zero, vheight));
-
-            __m256 vB_width  = _mm256_sub_ps(vx1j, vx0j);
-            __m256 vB_height = _mm256_sub_ps(vy1j, vy0j);
-            __m256 vB_area   = _mm256_mul_ps(_mm256_add_ps(vB_width, vc_fone), _mm256_add_ps(vB_height, vc_fone));
-
-            __m256 vdivisor = _mm256_sub_ps(_mm256_add_ps(vA_area, vB_area), varea);
-            __m256 vintersection_area = _mm256_div_ps(varea, vdivisor);
-
-            __m256 vcmp_0 = _mm256_cmp_ps(vx0i, vx1j, _CMP_LE_OS);
-            __m256 vcmp_1 = _mm256_cmp_ps(vy0i, vy1j, _CMP_LE_OS);
-            __m256 vcmp_2 = _mm256_cmp_ps(vx0j, vx1i, _CMP_LE_OS);
-            __m256 vcmp_3 = _mm256_cmp_ps(vy0j, vy1i, _CMP_LE_OS);
-            __m256 vcmp_4 = _mm256_cmp_ps(vc_nms_thresh, vintersection_area, _CMP_LT_OS);
-
-            vcmp_0 = _mm256_and_ps(vcmp_0, vcmp_1);
-            vcmp_2 = _mm256_and_ps(vcmp_2, vcmp_3);
-            vcmp_4 = _mm256_and_ps(vcmp_4, vcmp_0);
-            vcmp_4 = _mm256_and_ps(vcmp_4, vcmp_2);
-
-            _mm256_storeu_si256(pdst, _mm256_blendv_epi8(vdst, vc_ione, _mm256_castps_si256(vcmp_4)));
+            kept[num_kept++] = box;
+            suppressed[row_tile] |= nms_suppress_mask(x0, y0, x1, y1, box, row_begin, row_end,
+                                                      nms_thresh, coordinates_offset);
         }
-#endif
 
-        for (; tail < num_boxes; ++tail) {
-            float res = 0.0f;
-
-            const float x0i = x0[box];
-            const float y0i = y0[box];
-            const float x1i = x1[box];
-            const float y1i = y1[box];
-
-            const float x0j = x0[tail];
-            const float y0j = y0[tail];
-            const float x1j = x1[tail];
-            const float y1j = y1[tail];
-
-            if (x0i <= x1j && y0i <= y1j && x0j <= x1i && y0j <= y1i) {
-                // overlapped region (= box)
-                const float x0 = std::max<float>(x0i, x0j);
-                const float y0 = std::max<float>(y0i, y0j);
-                const float x1 = std::min<float>(x1i, x1j);
-                const float y1 = std::min<float>(y1i, y1j);
-
-                // intersection area
-                const float width  = std::max<float>(0.0f,  x1 - x0 + coordinates_offset);
-                const float height = std::max<float>(0.0f,  y1 - y0 + coordinates_offset);
-                const float area   = width * height;
-
-                // area of A, B
-                const float A_area = (x1i - x0i + coordinates_offset) * (y1i - y0i + coordinates_offset);
-                const float B_area = (x1j - x0j + coordinates_offset) * (y1j - y0j + coordinates_offset);
-
-                // IoU
-                res = area / (A_area + B_area - area);
+        parallel_for(num_tiles - row_tile - 1, [&](size_t t) {
+            const int col_tile = row_tile + 1 + static_cast<int>(t);
+            const int col_begin = col_tile * nms_tile;
+            const int col_end = std::min(num_boxes, col_begin + nms_tile);
+            uint64_t mask = suppressed[col_tile];
+            for (int k = 0; k < num_kept; ++k) {
+                mask |= nms_suppress_mask(x0, y0, x1, y1, kept[k], col_begin, col_end,
+                                          nms_thresh, coordinates_offset);
             }
-
-            if (nms_thresh < res)
-                is_dead[tail] = 1;
-        }
+            suppressed[col_tile] = mask;
+        });
     }
 
     *num_out = count;
@@ -472,7 +520,8 @@ public:
             std::vector<ProposalBox> proposals_(num_proposals);
             const int unpacked_boxes_buffer_size = store_prob ? 5 * pre_nms_topn : 4 * pre_nms_topn;
             std::vector<float> unpacked_boxes(unpacked_boxes_buffer_size);
-            std::vector<int> is_dead(pre_nms_topn);
+            const int nms_tiles = (pre_nms_topn + nms_tile - 1) / nms_tile;
+            std::vector<uint64_t> nms_suppressed(nms_tiles);
 
             // Execute
             int nn = inputs[0]->getTensorDesc().getDims()[0];
@@ -484,13 +533,16 @@ public:
                                         min_box_H, min_box_W, feat_stride_,
                                         box_coordinate_scale_, box_size_scale_,
                                         coordinates_offset, initial_clip, swap_xy, clip_before_nms);
-                std::partial_sort(proposals_.begin(), proposals_.begin() + pre_nms_topn, proposals_.end(),
-                                  [](const ProposalBox &struct1, const ProposalBox &struct2) {
-                                      return (struct1.score > struct2.score);
-                                  });
+                auto score_greater = [](const ProposalBox &struct1, const ProposalBox &struct2) {
+                    return (struct1.score > struct2.score);
+                };
+                // select the top-n first, then order only them
+                if (pre_nms_topn < num_proposals)
+                    std::nth_element(proposals_.begin(), proposals_.begin() + pre_nms_topn, proposals_.end(), score_greater);
+                std::sort(proposals_.begin(), proposals_.begin() + pre_nms_topn, score_greater);
 
                 unpack_boxes(reinterpret_cast<float *>(&proposals_[0]), &unpacked_boxes[0], pre_nms_topn, store_prob);
-                nms_cpu(pre_nms_topn, &is_dead[0], &unpacked_boxes[0], &roi_indices_[0], &num_rois, 0, nms_thresh_,
+                nms_cpu(pre_nms_topn, &nms_suppressed[0], &unpacked_boxes[0], &roi_indices_[0], &num_rois, 0, nms_thresh_,
                         post_nms_topn_, coordinates_offset);
 
                 float* p_probs = store_prob ? p_prob_item + n * post_nms_topn_ : nullptr;
@@ -539,6 +591,7 @@ private:
 
 REG_FACTORY_FOR(ImplFactory<ProposalImpl>, Proposal);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
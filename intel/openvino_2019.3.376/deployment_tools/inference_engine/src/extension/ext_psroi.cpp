@@ -18,8 +18,17 @@ class PSROIPoolingImpl: public ExtLayerBase {
 public:
     explicit PSROIPoolingImpl(const CNNLayer* layer) {
         try {
-            mode_ = layer->GetParamAsString("mode", "average");
-            if (mode_ != "bilinear_deformable")
+            std::string mode_str = layer->GetParamAsString("mode", "average");
+            if (mode_str == "average") {
+                mode_ = AVERAGE;
+            } else if (mode_str == "bilinear") {
+                mode_ = BILINEAR;
+            } else if (mode_str == "bilinear_deformable") {
+                mode_ = BILINEAR_DEFORMABLE;
+            } else {
+                THROW_IE_EXCEPTION << "Unsupported PSROIPooling mode: " << mode_str;
+            }
+            if (mode_ != BILINEAR_DEFORMABLE)
                 if (layer->insData.size() !=  2 || layer->outData.size() != 1)
                     THROW_IE_EXCEPTION << "Incorrect number of input/output edges!";
             // LayerSetUp
@@ -83,170 +92,149 @@ public:
             channels_each_class /= num_classes;
         }
 
-        size_t num_bins = spatial_bins_x_*spatial_bins_y_;
+        // sampling positions depend on the ROI only, compute them once for all output channels
+        const size_t bins_y = mode_ == BILINEAR ? spatial_bins_y_ : 1;
+        const size_t bins_x = mode_ == BILINEAR ? spatial_bins_x_ : 1;
+        if (mode_ != BILINEAR_DEFORMABLE) {
+            samples_y_.resize(real_rois * bins_y * nh);
+            samples_x_.resize(real_rois * bins_x * nw);
+            parallel_for(real_rois, [&](int n) {
+                float roi_start_w, roi_start_h, roi_width, roi_height;
+                getRoiBox(bottom_rois_beginning + n * 5, roi_start_w, roi_start_h, roi_width, roi_height);
+                if (mode_ == AVERAGE) {
+                    averageAxis(roi_start_h, roi_height, pooled_height_, nh, height, &samples_y_[n * nh]);
+                    averageAxis(roi_start_w, roi_width, pooled_width_, nw, width, &samples_x_[n * nw]);
+                } else {
+                    bilinearAxis(roi_start_h, roi_height, spatial_bins_y_, pooled_height_, nh, height,
+                                 &samples_y_[n * bins_y * nh]);
+                    bilinearAxis(roi_start_w, roi_width, spatial_bins_x_, pooled_width_, nw, width,
+                                 &samples_x_[n * bins_x * nw]);
+                }
+            });
+        }
 
-        parallel_for(real_rois, [&](int n) {
+        parallel_for2d(real_rois, nc, [&](int n, int c) {
             const float* bottom_rois = bottom_rois_beginning + n * 5;
             int roi_batch_ind = static_cast<int>(bottom_rois[0]);
-            float roi_start_w = 0.0f;
-            float roi_start_h = 0.0f;
-            float roi_end_w   = 0.0f;
-            float roi_end_h   = 0.0f;
-            float roi_width   = 0.0f;
-            float roi_height  = 0.0f;
-
-            if (mode_ == "bilinear") {
-                roi_start_w = bottom_rois[1] * spatial_scale_;
-                roi_start_h = bottom_rois[2] * spatial_scale_;
-                roi_end_w = bottom_rois[3] * spatial_scale_;
-                roi_end_h = bottom_rois[4] * spatial_scale_;
-                roi_width  = roi_end_w - roi_start_w;
-                roi_height = roi_end_h - roi_start_h;
-            } else if (mode_ == "average") {
-                roi_start_w = static_cast<float>(round(bottom_rois[1])) * spatial_scale_;
-                roi_start_h = static_cast<float>(round(bottom_rois[2])) * spatial_scale_;
-                roi_end_w   = static_cast<float>(round(bottom_rois[3]) + 1.0f) * spatial_scale_;
-                roi_end_h   = static_cast<float>(round(bottom_rois[4]) + 1.0f) * spatial_scale_;
-                // Force too small ROIs to be 1x1
-                roi_width  = std::max<float>(roi_end_w - roi_start_w, 0.1f);  // avoid 0
-                roi_height = std::max<float>(roi_end_h - roi_start_h, 0.1f);
-            } else if (mode_ == "bilinear_deformable") {
-                roi_start_w = static_cast<float>(round(bottom_rois[1])) * spatial_scale_ - 0.5f;
-                roi_start_h = static_cast<float>(round(bottom_rois[2])) * spatial_scale_ - 0.5f;
-                roi_end_w   = static_cast<float>(round(bottom_rois[3]) + 1.0f) * spatial_scale_ - 0.5f;
-                roi_end_h   = static_cast<float>(round(bottom_rois[4]) + 1.0f) * spatial_scale_ - 0.5f;
-                // Force too small ROIs to be 1x1
-                roi_width  = std::max<float>(roi_end_w - roi_start_w, 0.1f);  // avoid 0
-                roi_height = std::max<float>(roi_end_h - roi_start_h, 0.1f);
-            }
+            float *dst = dst_data + (n * nc + c) * nh * nw;
 
-            for (int c = 0; c < nc; c++) {
+            if (mode_ == AVERAGE) {
+                const AxisSample *sy = &samples_y_[n * nh];
+                const AxisSample *sx = &samples_x_[n * nw];
                 for (int h = 0; h < nh; h++) {
                     for (int w = 0; w < nw; w++) {
-                        size_t index = n*nc*nh*nw + c*nh*nw + h*nw + w;
-                        dst_data[index] = 0.0f;
+                        int hstart = sy[h].first;
+                        int hend = sy[h].second;
+                        int wstart = sx[w].first;
+                        int wend = sx[w].second;
+
+                        dst[h * nw + w] = 0.0f;
 
-                        if (mode_ == "average") {
-                            float bin_size_h = roi_height / static_cast<float>(pooled_height_);
-                            float bin_size_w = roi_width  / static_cast<float>(pooled_width_);
+                        float bin_area = static_cast<float>((hend - hstart) * (wend - wstart));
+                        if (bin_area) {
+                            int gc = (c * group_size_ + h) * group_size_ + w;
+                            const float *bottom_data =
+                                    bottom_data_beginning + ((roi_batch_ind * channels + gc) * height * width);
 
-                            int hstart = static_cast<int>(floor(static_cast<float>(h + 0) * bin_size_h + roi_start_h));
-                            int hend = static_cast<int>(ceil(static_cast<float>(h + 1) * bin_size_h + roi_start_h));
+                            float out_sum = 0.0f;
+                            for (int hh = hstart; hh < hend; ++hh)
+                                for (int ww = wstart; ww < wend; ++ww)
+                                    out_sum += bottom_data[hh * width + ww];
+
+                            dst[h * nw + w] = out_sum / bin_area;
+                        }
+                    }
+                }
+            } else if (mode_ == BILINEAR) {
+                const size_t num_bins = spatial_bins_x_*spatial_bins_y_;
+
+                for (int i = 0; i < nh * nw; i++)
+                    dst[i] = 0.0f;
+
+                for (size_t bin_y = 0; bin_y < spatial_bins_y_; bin_y++) {
+                    const AxisSample *sy = &samples_y_[(n * bins_y + bin_y) * nh];
+                    for (size_t bin_x = 0; bin_x < spatial_bins_x_; bin_x++) {
+                        const AxisSample *sx = &samples_x_[(n * bins_x + bin_x) * nw];
+
+                        size_t gc = c + (bin_y*spatial_bins_x_ + bin_x)*nc;
+                        size_t src_idx = (roi_batch_ind * channels + gc) * height * width;
+                        const float *bottom_data = bottom_data_beginning + src_idx;
+
+                        for (int h = 0; h < nh; h++) {
+                            if (!sy[h].valid)
+                                continue;
+                            const float *top_row = bottom_data + sy[h].first * width;
+                            const float *bottom_row = bottom_data + sy[h].second * width;
+                            for (int w = 0; w < nw; w++) {
+                                if (!sx[w].valid)
+                                    continue;
+                                const float top_left = top_row[sx[w].first];
+                                const float top_right = top_row[sx[w].second];
+                                const float bottom_left = bottom_row[sx[w].first];
+                                const float bottom_right = bottom_row[sx[w].second];
+
+                                const float top = top_left + (top_right - top_left) * sx[w].weight;
+                                const float bottom = bottom_left + (bottom_right - bottom_left) * sx[w].weight;
+
+                                dst[h * nw + w] += top + (bottom - top) * sy[h].weight;
+                            }
+                        }
+                    }
+                }
 
-                            hstart = std::min<int>(std::max<int>(hstart, 0), height);
-                            hend = std::min<int>(std::max<int>(hend, 0), height);
-                            int wstart = static_cast<int>(floor(static_cast<float>(w + 0) * bin_size_w + roi_start_w));
-                            int wend = static_cast<int>(ceil(static_cast<float>(w + 1) * bin_size_w + roi_start_w));
+                for (int i = 0; i < nh * nw; i++)
+                    dst[i] /= num_bins;
+            } else {
+                float roi_start_w, roi_start_h, roi_width, roi_height;
+                getRoiBox(bottom_rois, roi_start_w, roi_start_h, roi_width, roi_height);
 
-                            wstart = std::min<int>(std::max<int>(wstart, 0), width);
-                            wend = std::min<int>(std::max<int>(wend, 0), width);
+                // Compute w and h at bottom
+                float bin_size_h = roi_height / static_cast<float>(pooled_height_);
+                float bin_size_w = roi_width  / static_cast<float>(pooled_width_);
 
-                            float bin_area = static_cast<float>((hend - hstart) * (wend - wstart));
-                            if (bin_area) {
-                                int gc = (c * group_size_ + h) * group_size_ + w;
-                                const float *bottom_data =
-                                        bottom_data_beginning + ((roi_batch_ind * channels + gc) * height * width);
+                float sub_bin_size_h = bin_size_h / static_cast<float>(spatial_bins_x_);
+                float sub_bin_size_w = bin_size_w / static_cast<float>(spatial_bins_y_);
 
-                                float out_sum = 0.0f;
-                                for (int hh = hstart; hh < hend; ++hh)
-                                    for (int ww = wstart; ww < wend; ++ww)
-                                        out_sum += bottom_data[hh * width + ww];
+                int class_id = c / channels_each_class;
+                const float* offset_bottom_data = bottom_data_beginning + (roi_batch_ind * channels) * height * width;
 
-                                dst_data[index] = out_sum / bin_area;
-                            }
-                        } else if (mode_ == "bilinear") {
-                            for (size_t bin_y = 0; bin_y < spatial_bins_y_; bin_y++) {
-                                for (size_t bin_x = 0; bin_x < spatial_bins_x_; bin_x++) {
-                                    float box_xmin = roi_start_w + (bin_x + 0) * (roi_width / spatial_bins_x_);
-                                    float box_xmax = roi_start_w + (bin_x + 1) * (roi_width / spatial_bins_x_);
-                                    float box_ymin = roi_start_h + (bin_y + 0) * (roi_height / spatial_bins_y_);
-                                    float box_ymax = roi_start_h + (bin_y + 1) * (roi_height / spatial_bins_y_);
-
-                                    size_t gc = c + (bin_y*spatial_bins_x_ + bin_x)*nc;
-                                    size_t src_idx = (roi_batch_ind * channels + gc) * height * width;
-                                    const float *bottom_data = bottom_data_beginning + src_idx;
-
-                                    float height_scale = nh > 1 ? (box_ymax - box_ymin) * (height - 1) / (pooled_height_ - 1)
-                                                                : 0.0f;
-                                    float width_scale = nw > 1 ? (box_xmax - box_xmin) * (width - 1) / (pooled_width_ - 1)
-                                                               : 0.0f;
-
-                                    float in_y = nh > 1 ? (h * height_scale + box_ymin * (height - 1))
-                                                        : 0.5f * (box_ymin + box_ymax) * (height - 1);
-                                    float in_x = nw > 1 ? (w * width_scale + box_xmin * (width - 1))
-                                                        : 0.5f * (box_xmin + box_xmax) * (width - 1);
-
-                                    if (!(in_y < 0 || in_y > height - 1 || in_x < 0 || in_x > width - 1)) {
-                                        int top_y_index = static_cast<int>(floorf(in_y));
-                                        int bottom_y_index = static_cast<int>(ceilf(in_y));
-                                        int left_x_index = static_cast<int>(floorf(in_x));
-                                        int right_x_index = static_cast<int>(ceilf(in_x));
-
-                                        if (right_x_index > width - 1)
-                                            right_x_index = width - 1;
-
-                                        if (bottom_y_index > height - 1)
-                                            bottom_y_index = height - 1;
-
-                                        const float top_left = bottom_data[top_y_index * width + left_x_index];
-                                        const float top_right = bottom_data[top_y_index * width + right_x_index];
-                                        const float bottom_left = bottom_data[bottom_y_index * width + left_x_index];
-                                        const float bottom_right = bottom_data[bottom_y_index * width + right_x_index];
-
-                                        const float top = top_left + (top_right - top_left) * (in_x - left_x_index);
-                                        const float bottom = bottom_left + (bottom_right - bottom_left) * (in_x - left_x_index);
-
-                                        dst_data[index] += top + (bottom - top) * (in_y - top_y_index);
-                                    }
-                                }
-                            }
-                            dst_data[index] /= num_bins;
-                        } else if (mode_ == "bilinear_deformable") {
-                            // Compute w and h at bottom
-                            float bin_size_h = roi_height / static_cast<float>(pooled_height_);
-                            float bin_size_w = roi_width  / static_cast<float>(pooled_width_);
-
-                            float sub_bin_size_h = bin_size_h / static_cast<float>(spatial_bins_x_);
-                            float sub_bin_size_w = bin_size_w / static_cast<float>(spatial_bins_y_);
-
-                            int part_h = h * part_size_ / pooled_height_;
-                            int part_w = w * part_size_ / pooled_width_;
-                            int class_id = c / channels_each_class;
-                            float trans_x = no_trans_ ? 0 :
-                                    bottom_trans[(((n * num_classes + class_id) * 2) * part_size_ + part_h)
-                                                                                      * part_size_ + part_w] * trans_std_;
-                            float trans_y = no_trans_ ? 0 :
-                                            bottom_trans[(((n * num_classes + class_id) * 2 + 1) * part_size_ + part_h)
-                                                         * part_size_ + part_w] * trans_std_;
-
-                            float wstart = w * bin_size_w + roi_start_w + trans_x * roi_width;
-                            float hstart = h * bin_size_h + roi_start_h + trans_y * roi_height;
-
-                            float sum = 0;
-                            int count = 0;
-                            int gw = w * group_size_ / pooled_width_;
-                            int gh = h * group_size_ / pooled_height_;
-                            gw = std::min(std::max(gw, 0), static_cast<int>(group_size_ - 1));
-                            gh = std::min(std::max(gh, 0), static_cast<int>(group_size_ - 1));
-
-                            const float* offset_bottom_data = bottom_data_beginning + (roi_batch_ind * channels) * height * width;
-                            for (size_t ih = 0; ih < spatial_bins_y_; ih++) {
-                                for (size_t iw = 0; iw < spatial_bins_x_; iw++) {
-                                    float w1 = wstart + iw * sub_bin_size_w;
-                                    float h1 = hstart + ih * sub_bin_size_h;
-                                    // bilinear interpolation
-                                    if (w1 < -0.5 || w1 > width - 0.5 || h1 < -0.5 || h1 > height - 0.5)
-                                        continue;
-                                    w1 = static_cast<float>(std::min(std::max(static_cast<double>(w1), 0.0), width - 1.0));
-                                    h1 = static_cast<float>(std::min(std::max(static_cast<double>(h1), 0.0), height - 1.0));
-                                    int c1 = static_cast<int>((c * group_size_ + gh) * group_size_ + gw);
-                                    float val = bilinear_interp(offset_bottom_data + c1 * height * width, w1, h1, width);
-                                    sum += val;
-                                    count++;
-                                }
+                for (int h = 0; h < nh; h++) {
+                    for (int w = 0; w < nw; w++) {
+                        int part_h = h * part_size_ / pooled_height_;
+                        int part_w = w * part_size_ / pooled_width_;
+                        float trans_x = no_trans_ ? 0 :
+                                bottom_trans[(((n * num_classes + class_id) * 2) * part_size_ + part_h)
+                                                                                  * part_size_ + part_w] * trans_std_;
+                        float trans_y = no_trans_ ? 0 :
+                                        bottom_trans[(((n * num_classes + class_id) * 2 + 1) * part_size_ + part_h)
+                                                     * part_size_ + part_w] * trans_std_;
+
+                        float wstart = w * bin_size_w + roi_start_w + trans_x * roi_width;
+                        float hstart = h * bin_size_h + roi_start_h + trans_y * roi_height;
+
+                        float sum = 0;
+                        int count = 0;
+                        int gw = w * group_size_ / pooled_width_;
+                        int gh = h * group_size_ / pooled_height_;
+                        gw = std::min(std::max(gw, 0), static_cast<int>(group_size_ - 1));
+                        gh = std::min(std::max(gh, 0), static_cast<int>(group_size_ - 1));
+
+                        for (size_t ih = 0; ih < spatial_bins_y_; ih++) {
+                            for (size_t iw = 0; iw < spatial_bins_x_; iw++) {
+                                float w1 = wstart + iw * sub_bin_size_w;
+                                float h1 = hstart + ih * sub_bin_size_h;
+                                // bilinear interpolation
+                                if (w1 < -0.5 || w1 > width - 0.5 || h1 < -0.5 || h1 > height - 0.5)
+                                    continue;
+                                w1 = static_cast<float>(std::min(std::max(static_cast<double>(w1), 0.0), width - 1.0));
+                                h1 = static_cast<float>(std::min(std::max(static_cast<double>(h1), 0.0), height - 1.0));
+                                int c1 = static_cast<int>((c * group_size_ + gh) * group_size_ + gw);
+                                float val = bilinear_interp(offset_bottom_data + c1 * height * width, w1, h1, width);
+                                sum += val;
+                                count++;
                             }
-                            dst_data[index] = count == 0 ? 0 : sum / count;
                         }
+                        dst[h * nw + w] = count == 0 ? 0 : sum / count;
                     }
                 }
             }
@@ -279,6 +267,91 @@ public:
     }
 
 private:
+    enum Mode {
+        AVERAGE,
+        BILINEAR,
+        BILINEAR_DEFORMABLE
+    };
+
+    // Sampling position along one axis of a ROI.
+    //   average:  [first, second) is the bin extent
+    //   bilinear: first/second are the neighbouring rows (columns), weight is the distance from first,
+    //             valid is false when the sample lies outside the feature map
+    struct AxisSample {
+        int first;
+        int second;
+        float weight;
+        bool valid;
+    };
+
+    void getRoiBox(const float* bottom_rois, float& roi_start_w, float& roi_start_h,
+                   float& roi_width, float& roi_height) const {
+        float roi_end_w = 0.0f;
+        float roi_end_h = 0.0f;
+
+        if (mode_ == BILINEAR) {
+            roi_start_w = bottom_rois[1] * spatial_scale_;
+            roi_start_h = bottom_rois[2] * spatial_scale_;
+            roi_end_w = bottom_rois[3] * spatial_scale_;
+            roi_end_h = bottom_rois[4] * spatial_scale_;
+            roi_width  = roi_end_w - roi_start_w;
+            roi_height = roi_end_h - roi_start_h;
+        } else if (mode_ == AVERAGE) {
+            roi_start_w = static_cast<float>(round(bottom_rois[1])) * spatial_scale_;
+            roi_start_h = static_cast<float>(round(bottom_rois[2])) * spatial_scale_;
+            roi_end_w   = static_cast<float>(round(bottom_rois[3]) + 1.0f) * spatial_scale_;
+            roi_end_h   = static_cast<float>(round(bottom_rois[4]) + 1.0f) * spatial_scale_;
+            // Force too small ROIs to be 1x1
+            roi_width  = std::max<float>(roi_end_w - roi_start_w, 0.1f);  // avoid 0
+            roi_height = std::max<float>(roi_end_h - roi_start_h, 0.1f);
+        } else {
+            roi_start_w = static_cast<float>(round(bottom_rois[1])) * spatial_scale_ - 0.5f;
+            roi_start_h = static_cast<float>(round(bottom_rois[2])) * spatial_scale_ - 0.5f;
+            roi_end_w   = static_cast<float>(round(bottom_rois[3]) + 1.0f) * spatial_scale_ - 0.5f;
+            roi_end_h   = static_cast<float>(round(bottom_rois[4]) + 1.0f) * spatial_scale_ - 0.5f;
+            // Force too small ROIs to be 1x1
+            roi_width  = std::max<float>(roi_end_w - roi_start_w, 0.1f);  // avoid 0
+            roi_height = std::max<float>(roi_end_h - roi_start_h, 0.1f);
+        }
+    }
+
+    // Bin extents of a ROI along one axis, pooled entries
+    static void averageAxis(float roi_start, float roi_size, size_t pooled, int out_size, int in_size,
+                            AxisSample* samples) {
+        float bin_size = roi_size / static_cast<float>(pooled);
+        for (int i = 0; i < out_size; i++) {
+            int start = static_cast<int>(floor(static_cast<float>(i + 0) * bin_size + roi_start));
+            int end = static_cast<int>(ceil(static_cast<float>(i + 1) * bin_size + roi_start));
+            samples[i].first = std::min<int>(std::max<int>(start, 0), in_size);
+            samples[i].second = std::min<int>(std::max<int>(end, 0), in_size);
+            samples[i].weight = 0.0f;
+            samples[i].valid = true;
+        }
+    }
+
+    // Bilinear sample positions of a ROI along one axis, spatial_bins x pooled entries
+    static void bilinearAxis(float roi_start, float roi_size, size_t spatial_bins, size_t pooled, int out_size,
+                             int in_size, AxisSample* samples) {
+        for (size_t bin = 0; bin < spatial_bins; bin++) {
+            float box_min = roi_start + (bin + 0) * (roi_size / spatial_bins);
+            float box_max = roi_start + (bin + 1) * (roi_size / spatial_bins);
+
+            float scale = out_size > 1 ? (box_max - box_min) * (in_size - 1) / (pooled - 1) : 0.0f;
+
+            for (int i = 0; i < out_size; i++) {
+                AxisSample& sample = samples[bin * out_size + i];
+
+                float in = out_size > 1 ? (i * scale + box_min * (in_size - 1))
+                                        : 0.5f * (box_min + box_max) * (in_size - 1);
+
+                sample.valid = !(in < 0 || in > in_size - 1);
+                sample.first = sample.valid ? static_cast<int>(floorf(in)) : 0;
+                sample.second = sample.valid ? std::min(static_cast<int>(ceilf(in)), in_size - 1) : 0;
+                sample.weight = in - sample.first;
+            }
+        }
+    }
+
     size_t output_dim_ = 0;
     size_t group_size_ = 0;
     float spatial_scale_ = 0;
@@ -286,7 +359,7 @@ private:
     size_t pooled_width_ = 0;
     size_t spatial_bins_x_ = 0;
     size_t spatial_bins_y_ = 0;
-    std::string mode_ = "";
+    Mode mode_ = AVERAGE;
 
     int channels = 0;
     int height = 0;
@@ -301,6 +374,9 @@ private:
     bool no_trans_;
     int part_size_;
     float trans_std_;
+
+    std::vector<AxisSample> samples_y_;
+    std::vector<AxisSample> samples_x_;
 };
 
 REG_FACTORY_FOR(ImplFactory<PSROIPoolingImpl>, PSROIPooling);
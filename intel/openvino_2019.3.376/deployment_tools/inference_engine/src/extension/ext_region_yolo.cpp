@@ -16,6 +16,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class RegionYoloImpl: public ExtLayerBase {
 public:
@@ -100,9 +101,7 @@ public:
         if (do_softmax) {
             int index = IW * IH * (coords + 1);
             int batch_offset = inputs_size / num;
-            for (int b = 0; b < B * num; b++)
-                softmax_generic(src_data + index + b * batch_offset, dst_data + index + b * batch_offset, 1, classes,
-                                IH, IW);
+            softmax_planar_batches(src_data + index, dst_data + index, B * num, classes, IH * IW, batch_offset);
         }
 
         return OK;
@@ -249,6 +248,7 @@ private:
 
 REG_FACTORY_FOR(ImplFactory<RegionYoloImpl>, RegionYolo);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
@@ -18,6 +18,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 inline int div_up(const int a, const int b) {
     assert(b);
@@ -148,84 +149,192 @@ private:
     std::string type;
     bool antialias;
 
+#if defined(HAVE_AVX512F)
+    typedef __m512 vec_type;
+    static const int vec_size = 16;
+#elif defined(HAVE_AVX2)
+    typedef __m256 vec_type;
+    static const int vec_size = 8;
+#elif defined(HAVE_SSE)
+    typedef __m128 vec_type;
+    static const int vec_size = 4;
+#endif
+
     static inline float triangleCoeff(float x) {
         return std::max(0.0f, 1 - std::abs(x));
     }
 
+    struct AxisTable {
+        size_t taps = 0;
+        std::vector<int> index;     // [taps][out_size]
+        std::vector<float> weight;  // [taps][out_size]
+    };
+
+    // Triangle filter taps of every output coordinate along one axis. Taps that fall outside
+    // the input are dropped and the rest are normalized, which makes the 2D filter separable.
+    static void buildAxisTable(AxisTable& table, size_t in_size, size_t out_size, float f,
+                               size_t kernel_width, bool antialias) {
+        float a = 1.0f / (antialias ? f : 1.0f);
+        int r = (f < 1.0f) ? 2 : static_cast<int>(ceil(static_cast<float>(kernel_width) / a));
+        int window = 2 * r + 1;
+
+        std::vector<float> w(out_size * window);
+        std::vector<int> origin(out_size), first(out_size), last(out_size);
+        table.taps = 1;
+        for (size_t o = 0; o < out_size; o++) {
+            float i = o * f + f / 2.0f - 0.5f;
+            int i_r = static_cast<int>(round(i));
+
+            float wsum = 0;
+            first[o] = window;
+            last[o] = -1;
+            for (int k = 0; k < window; k++) {
+                int x = i_r - r + k;
+                float wk = (x < 0 || x >= static_cast<int>(in_size)) ? 0.0f : a * triangleCoeff(a * (i - x));
+                w[o * window + k] = wk;
+                wsum += wk;
+                if (wk != 0.0f) {
+                    first[o] = std::min(first[o], k);
+                    last[o] = k;
+                }
+            }
+            if (wsum != 0.0f) {
+                for (int k = 0; k < window; k++)
+                    w[o * window + k] /= wsum;
+            }
+            origin[o] = i_r - r;
+            if (last[o] >= first[o])
+                table.taps = std::max(table.taps, static_cast<size_t>(last[o] - first[o] + 1));
+        }
+
+        // shorter windows are padded with zero weights at a valid index
+        table.index.assign(table.taps * out_size, 0);
+        table.weight.assign(table.taps * out_size, 0.0f);
+        for (size_t o = 0; o < out_size; o++) {
+            if (last[o] < first[o])
+                continue;
+            for (size_t t = 0; t < table.taps; t++) {
+                int k = first[o] + static_cast<int>(t);
+                table.index[t * out_size + o] = origin[o] + std::min(k, last[o]);
+                table.weight[t * out_size + o] = k <= last[o] ? w[o * window + k] : 0.0f;
+            }
+        }
+    }
+
+    static void filterRow(const float *src, float *dst, const AxisTable& tx, size_t ow) {
+        const int *index = tx.index.data();
+        const float *weight = tx.weight.data();
+
+        size_t ox = 0;
+#if defined(HAVE_AVX512F)
+        for (; ox + 16 <= ow; ox += 16) {
+            __m512 vsum = _mm512_setzero_ps();
+            for (size_t t = 0; t < tx.taps; t++) {
+                __m512i vidx = _mm512_loadu_si512(index + t * ow + ox);
+                __m512 vsrc = _mm512_i32gather_ps(vidx, src, sizeof(float));
+                vsum = _mm512_add_ps(vsum, _mm512_mul_ps(_mm512_loadu_ps(weight + t * ow + ox), vsrc));
+            }
+            _mm512_storeu_ps(dst + ox, vsum);
+        }
+#elif defined(HAVE_AVX2)
+        for (; ox + 8 <= ow; ox += 8) {
+            __m256 vsum = _mm256_setzero_ps();
+            for (size_t t = 0; t < tx.taps; t++) {
+                __m256i vidx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(index + t * ow + ox));
+                __m256 vsrc = _mm256_i32gather_ps(src, vidx, sizeof(float));
+                vsum = _mm256_add_ps(vsum, _mm256_mul_ps(_mm256_loadu_ps(weight + t * ow + ox), vsrc));
+            }
+            _mm256_storeu_ps(dst + ox, vsum);
+        }
+#endif
+        for (; ox < ow; ox++) {
+            float sum = 0.0f;
+            for (size_t t = 0; t < tx.taps; t++)
+                sum += weight[t * ow + ox] * src[index[t * ow + ox]];
+            dst[ox] = sum;
+        }
+    }
+
     static void InterpolationKernel(const float *in_ptr_,
                                     const size_t iw, const size_t ih,
                                     const float fx, const float fy,
                                     float *out_ptr_,
                                     const size_t ow, const size_t oh, const size_t channels, const size_t batch,
                                     size_t kernel_width, bool antialias) {
-        for (size_t b = 0; b < batch; b++) {
-            for (size_t c = 0; c < channels; c++) {
-                const float *in_ptr = in_ptr_ + iw * ih * channels * b + iw * ih * c;
-                float *out_ptr = out_ptr_ + ow * oh * channels * b + ow * oh * c;
+        AxisTable tx, ty;
+        buildAxisTable(tx, iw, ow, fx, kernel_width, antialias);
+        buildAxisTable(ty, ih, oh, fy, kernel_width, antialias);
 
-                for (size_t oy = 0; oy < oh; oy++) {
-                    for (size_t ox = 0; ox < ow; ox++) {
-                        float ix = ox * fx + fx / 2.0f - 0.5f;
-                        float iy = oy * fy + fy / 2.0f - 0.5f;
+        const size_t rows_per_task = 16;
+        const size_t row_blocks = div_up(oh, rows_per_task);
 
-                        int ix_r = static_cast<int>(round(ix));
-                        int iy_r = static_cast<int>(round(iy));
+        parallel_for3d(batch, channels, row_blocks, [&](size_t b, size_t c, size_t rb) {
+            const float *in_ptr = in_ptr_ + iw * ih * channels * b + iw * ih * c;
+            float *out_ptr = out_ptr_ + ow * oh * channels * b + ow * oh * c;
 
-                        float sum = 0;
-                        float wsum = 0;
+            size_t oy_start = rb * rows_per_task;
+            size_t oy_end = std::min(oh, oy_start + rows_per_task);
 
-                        float ax = 1.0f / (antialias ? fx : 1.0f);
-                        float ay = 1.0f / (antialias ? fy : 1.0f);
-
-                        int rx = (fx < 1.0f) ? 2 : static_cast<int>(ceil(static_cast<float>(kernel_width) / ax));
-                        int ry = (fy < 1.0f) ? 2 : static_cast<int>(ceil(static_cast<float>(kernel_width) / ay));
-
-                        for (int y = iy_r - ry; y <= iy_r + ry; y++) {
-                            for (int x = ix_r - rx; x <= ix_r + rx; x++) {
-                                if (y < 0 || x < 0 || y >= static_cast<int>(ih) || x >= static_cast<int>(iw))
-                                    continue;
-
-                                float dx = ix - x;
-                                float dy = iy - y;
-
-                                float w = ax * triangleCoeff(ax * dx) * ay * triangleCoeff(ay * dy);
+            int y_first = static_cast<int>(ih), y_last = -1;
+            for (size_t t = 0; t < ty.taps; t++) {
+                for (size_t oy = oy_start; oy < oy_end; oy++) {
+                    y_first = std::min(y_first, ty.index[t * oh + oy]);
+                    y_last = std::max(y_last, ty.index[t * oh + oy]);
+                }
+            }
 
-                                sum += w * in_ptr[y * iw + x];
-                                wsum += w;
-                            }
-                        }
+            // horizontal pass over the input rows this block reads, then vertical pass per output row
+            std::vector<float> rows((y_last - y_first + 1) * ow);
+            for (int y = y_first; y <= y_last; y++)
+                filterRow(in_ptr + y * iw, &rows[(y - y_first) * ow], tx, ow);
 
-                        out_ptr[oy * ow + ox] = (!wsum) ? 0 : (sum / wsum);
+            for (size_t oy = oy_start; oy < oy_end; oy++) {
+                float *dst = out_ptr + oy * ow;
+                size_t ox = 0;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+                for (; ox + vec_size <= ow; ox += vec_size) {
+                    vec_type vsum = _mm_uni_setzero_ps();
+                    for (size_t t = 0; t < ty.taps; t++) {
+                        const float *row = &rows[(ty.index[t * oh + oy] - y_first) * ow];
+                        vsum = _mm_uni_add_ps(vsum, _mm_uni_mul_ps(_mm_uni_set1_ps(ty.weight[t * oh + oy]),
+                                                                   _mm_uni_loadu_ps(row + ox)));
                     }
+                    _mm_uni_storeu_ps(dst + ox, vsum);
+                }
+#endif
+                for (; ox < ow; ox++) {
+                    float sum = 0.0f;
+                    for (size_t t = 0; t < ty.taps; t++)
+                        sum += ty.weight[t * oh + oy] * rows[(ty.index[t * oh + oy] - y_first) * ow + ox];
+                    dst[ox] = sum;
                 }
             }
-        }
+        });
+    }
+
+    static std::vector<size_t> nearestIndices(int out_size, float f) {
+        std::vector<size_t> index(out_size);
+        for (int o = 0; o < out_size; o++)
+            index[o] = static_cast<size_t>(round(o * f + f / 2.0f - 0.5f));
+        return index;
     }
 
     static void NearestNeighborKernel_PLN(const float *in_ptr_, float *out_ptr_, int B, int C, int ID, int IH, int IW,
                                           float fx, float fy, float fz, int OD, int OH, int OW) {
-        for (int b = 0; b < B; b++) {
-            for (int c = 0; c < C; c++) {
-                const float *in_ptr = in_ptr_ + IW * IH * ID * C * b + IW * IH * ID * c;
-                float *out_ptr = out_ptr_ + OW * OH * OD * C * b + OW * OH * OD * c;
-
-                for (int oz = 0; oz < OD; oz++) {
-                    for (int oy = 0; oy < OH; oy++) {
-                        for (int ox = 0; ox < OW; ox++) {
-                            float ix = ox * fx + fx / 2.0f - 0.5f;
-                            float iy = oy * fy + fy / 2.0f - 0.5f;
-                            float iz = oz * fz + fz / 2.0f - 0.5f;
-
-                            size_t ix_r = static_cast<size_t>(round(ix));
-                            size_t iy_r = static_cast<size_t>(round(iy));
-                            size_t iz_r = static_cast<size_t>(round(iz));
-
-                            out_ptr[oz * OH * OW + oy * OW + ox] = in_ptr[iz_r * IH * IW + iy_r * IW + ix_r];
-                        }
-                    }
-                }
-            }
-        }
+        std::vector<size_t> index_x = nearestIndices(OW, fx);
+        std::vector<size_t> index_y = nearestIndices(OH, fy);
+        std::vector<size_t> index_z = nearestIndices(OD, fz);
+
+        parallel_for3d(B, C, OD * OH, [&](int b, int c, int row) {
+            int oz = row / OH;
+            int oy = row % OH;
+            const float *in_ptr = in_ptr_ + IW * IH * ID * C * b + IW * IH * ID * c +
+                                  (index_z[oz] * IH + index_y[oy]) * IW;
+            float *out_ptr = out_ptr_ + OW * OH * OD * C * b + OW * OH * OD * c + (oz * OH + oy) * OW;
+
+            for (int ox = 0; ox < OW; ox++)
+                out_ptr[ox] = in_ptr[index_x[ox]];
+        });
     }
 
     static void NearestNeighborKernel_BLK(const float *in_ptr_, float *out_ptr_, int B, int C, int ID, int IH, int IW,
@@ -237,32 +346,30 @@ private:
 #endif
         int CB = div_up(C, blk_size);
 
-        for (int b = 0; b < B; b++) {
-            for (int cb = 0; cb < CB; cb++) {
-                const float *in_ptr = in_ptr_ + IW * IH * ID * CB * blk_size * b + IW * IH * ID * cb * blk_size;
-                float *out_ptr = out_ptr_ + OW * OH * OD * CB * blk_size * b + OW * OH * OD * cb * blk_size;
-
-                for (int oz = 0; oz < OD; oz++) {
-                    for (int oy = 0; oy < OH; oy++) {
-                        for (int ox = 0; ox < OW; ox++) {
-                            float ix = ox * fx + fx / 2.0f - 0.5f;
-                            float iy = oy * fy + fy / 2.0f - 0.5f;
-                            float iz = oz * fz + fz / 2.0f - 0.5f;
-
-                            size_t ix_r = static_cast<size_t>(round(ix));
-                            size_t iy_r = static_cast<size_t>(round(iy));
-                            size_t iz_r = static_cast<size_t>(round(iz));
-
-                            for (int c = 0; c < blk_size; c++) {
-                                float value = in_ptr[iz_r * IH * IW * blk_size + iy_r * IW * blk_size + ix_r * blk_size + c];
-
-                                out_ptr[oz * OH * OW * blk_size + oy * OW * blk_size + ox * blk_size + c] = value;
-                            }
-                        }
-                    }
-                }
+        std::vector<size_t> index_x = nearestIndices(OW, fx);
+        std::vector<size_t> index_y = nearestIndices(OH, fy);
+        std::vector<size_t> index_z = nearestIndices(OD, fz);
+
+        parallel_for3d(B, CB, OD * OH, [&](int b, int cb, int row) {
+            int oz = row / OH;
+            int oy = row % OH;
+            const float *in_ptr = in_ptr_ + IW * IH * ID * CB * blk_size * b + IW * IH * ID * cb * blk_size +
+                                  (index_z[oz] * IH + index_y[oy]) * IW * blk_size;
+            float *out_ptr = out_ptr_ + OW * OH * OD * CB * blk_size * b + OW * OH * OD * cb * blk_size +
+                             (oz * OH + oy) * OW * blk_size;
+
+            for (int ox = 0; ox < OW; ox++) {
+                const float *in_pixel = in_ptr + index_x[ox] * blk_size;
+                float *out_pixel = out_ptr + ox * blk_size;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+                for (int c = 0; c < blk_size; c += vec_size)
+                    _mm_uni_storeu_ps(out_pixel + c, _mm_uni_loadu_ps(in_pixel + c));
+#else
+                for (int c = 0; c < blk_size; c++)
+                    out_pixel[c] = in_pixel[c];
+#endif
             }
-        }
+        });
     }
 
     template <typename T, int factor>
@@ -274,31 +381,26 @@ private:
         int OW = factor * IW;
 
         if (layout == NCHW || layout == NCDHW) {
-            for (int b = 0; b < B; b++) {
-                for (int c = 0; c < C; c++) {
-                    const T *in_ptr = in_ptr_ + IW * IH * ID * C * b + IW * IH * ID * c;
-                    T *out_ptr = out_ptr_ + OW * OH * OD * C * b + OW * OH * OD * c;
-
-                    for (int iz = 0; iz < ID; iz++) {
-                        for (int iy = 0; iy < IH; iy++) {
-                            for (int ix = 0; ix < IW; ix++) {
-                                int oz = factor_d * iz;
-                                int oy = factor * iy;
-                                int ox = factor * ix;
-                                float value = in_ptr[iz * IH * IW + iy * IW + ix];
-
-                                for (int fd = 0; fd < factor_d; fd++) {
-                                    for (int fh = 0; fh < factor; fh++) {
-                                        for (int fw = 0; fw < factor; fw++) {
-                                            out_ptr[(oz + fd) * OH * OW + (oy + fh) * OW + ox + fw] = static_cast<T>(value);
-                                        }
-                                    }
-                                }
-                            }
-                        }
+            parallel_for3d(B, C, ID * IH, [&](int b, int c, int row) {
+                int iz = row / IH;
+                int iy = row % IH;
+                const T *in_ptr = in_ptr_ + IW * IH * ID * C * b + IW * IH * ID * c + (iz * IH + iy) * IW;
+                T *out_ptr = out_ptr_ + OW * OH * OD * C * b + OW * OH * OD * c + (factor_d * iz * OH + factor * iy) * OW;
+
+                for (int ix = 0; ix < IW; ix++) {
+                    T value = in_ptr[ix];
+                    for (int fw = 0; fw < factor; fw++)
+                        out_ptr[factor * ix + fw] = value;
+                }
+
+                // the other rows produced by this input row are copies of the first one
+                for (int fd = 0; fd < factor_d; fd++) {
+                    for (int fh = 0; fh < factor; fh++) {
+                        if (fd || fh)
+                            memcpy(out_ptr + (fd * OH + fh) * OW, out_ptr, OW * sizeof(T));
                     }
                 }
-            }
+            });
         } else {
             int block_size = C;
             int block_size_bytes = block_size * sizeof(T);
@@ -471,393 +573,392 @@ private:
             }
         };
     #endif
-        for (size_t b = 0; b < batch; b++) {
-            for (size_t c = 0; c < channels; c++) {
-                const float *in_ptr = in_ptr_ + b * channels * iw * ih + c * iw * ih;
-                float *out_ptr = out_ptr_ + b * channels * ow * oh + c * ow * oh;
+        parallel_for2d(batch, channels, [&](size_t b, size_t c) {
+            const float *in_ptr = in_ptr_ + b * channels * iw * ih + c * iw * ih;
+            float *out_ptr = out_ptr_ + b * channels * ow * oh + c * ow * oh;
 
-                size_t oy = 0;
-                {
-                    float iy = oy * fy + fx / 2.0f - 0.5f;
-                    size_t iy_r = static_cast<size_t>(round(iy));
+            size_t oy = 0;
+            {
+                float iy = oy * fy + fx / 2.0f - 0.5f;
+                size_t iy_r = static_cast<size_t>(round(iy));
 
-                    size_t ox = 0;
+                size_t ox = 0;
         #if defined(HAVE_AVX2)
-                    for (; ox <= ow - 8; ox += 8) {
-                        float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
-                        size_t ix_r = static_cast<size_t>(round(ix));
-
-                        __m256 vx00 = _mm256_setzero_ps();
-                        __m256 vx01 = _mm256_setzero_ps();
-                        __m256 vx02 = _mm256_setzero_ps();
-
-                        __m128 vx10_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r - 1);
-                        __m128 vx11_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 0);
-                        __m128 vx12_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 1);
-                        __m128 vx13_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 2);
-
-                        __m128 vx20_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r - 1);
-                        __m128 vx21_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 0);
-                        __m128 vx22_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 1);
-                        __m128 vx23_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 2);
-
-                        __m256 vx10 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx10_), vx11_, 1);
-                        __m256 vx11 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx11_), vx12_, 1);
-                        __m256 vx12 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx12_), vx13_, 1);
-                        __m256 vx20 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx20_), vx21_, 1);
-                        __m256 vx21 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx21_), vx22_, 1);
-                        __m256 vx22 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx22_), vx23_, 1);
-
-                        for (size_t i = 0; i < 4; i++) {
-                            __m256 vc0 = i < 2 ? _mm256_setzero_ps() : _mm256_loadu_ps(table_avx2[i] + 0);
-                            __m256 vc1 = i < 2 ? _mm256_setzero_ps() : _mm256_loadu_ps(table_avx2[i] + 8);
-                            __m256 vc2 = _mm256_loadu_ps(table_avx2[i] + 16);
-                            __m256 vc3 = _mm256_loadu_ps(table_avx2[i] + 24);
-
-                            if (ox == 0) {
-                                if (i > 1)
-                                    vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc0, 0), 0xD0), 0);
-                                vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc2, 0), 0xD0), 0);
-                            } else if (ox == ow - 8) {
-                                if (i > 1)
-                                    vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm256_extractf128_ps(vc0, 1), _mm_setzero_ps(), 0x07), 1);
-                                vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm256_extractf128_ps(vc2, 1), _mm_setzero_ps(), 0x07), 1);
-                            }
+                for (; ox <= ow - 8; ox += 8) {
+                    float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
+                    size_t ix_r = static_cast<size_t>(round(ix));
+
+                    __m256 vx00 = _mm256_setzero_ps();
+                    __m256 vx01 = _mm256_setzero_ps();
+                    __m256 vx02 = _mm256_setzero_ps();
+
+                    __m128 vx10_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r - 1);
+                    __m128 vx11_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 0);
+                    __m128 vx12_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 1);
+                    __m128 vx13_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 2);
+
+                    __m128 vx20_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r - 1);
+                    __m128 vx21_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 0);
+                    __m128 vx22_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 1);
+                    __m128 vx23_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 2);
+
+                    __m256 vx10 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx10_), vx11_, 1);
+                    __m256 vx11 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx11_), vx12_, 1);
+                    __m256 vx12 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx12_), vx13_, 1);
+                    __m256 vx20 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx20_), vx21_, 1);
+                    __m256 vx21 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx21_), vx22_, 1);
+                    __m256 vx22 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx22_), vx23_, 1);
+
+                    for (size_t i = 0; i < 4; i++) {
+                        __m256 vc0 = i < 2 ? _mm256_setzero_ps() : _mm256_loadu_ps(table_avx2[i] + 0);
+                        __m256 vc1 = i < 2 ? _mm256_setzero_ps() : _mm256_loadu_ps(table_avx2[i] + 8);
+                        __m256 vc2 = _mm256_loadu_ps(table_avx2[i] + 16);
+                        __m256 vc3 = _mm256_loadu_ps(table_avx2[i] + 24);
+
+                        if (ox == 0) {
+                            if (i > 1)
+                                vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc0, 0), 0xD0), 0);
+                            vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc2, 0), 0xD0), 0);
+                        } else if (ox == ow - 8) {
+                            if (i > 1)
+                                vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm256_extractf128_ps(vc0, 1), _mm_setzero_ps(), 0x07), 1);
+                            vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm256_extractf128_ps(vc2, 1), _mm_setzero_ps(), 0x07), 1);
+                        }
 
-                            __m256 vsrc0 = i < 2 ? _mm256_shuffle_ps(vx00, vx02, 0x0) : _mm256_shuffle_ps(vx10, vx12, 0x0);
-                            __m256 vsrc1 = i < 2 ? _mm256_shuffle_ps(vx01, vx01, 0x0) : _mm256_shuffle_ps(vx11, vx11, 0x0);
-                            __m256 vsrc2 = i < 2 ? _mm256_shuffle_ps(vx10, vx12, 0x0) : _mm256_shuffle_ps(vx20, vx22, 0x0);
-                            __m256 vsrc3 = i < 2 ? _mm256_shuffle_ps(vx11, vx11, 0x0) : _mm256_shuffle_ps(vx21, vx21, 0x0);
+                        __m256 vsrc0 = i < 2 ? _mm256_shuffle_ps(vx00, vx02, 0x0) : _mm256_shuffle_ps(vx10, vx12, 0x0);
+                        __m256 vsrc1 = i < 2 ? _mm256_shuffle_ps(vx01, vx01, 0x0) : _mm256_shuffle_ps(vx11, vx11, 0x0);
+                        __m256 vsrc2 = i < 2 ? _mm256_shuffle_ps(vx10, vx12, 0x0) : _mm256_shuffle_ps(vx20, vx22, 0x0);
+                        __m256 vsrc3 = i < 2 ? _mm256_shuffle_ps(vx11, vx11, 0x0) : _mm256_shuffle_ps(vx21, vx21, 0x0);
 
-                            __m256 res = _mm256_setzero_ps();
+                        __m256 res = _mm256_setzero_ps();
 
-                            res = _mm256_fmadd_ps(vsrc0, vc0, res);
-                            res = _mm256_fmadd_ps(vsrc1, vc1, res);
-                            res = _mm256_fmadd_ps(vsrc2, vc2, res);
-                            res = _mm256_fmadd_ps(vsrc3, vc3, res);
-                            __m256 wei = _mm256_add_ps(_mm256_add_ps(vc0, vc1), _mm256_add_ps(vc2, vc3));
+                        res = _mm256_fmadd_ps(vsrc0, vc0, res);
+                        res = _mm256_fmadd_ps(vsrc1, vc1, res);
+                        res = _mm256_fmadd_ps(vsrc2, vc2, res);
+                        res = _mm256_fmadd_ps(vsrc3, vc3, res);
+                        __m256 wei = _mm256_add_ps(_mm256_add_ps(vc0, vc1), _mm256_add_ps(vc2, vc3));
 
-                            res = _mm256_div_ps(res, wei);
+                        res = _mm256_div_ps(res, wei);
 
-                            _mm256_storeu_ps(out_ptr + (oy + i) * ow + ox, res);
-                        }
+                        _mm256_storeu_ps(out_ptr + (oy + i) * ow + ox, res);
                     }
+                }
         #endif
 
         #if defined(HAVE_SSE) || defined(HAVE_AVX2)
-                    for (; ox <= ow - 4; ox += 4) {
-                        float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
-                        size_t ix_r = static_cast<size_t>(round(ix));
-
-                        __m128 vx00 = _mm_setzero_ps();
-                        __m128 vx01 = _mm_setzero_ps();
-                        __m128 vx02 = _mm_setzero_ps();
-
-                        __m128 vx10 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r-1);
-                        __m128 vx11 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+0);
-                        __m128 vx12 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+1);
-
-                        __m128 vx20 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r-1);
-                        __m128 vx21 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+0);
-                        __m128 vx22 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+1);
-
-                        for (size_t i = 0; i < 4; i++) {
-                            __m128 vc0 = i < 2 ? _mm_setzero_ps() : _mm_loadu_ps(table_sse[i] + 0);
-                            __m128 vc1 = i < 2 ? _mm_setzero_ps() : _mm_loadu_ps(table_sse[i] + 4);
-                            __m128 vc2 = _mm_loadu_ps(table_sse[i] +  8);
-                            __m128 vc3 = _mm_loadu_ps(table_sse[i] + 12);
-
-                            if (ox == 0) {
-                                if (i > 1)
-                                    vc0 = _mm_shuffle_ps(_mm_setzero_ps(), vc0, 0xD0);
-                                vc2 = _mm_shuffle_ps(_mm_setzero_ps(), vc2, 0xD0);
-                            } else if (ox == ow - 4) {
-                                if (i > 1)
-                                    vc0 = _mm_shuffle_ps(vc0, _mm_setzero_ps() , 0x07);
-                                vc2 = _mm_shuffle_ps(vc2, _mm_setzero_ps() , 0x07);
-                            }
+                for (; ox <= ow - 4; ox += 4) {
+                    float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
+                    size_t ix_r = static_cast<size_t>(round(ix));
+
+                    __m128 vx00 = _mm_setzero_ps();
+                    __m128 vx01 = _mm_setzero_ps();
+                    __m128 vx02 = _mm_setzero_ps();
+
+                    __m128 vx10 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r-1);
+                    __m128 vx11 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+0);
+                    __m128 vx12 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+1);
+
+                    __m128 vx20 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r-1);
+                    __m128 vx21 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+0);
+                    __m128 vx22 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+1);
+
+                    for (size_t i = 0; i < 4; i++) {
+                        __m128 vc0 = i < 2 ? _mm_setzero_ps() : _mm_loadu_ps(table_sse[i] + 0);
+                        __m128 vc1 = i < 2 ? _mm_setzero_ps() : _mm_loadu_ps(table_sse[i] + 4);
+                        __m128 vc2 = _mm_loadu_ps(table_sse[i] +  8);
+                        __m128 vc3 = _mm_loadu_ps(table_sse[i] + 12);
+
+                        if (ox == 0) {
+                            if (i > 1)
+                                vc0 = _mm_shuffle_ps(_mm_setzero_ps(), vc0, 0xD0);
+                            vc2 = _mm_shuffle_ps(_mm_setzero_ps(), vc2, 0xD0);
+                        } else if (ox == ow - 4) {
+                            if (i > 1)
+                                vc0 = _mm_shuffle_ps(vc0, _mm_setzero_ps() , 0x07);
+                            vc2 = _mm_shuffle_ps(vc2, _mm_setzero_ps() , 0x07);
+                        }
 
-                            __m128 vsrc0 = i < 2 ? _mm_shuffle_ps(vx00, vx02, 0x0) : _mm_shuffle_ps(vx10, vx12, 0x0);
-                            __m128 vsrc1 = i < 2 ? _mm_shuffle_ps(vx01, vx01, 0x0) : _mm_shuffle_ps(vx11, vx11, 0x0);
-                            __m128 vsrc2 = i < 2 ? _mm_shuffle_ps(vx10, vx12, 0x0) : _mm_shuffle_ps(vx20, vx22, 0x0);
-                            __m128 vsrc3 = i < 2 ? _mm_shuffle_ps(vx11, vx11, 0x0) : _mm_shuffle_ps(vx21, vx21, 0x0);
+                        __m128 vsrc0 = i < 2 ? _mm_shuffle_ps(vx00, vx02, 0x0) : _mm_shuffle_ps(vx10, vx12, 0x0);
+                        __m128 vsrc1 = i < 2 ? _mm_shuffle_ps(vx01, vx01, 0x0) : _mm_shuffle_ps(vx11, vx11, 0x0);
+                        __m128 vsrc2 = i < 2 ? _mm_shuffle_ps(vx10, vx12, 0x0) : _mm_shuffle_ps(vx20, vx22, 0x0);
+                        __m128 vsrc3 = i < 2 ? _mm_shuffle_ps(vx11, vx11, 0x0) : _mm_shuffle_ps(vx21, vx21, 0x0);
 
-                            __m128 vres0 = _mm_mul_ps(vsrc0, vc0);
-                            __m128 vres1 = _mm_mul_ps(vsrc1, vc1);
-                            __m128 vres2 = _mm_mul_ps(vsrc2, vc2);
-                            __m128 vres3 = _mm_mul_ps(vsrc3, vc3);
+                        __m128 vres0 = _mm_mul_ps(vsrc0, vc0);
+                        __m128 vres1 = _mm_mul_ps(vsrc1, vc1);
+                        __m128 vres2 = _mm_mul_ps(vsrc2, vc2);
+                        __m128 vres3 = _mm_mul_ps(vsrc3, vc3);
 
-                            __m128 res = _mm_add_ps(_mm_add_ps(vres0, vres1), _mm_add_ps(vres2, vres3));
-                            __m128 wei = _mm_add_ps(_mm_add_ps(vc0, vc1), _mm_add_ps(vc2, vc3));
+                        __m128 res = _mm_add_ps(_mm_add_ps(vres0, vres1), _mm_add_ps(vres2, vres3));
+                        __m128 wei = _mm_add_ps(_mm_add_ps(vc0, vc1), _mm_add_ps(vc2, vc3));
 
-                            res = _mm_div_ps(res, wei);
+                        res = _mm_div_ps(res, wei);
 
-                            _mm_storeu_ps(out_ptr + (oy+i)*ow + ox, res);
-                        }
+                        _mm_storeu_ps(out_ptr + (oy+i)*ow + ox, res);
                     }
-        #endif
                 }
+        #endif
+            }
 
-                for (oy = 4; oy <= oh - 8; oy += 4) {
-                    float iy = oy * fy + fx / 2.0f - 0.5f;
-                    size_t iy_r = static_cast<size_t>(round(iy));
+            for (oy = 4; oy <= oh - 8; oy += 4) {
+                float iy = oy * fy + fx / 2.0f - 0.5f;
+                size_t iy_r = static_cast<size_t>(round(iy));
 
-                    size_t ox = 0;
+                size_t ox = 0;
         #if defined(HAVE_AVX2)
-                    for (; ox <= ow - 8; ox += 8) {
-                        float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
-                        size_t ix_r = static_cast<size_t>(round(ix));
-
-                        __m128 vx00_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r - 1);
-                        __m128 vx01_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 0);
-                        __m128 vx02_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 1);
-                        __m128 vx03_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 2);
-
-                        __m128 vx10_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r - 1);
-                        __m128 vx11_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 0);
-                        __m128 vx12_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 1);
-                        __m128 vx13_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 2);
-
-                        __m128 vx20_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r - 1);
-                        __m128 vx21_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 0);
-                        __m128 vx22_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 1);
-                        __m128 vx23_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 2);
-
-                        __m256 vx00 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx00_), vx01_, 1);
-                        __m256 vx01 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx01_), vx02_, 1);
-                        __m256 vx02 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx02_), vx03_, 1);
-
-                        __m256 vx10 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx10_), vx11_, 1);
-                        __m256 vx11 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx11_), vx12_, 1);
-                        __m256 vx12 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx12_), vx13_, 1);
-
-                        __m256 vx20 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx20_), vx21_, 1);
-                        __m256 vx21 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx21_), vx22_, 1);
-                        __m256 vx22 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx22_), vx23_, 1);
-
-                        for (size_t i = 0; i < 4; i++) {
-                            __m256 vc0 = _mm256_loadu_ps(table_avx2[i] + 0);
-                            __m256 vc1 = _mm256_loadu_ps(table_avx2[i] + 8);
-                            __m256 vc2 = _mm256_loadu_ps(table_avx2[i] + 16);
-                            __m256 vc3 = _mm256_loadu_ps(table_avx2[i] + 24);
-
-                            if (ox == 0) {
-                                vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc0, 0), 0xD0), 0);
-                                vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc2, 0), 0xD0), 0);
-                            } else if (ox == ow - 8) {
-                                vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm256_extractf128_ps(vc0, 1), _mm_setzero_ps(), 0x07), 1);
-                                vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm256_extractf128_ps(vc2, 1), _mm_setzero_ps(), 0x07), 1);
-                            }
-
-                            __m256 vsrc0 = i < 2 ? _mm256_shuffle_ps(vx00, vx02, 0x0) : _mm256_shuffle_ps(vx10, vx12, 0x0);
-                            __m256 vsrc1 = i < 2 ? _mm256_shuffle_ps(vx01, vx01, 0x0) : _mm256_shuffle_ps(vx11, vx11, 0x0);
-                            __m256 vsrc2 = i < 2 ? _mm256_shuffle_ps(vx10, vx12, 0x0) : _mm256_shuffle_ps(vx20, vx22, 0x0);
-                            __m256 vsrc3 = i < 2 ? _mm256_shuffle_ps(vx11, vx11, 0x0) : _mm256_shuffle_ps(vx21, vx21, 0x0);
+                for (; ox <= ow - 8; ox += 8) {
+                    float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
+                    size_t ix_r = static_cast<size_t>(round(ix));
+
+                    __m128 vx00_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r - 1);
+                    __m128 vx01_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 0);
+                    __m128 vx02_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 1);
+                    __m128 vx03_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 2);
+
+                    __m128 vx10_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r - 1);
+                    __m128 vx11_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 0);
+                    __m128 vx12_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 1);
+                    __m128 vx13_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 2);
+
+                    __m128 vx20_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r - 1);
+                    __m128 vx21_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 0);
+                    __m128 vx22_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 1);
+                    __m128 vx23_ = _mm_load_ss(in_ptr + (iy_r + 1) * iw + ix_r + 2);
+
+                    __m256 vx00 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx00_), vx01_, 1);
+                    __m256 vx01 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx01_), vx02_, 1);
+                    __m256 vx02 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx02_), vx03_, 1);
+
+                    __m256 vx10 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx10_), vx11_, 1);
+                    __m256 vx11 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx11_), vx12_, 1);
+                    __m256 vx12 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx12_), vx13_, 1);
+
+                    __m256 vx20 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx20_), vx21_, 1);
+                    __m256 vx21 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx21_), vx22_, 1);
+                    __m256 vx22 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx22_), vx23_, 1);
+
+                    for (size_t i = 0; i < 4; i++) {
+                        __m256 vc0 = _mm256_loadu_ps(table_avx2[i] + 0);
+                        __m256 vc1 = _mm256_loadu_ps(table_avx2[i] + 8);
+                        __m256 vc2 = _mm256_loadu_ps(table_avx2[i] + 16);
+                        __m256 vc3 = _mm256_loadu_ps(table_avx2[i] + 24);
+
+                        if (ox == 0) {
+                            vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc0, 0), 0xD0), 0);
+                            vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc2, 0), 0xD0), 0);
+                        } else if (ox == ow - 8) {
+                            vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm256_extractf128_ps(vc0, 1), _mm_setzero_ps(), 0x07), 1);
+                            vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm256_extractf128_ps(vc2, 1), _mm_setzero_ps(), 0x07), 1);
+                        }
 
-                            __m256 res = _mm256_setzero_ps();
+                        __m256 vsrc0 = i < 2 ? _mm256_shuffle_ps(vx00, vx02, 0x0) : _mm256_shuffle_ps(vx10, vx12, 0x0);
+                        __m256 vsrc1 = i < 2 ? _mm256_shuffle_ps(vx01, vx01, 0x0) : _mm256_shuffle_ps(vx11, vx11, 0x0);
+                        __m256 vsrc2 = i < 2 ? _mm256_shuffle_ps(vx10, vx12, 0x0) : _mm256_shuffle_ps(vx20, vx22, 0x0);
+                        __m256 vsrc3 = i < 2 ? _mm256_shuffle_ps(vx11, vx11, 0x0) : _mm256_shuffle_ps(vx21, vx21, 0x0);
 
-                            res = _mm256_fmadd_ps(vsrc0, vc0, res);
-                            res = _mm256_fmadd_ps(vsrc1, vc1, res);
-                            res = _mm256_fmadd_ps(vsrc2, vc2, res);
-                            res = _mm256_fmadd_ps(vsrc3, vc3, res);
+                        __m256 res = _mm256_setzero_ps();
 
-                            if (ox == 0 || ox == ow - 8) {
-                                __m256 wei = _mm256_add_ps(_mm256_add_ps(vc0, vc1), _mm256_add_ps(vc2, vc3));
+                        res = _mm256_fmadd_ps(vsrc0, vc0, res);
+                        res = _mm256_fmadd_ps(vsrc1, vc1, res);
+                        res = _mm256_fmadd_ps(vsrc2, vc2, res);
+                        res = _mm256_fmadd_ps(vsrc3, vc3, res);
 
-                                res = _mm256_div_ps(res, wei);
-                            }
+                        if (ox == 0 || ox == ow - 8) {
+                            __m256 wei = _mm256_add_ps(_mm256_add_ps(vc0, vc1), _mm256_add_ps(vc2, vc3));
 
-                            _mm256_storeu_ps(out_ptr + (oy + i) * ow + ox, res);
+                            res = _mm256_div_ps(res, wei);
                         }
+
+                        _mm256_storeu_ps(out_ptr + (oy + i) * ow + ox, res);
                     }
+                }
         #endif
 
         #if defined(HAVE_SSE) || defined(HAVE_AVX2)
-                    for (; ox <= ow - 4; ox += 4) {
-                        float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
-                        size_t ix_r = static_cast<size_t>(round(ix));
-
-                        __m128 vx00 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r-1);
-                        __m128 vx01 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+0);
-                        __m128 vx02 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+1);
-
-                        __m128 vx10 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r-1);
-                        __m128 vx11 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+0);
-                        __m128 vx12 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+1);
-
-                        __m128 vx20 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r-1);
-                        __m128 vx21 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+0);
-                        __m128 vx22 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+1);
-
-                        for (size_t i = 0; i < 4; i++) {
-                            __m128 vc0 = _mm_loadu_ps(table_sse[i] +  0);
-                            __m128 vc1 = _mm_loadu_ps(table_sse[i] +  4);
-                            __m128 vc2 = _mm_loadu_ps(table_sse[i] +  8);
-                            __m128 vc3 = _mm_loadu_ps(table_sse[i] + 12);
-
-                            if (ox == 0) {
-                                vc0 = _mm_shuffle_ps(_mm_setzero_ps(), vc0, 0xD0);
-                                vc2 = _mm_shuffle_ps(_mm_setzero_ps(), vc2, 0xD0);
-                            } else if (ox == ow - 4) {
-                                vc0 = _mm_shuffle_ps(vc0, _mm_setzero_ps() , 0x07);
-                                vc2 = _mm_shuffle_ps(vc2, _mm_setzero_ps() , 0x07);
-                            }
-
-                            __m128 vsrc0 = i < 2 ? _mm_shuffle_ps(vx00, vx02, 0x0) : _mm_shuffle_ps(vx10, vx12, 0x0);
-                            __m128 vsrc1 = i < 2 ? _mm_shuffle_ps(vx01, vx01, 0x0) : _mm_shuffle_ps(vx11, vx11, 0x0);
-                            __m128 vsrc2 = i < 2 ? _mm_shuffle_ps(vx10, vx12, 0x0) : _mm_shuffle_ps(vx20, vx22, 0x0);
-                            __m128 vsrc3 = i < 2 ? _mm_shuffle_ps(vx11, vx11, 0x0) : _mm_shuffle_ps(vx21, vx21, 0x0);
+                for (; ox <= ow - 4; ox += 4) {
+                    float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
+                    size_t ix_r = static_cast<size_t>(round(ix));
+
+                    __m128 vx00 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r-1);
+                    __m128 vx01 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+0);
+                    __m128 vx02 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+1);
+
+                    __m128 vx10 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r-1);
+                    __m128 vx11 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+0);
+                    __m128 vx12 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+1);
+
+                    __m128 vx20 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r-1);
+                    __m128 vx21 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+0);
+                    __m128 vx22 = _mm_load_ss(in_ptr+(iy_r+1)*iw+ix_r+1);
+
+                    for (size_t i = 0; i < 4; i++) {
+                        __m128 vc0 = _mm_loadu_ps(table_sse[i] +  0);
+                        __m128 vc1 = _mm_loadu_ps(table_sse[i] +  4);
+                        __m128 vc2 = _mm_loadu_ps(table_sse[i] +  8);
+                        __m128 vc3 = _mm_loadu_ps(table_sse[i] + 12);
+
+                        if (ox == 0) {
+                            vc0 = _mm_shuffle_ps(_mm_setzero_ps(), vc0, 0xD0);
+                            vc2 = _mm_shuffle_ps(_mm_setzero_ps(), vc2, 0xD0);
+                        } else if (ox == ow - 4) {
+                            vc0 = _mm_shuffle_ps(vc0, _mm_setzero_ps() , 0x07);
+                            vc2 = _mm_shuffle_ps(vc2, _mm_setzero_ps() , 0x07);
+                        }
 
-                            __m128 vres0 = _mm_mul_ps(vsrc0, vc0);
-                            __m128 vres1 = _mm_mul_ps(vsrc1, vc1);
-                            __m128 vres2 = _mm_mul_ps(vsrc2, vc2);
-                            __m128 vres3 = _mm_mul_ps(vsrc3, vc3);
+                        __m128 vsrc0 = i < 2 ? _mm_shuffle_ps(vx00, vx02, 0x0) : _mm_shuffle_ps(vx10, vx12, 0x0);
+                        __m128 vsrc1 = i < 2 ? _mm_shuffle_ps(vx01, vx01, 0x0) : _mm_shuffle_ps(vx11, vx11, 0x0);
+                        __m128 vsrc2 = i < 2 ? _mm_shuffle_ps(vx10, vx12, 0x0) : _mm_shuffle_ps(vx20, vx22, 0x0);
+                        __m128 vsrc3 = i < 2 ? _mm_shuffle_ps(vx11, vx11, 0x0) : _mm_shuffle_ps(vx21, vx21, 0x0);
 
-                            __m128 res = _mm_add_ps(_mm_add_ps(vres0, vres1), _mm_add_ps(vres2, vres3));
-                            if (ox == 0 || ox == ow - 4) {
-                                __m128 wei = _mm_add_ps(_mm_add_ps(vc0, vc1), _mm_add_ps(vc2, vc3));
+                        __m128 vres0 = _mm_mul_ps(vsrc0, vc0);
+                        __m128 vres1 = _mm_mul_ps(vsrc1, vc1);
+                        __m128 vres2 = _mm_mul_ps(vsrc2, vc2);
+                        __m128 vres3 = _mm_mul_ps(vsrc3, vc3);
 
-                                res = _mm_div_ps(res, wei);
-                            }
+                        __m128 res = _mm_add_ps(_mm_add_ps(vres0, vres1), _mm_add_ps(vres2, vres3));
+                        if (ox == 0 || ox == ow - 4) {
+                            __m128 wei = _mm_add_ps(_mm_add_ps(vc0, vc1), _mm_add_ps(vc2, vc3));
 
-                            _mm_storeu_ps(out_ptr + (oy+i)*ow + ox, res);
+                            res = _mm_div_ps(res, wei);
                         }
+
+                        _mm_storeu_ps(out_ptr + (oy+i)*ow + ox, res);
                     }
-        #endif
                 }
+        #endif
+            }
 
-                oy = oh - 4;
-                {
-                    float iy = oy * fy + fx / 2.0f - 0.5f;
-                    size_t iy_r = static_cast<size_t>(round(iy));
+            oy = oh - 4;
+            {
+                float iy = oy * fy + fx / 2.0f - 0.5f;
+                size_t iy_r = static_cast<size_t>(round(iy));
 
-                    size_t ox = 0;
+                size_t ox = 0;
 
         #if defined(HAVE_AVX2)
-                    for (; ox <= ow - 8; ox += 8) {
-                        float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
-                        size_t ix_r = static_cast<size_t>(round(ix));
-
-                        __m128 vx00_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r - 1);
-                        __m128 vx01_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 0);
-                        __m128 vx02_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 1);
-                        __m128 vx03_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 2);
-
-                        __m128 vx10_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r - 1);
-                        __m128 vx11_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 0);
-                        __m128 vx12_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 1);
-                        __m128 vx13_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 2);
-
-                        __m256 vx00 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx00_), vx01_, 1);
-                        __m256 vx01 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx01_), vx02_, 1);
-                        __m256 vx02 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx02_), vx03_, 1);
-
-                        __m256 vx10 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx10_), vx11_, 1);
-                        __m256 vx11 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx11_), vx12_, 1);
-                        __m256 vx12 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx12_), vx13_, 1);
-
-                        __m256 vx20 = _mm256_setzero_ps();
-                        __m256 vx21 = _mm256_setzero_ps();
-                        __m256 vx22 = _mm256_setzero_ps();
-
-                        for (size_t i = 0; i < 4; i++) {
-                            __m256 vc0 = _mm256_loadu_ps(table_avx2[i] + 0);
-                            __m256 vc1 = _mm256_loadu_ps(table_avx2[i] + 8);
-                            __m256 vc2 = i < 2 ? _mm256_loadu_ps(table_avx2[i] + 16) : _mm256_setzero_ps();
-                            __m256 vc3 = i < 2 ? _mm256_loadu_ps(table_avx2[i] + 24) : _mm256_setzero_ps();
-
-                            if (ox == 0) {
-                                vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc0, 0), 0xD0), 0);
-                                if (i < 2)
-                                    vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc2, 0), 0xD0), 0);
-                            } else if (ox == ow - 8) {
-                                vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm256_extractf128_ps(vc0, 1), _mm_setzero_ps(), 0x07), 1);
-                                if (i < 2)
-                                    vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm256_extractf128_ps(vc2, 1), _mm_setzero_ps(), 0x07), 1);
-                            }
+                for (; ox <= ow - 8; ox += 8) {
+                    float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
+                    size_t ix_r = static_cast<size_t>(round(ix));
+
+                    __m128 vx00_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r - 1);
+                    __m128 vx01_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 0);
+                    __m128 vx02_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 1);
+                    __m128 vx03_ = _mm_load_ss(in_ptr + (iy_r - 1) * iw + ix_r + 2);
+
+                    __m128 vx10_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r - 1);
+                    __m128 vx11_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 0);
+                    __m128 vx12_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 1);
+                    __m128 vx13_ = _mm_load_ss(in_ptr + (iy_r + 0) * iw + ix_r + 2);
+
+                    __m256 vx00 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx00_), vx01_, 1);
+                    __m256 vx01 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx01_), vx02_, 1);
+                    __m256 vx02 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx02_), vx03_, 1);
+
+                    __m256 vx10 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx10_), vx11_, 1);
+                    __m256 vx11 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx11_), vx12_, 1);
+                    __m256 vx12 = _mm256_insertf128_ps(_mm256_castps128_ps256(vx12_), vx13_, 1);
+
+                    __m256 vx20 = _mm256_setzero_ps();
+                    __m256 vx21 = _mm256_setzero_ps();
+                    __m256 vx22 = _mm256_setzero_ps();
+
+                    for (size_t i = 0; i < 4; i++) {
+                        __m256 vc0 = _mm256_loadu_ps(table_avx2[i] + 0);
+                        __m256 vc1 = _mm256_loadu_ps(table_avx2[i] + 8);
+                        __m256 vc2 = i < 2 ? _mm256_loadu_ps(table_avx2[i] + 16) : _mm256_setzero_ps();
+                        __m256 vc3 = i < 2 ? _mm256_loadu_ps(table_avx2[i] + 24) : _mm256_setzero_ps();
+
+                        if (ox == 0) {
+                            vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc0, 0), 0xD0), 0);
+                            if (i < 2)
+                                vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm_setzero_ps(), _mm256_extractf128_ps(vc2, 0), 0xD0), 0);
+                        } else if (ox == ow - 8) {
+                            vc0 = _mm256_insertf128_ps(vc0, _mm_shuffle_ps(_mm256_extractf128_ps(vc0, 1), _mm_setzero_ps(), 0x07), 1);
+                            if (i < 2)
+                                vc2 = _mm256_insertf128_ps(vc2, _mm_shuffle_ps(_mm256_extractf128_ps(vc2, 1), _mm_setzero_ps(), 0x07), 1);
+                        }
 
-                            __m256 vsrc0 = i < 2 ? _mm256_shuffle_ps(vx00, vx02, 0x0) : _mm256_shuffle_ps(vx10, vx12, 0x0);
-                            __m256 vsrc1 = i < 2 ? _mm256_shuffle_ps(vx01, vx01, 0x0) : _mm256_shuffle_ps(vx11, vx11, 0x0);
-                            __m256 vsrc2 = i < 2 ? _mm256_shuffle_ps(vx10, vx12, 0x0) : _mm256_shuffle_ps(vx20, vx22, 0x0);
-                            __m256 vsrc3 = i < 2 ? _mm256_shuffle_ps(vx11, vx11, 0x0) : _mm256_shuffle_ps(vx21, vx21, 0x0);
+                        __m256 vsrc0 = i < 2 ? _mm256_shuffle_ps(vx00, vx02, 0x0) : _mm256_shuffle_ps(vx10, vx12, 0x0);
+                        __m256 vsrc1 = i < 2 ? _mm256_shuffle_ps(vx01, vx01, 0x0) : _mm256_shuffle_ps(vx11, vx11, 0x0);
+                        __m256 vsrc2 = i < 2 ? _mm256_shuffle_ps(vx10, vx12, 0x0) : _mm256_shuffle_ps(vx20, vx22, 0x0);
+                        __m256 vsrc3 = i < 2 ? _mm256_shuffle_ps(vx11, vx11, 0x0) : _mm256_shuffle_ps(vx21, vx21, 0x0);
 
-                            __m256 res = _mm256_setzero_ps();
+                        __m256 res = _mm256_setzero_ps();
 
-                            res = _mm256_fmadd_ps(vsrc0, vc0, res);
-                            res = _mm256_fmadd_ps(vsrc1, vc1, res);
-                            res = _mm256_fmadd_ps(vsrc2, vc2, res);
-                            res = _mm256_fmadd_ps(vsrc3, vc3, res);
+                        res = _mm256_fmadd_ps(vsrc0, vc0, res);
+                        res = _mm256_fmadd_ps(vsrc1, vc1, res);
+                        res = _mm256_fmadd_ps(vsrc2, vc2, res);
+                        res = _mm256_fmadd_ps(vsrc3, vc3, res);
 
-                            __m256 wei = _mm256_add_ps(_mm256_add_ps(vc0, vc1), _mm256_add_ps(vc2, vc3));
+                        __m256 wei = _mm256_add_ps(_mm256_add_ps(vc0, vc1), _mm256_add_ps(vc2, vc3));
 
-                            res = _mm256_div_ps(res, wei);
+                        res = _mm256_div_ps(res, wei);
 
-                            _mm256_storeu_ps(out_ptr + (oy + i) * ow + ox, res);
-                        }
+                        _mm256_storeu_ps(out_ptr + (oy + i) * ow + ox, res);
                     }
+                }
         #endif
 
         #if defined(HAVE_SSE) || defined(HAVE_AVX2)
-                    for (; ox <= ow - 4; ox += 4) {
-                        float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
-                        size_t ix_r = static_cast<size_t>(round(ix));
-
-                        __m128 vx00 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r-1);
-                        __m128 vx01 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+0);
-                        __m128 vx02 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+1);
-
-                        __m128 vx10 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r-1);
-                        __m128 vx11 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+0);
-                        __m128 vx12 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+1);
-
-                        __m128 vx20 = _mm_setzero_ps();
-                        __m128 vx21 = _mm_setzero_ps();
-                        __m128 vx22 = _mm_setzero_ps();
-
-                        for (size_t i = 0; i < 4; i++) {
-                            __m128 vc0 = _mm_loadu_ps(table_sse[i] +  0);
-                            __m128 vc1 = _mm_loadu_ps(table_sse[i] +  4);
-                            __m128 vc2 = i < 2 ?_mm_loadu_ps(table_sse[i] +  8) : _mm_setzero_ps();
-                            __m128 vc3 = i < 2 ?_mm_loadu_ps(table_sse[i] + 12) : _mm_setzero_ps();
-
-                            if (ox == 0) {
-                                vc0 = _mm_shuffle_ps(_mm_setzero_ps(), vc0, 0xD0);
-                                if (i < 2)
-                                    vc2 = _mm_shuffle_ps(_mm_setzero_ps(), vc2, 0xD0);
-                            } else if (ox == ow - 4) {
-                                vc0 = _mm_shuffle_ps(vc0, _mm_setzero_ps() , 0x07);
-                                if (i < 2)
-                                    vc2 = _mm_shuffle_ps(vc2, _mm_setzero_ps() , 0x07);
-                            }
+                for (; ox <= ow - 4; ox += 4) {
+                    float ix = (ox + 0) * fx + fy / 2.0f - 0.5f;
+                    size_t ix_r = static_cast<size_t>(round(ix));
+
+                    __m128 vx00 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r-1);
+                    __m128 vx01 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+0);
+                    __m128 vx02 = _mm_load_ss(in_ptr+(iy_r-1)*iw+ix_r+1);
+
+                    __m128 vx10 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r-1);
+                    __m128 vx11 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+0);
+                    __m128 vx12 = _mm_load_ss(in_ptr+(iy_r+0)*iw+ix_r+1);
+
+                    __m128 vx20 = _mm_setzero_ps();
+                    __m128 vx21 = _mm_setzero_ps();
+                    __m128 vx22 = _mm_setzero_ps();
+
+                    for (size_t i = 0; i < 4; i++) {
+                        __m128 vc0 = _mm_loadu_ps(table_sse[i] +  0);
+                        __m128 vc1 = _mm_loadu_ps(table_sse[i] +  4);
+                        __m128 vc2 = i < 2 ?_mm_loadu_ps(table_sse[i] +  8) : _mm_setzero_ps();
+                        __m128 vc3 = i < 2 ?_mm_loadu_ps(table_sse[i] + 12) : _mm_setzero_ps();
+
+                        if (ox == 0) {
+                            vc0 = _mm_shuffle_ps(_mm_setzero_ps(), vc0, 0xD0);
+                            if (i < 2)
+                                vc2 = _mm_shuffle_ps(_mm_setzero_ps(), vc2, 0xD0);
+                        } else if (ox == ow - 4) {
+                            vc0 = _mm_shuffle_ps(vc0, _mm_setzero_ps() , 0x07);
+                            if (i < 2)
+                                vc2 = _mm_shuffle_ps(vc2, _mm_setzero_ps() , 0x07);
+                        }
 
-                            __m128 vsrc0 = i < 2 ? _mm_shuffle_ps(vx00, vx02, 0x0) : _mm_shuffle_ps(vx10, vx12, 0x0);
-                            __m128 vsrc1 = i < 2 ? _mm_shuffle_ps(vx01, vx01, 0x0) : _mm_shuffle_ps(vx11, vx11, 0x0);
-                            __m128 vsrc2 = i < 2 ? _mm_shuffle_ps(vx10, vx12, 0x0) : _mm_shuffle_ps(vx20, vx22, 0x0);
-                            __m128 vsrc3 = i < 2 ? _mm_shuffle_ps(vx11, vx11, 0x0) : _mm_shuffle_ps(vx21, vx21, 0x0);
+                        __m128 vsrc0 = i < 2 ? _mm_shuffle_ps(vx00, vx02, 0x0) : _mm_shuffle_ps(vx10, vx12, 0x0);
+                        __m128 vsrc1 = i < 2 ? _mm_shuffle_ps(vx01, vx01, 0x0) : _mm_shuffle_ps(vx11, vx11, 0x0);
+                        __m128 vsrc2 = i < 2 ? _mm_shuffle_ps(vx10, vx12, 0x0) : _mm_shuffle_ps(vx20, vx22, 0x0);
+                        __m128 vsrc3 = i < 2 ? _mm_shuffle_ps(vx11, vx11, 0x0) : _mm_shuffle_ps(vx21, vx21, 0x0);
 
-                            __m128 vres0 = _mm_mul_ps(vsrc0, vc0);
-                            __m128 vres1 = _mm_mul_ps(vsrc1, vc1);
-                            __m128 vres2 = _mm_mul_ps(vsrc2, vc2);
-                            __m128 vres3 = _mm_mul_ps(vsrc3, vc3);
+                        __m128 vres0 = _mm_mul_ps(vsrc0, vc0);
+                        __m128 vres1 = _mm_mul_ps(vsrc1, vc1);
+                        __m128 vres2 = _mm_mul_ps(vsrc2, vc2);
+                        __m128 vres3 = _mm_mul_ps(vsrc3, vc3);
 
-                            __m128 res = _mm_add_ps(_mm_add_ps(vres0, vres1), _mm_add_ps(vres2, vres3));
-                            __m128 wei = _mm_add_ps(_mm_add_ps(vc0, vc1), _mm_add_ps(vc2, vc3));
+                        __m128 res = _mm_add_ps(_mm_add_ps(vres0, vres1), _mm_add_ps(vres2, vres3));
+                        __m128 wei = _mm_add_ps(_mm_add_ps(vc0, vc1), _mm_add_ps(vc2, vc3));
 
-                            res = _mm_div_ps(res, wei);
+                        res = _mm_div_ps(res, wei);
 
-                            _mm_storeu_ps(out_ptr + (oy+i)*ow + ox, res);
-                        }
+                        _mm_storeu_ps(out_ptr + (oy+i)*ow + ox, res);
                     }
-        #endif
                 }
+        #endif
             }
-        }
+        });
     }
 #endif  // defined(HAVE_SSE) || defined(HAVE_AVX2)
 };
 
 REG_FACTORY_FOR(ImplFactory<ResampleImpl>, Resample);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
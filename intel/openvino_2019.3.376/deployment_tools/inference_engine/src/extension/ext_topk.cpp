@@ -5,6 +5,7 @@
 #include "ext_list.hpp"
 #include "ext_base.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <cfloat>
@@ -12,6 +13,7 @@
 #include <vector>
 #include <cassert>
 #include <functional>
+#include <utility>
 #include "ie_parallel.hpp"
 #if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
 #include <immintrin.h>
@@ -20,6 +22,7 @@
 namespace InferenceEngine {
 namespace Extensions {
 namespace Cpu {
+CPU_EXT_ISA_NAMESPACE_BEGIN
 
 class TopKImpl: public ExtLayerBase {
 public:
@@ -224,6 +227,104 @@ public:
         });
     }
 
+    //  Order of the selected elements: the better value first and the lower index among equal values.
+    //  NaN goes after every number, which keeps the order strict for the std algorithms below.
+    template <template <typename> class Compare>
+    static inline bool is_better(const std::pair<float, int>& l, const std::pair<float, int>& r) {
+        if (Compare<float>()(l.first, r.first))
+            return true;
+        if (Compare<float>()(r.first, l.first))
+            return false;
+        bool l_nan = std::isnan(l.first);
+        bool r_nan = std::isnan(r.first);
+        if (l_nan != r_nan)
+            return r_nan;
+        return l.second < r.second;
+    }
+
+    //  Puts value on top of a heap whose top is its worst element and sifts it down
+    template <template <typename> class Compare>
+    static void heap_replace_top(std::pair<float, int>* heap, int size, const std::pair<float, int>& value) {
+        int pos = 0;
+        int child = 1;
+        while (child < size) {
+            if (child + 1 < size && is_better<Compare>(heap[child], heap[child + 1]))
+                child++;
+            if (!is_better<Compare>(value, heap[child]))
+                break;
+            heap[pos] = heap[child];
+            pos = child;
+            child = 2 * pos + 1;
+        }
+        heap[pos] = value;
+    }
+
+    //  Selects src_k of the dim contiguous values in src and stores them with the given stride.
+    //  While k is a small share of dim the best k are kept in a heap and every value is first
+    //  compared with the worst of them, a vector at a time, so most values never reach the heap.
+    //  Otherwise introselect over all values is cheaper. buffer must hold dim elements.
+    template <class Compare1, template <typename> class Compare2>
+    void topk_slice(const float* src, std::vector<std::pair<float, int>>& buffer,
+                    float* dst_data, int* dst_idx, int dst_stride) {
+        auto better = [](const std::pair<float, int>& l, const std::pair<float, int>& r) {
+            return is_better<Compare2>(l, r);
+        };
+
+        if (src_k * introselect_ratio >= dim) {
+            for (int i = 0; i < dim; i++)
+                buffer[i] = std::make_pair(src[i], i);
+            std::nth_element(buffer.begin(), buffer.begin() + (src_k - 1), buffer.begin() + dim, better);
+            if (sort_value)
+                std::sort(buffer.begin(), buffer.begin() + src_k, better);
+        } else {
+            for (int i = 0; i < src_k; i++)
+                buffer[i] = std::make_pair(src[i], i);
+            std::make_heap(buffer.begin(), buffer.begin() + src_k, better);
+
+            int i = src_k;
+#if defined(HAVE_SSE) || defined(HAVE_AVX2) || defined(HAVE_AVX512F)
+            for (; i + block_size <= dim; i += block_size) {
+                //  a NaN on top would compare false with everything, leave it to the scalar loop
+                if (std::isnan(buffer[0].first))
+                    break;
+                vmask_type vmask = Compare1::cmp_ps(_mm_uni_loadu_ps(src + i), _mm_uni_set1_ps(buffer[0].first));
+#if defined(HAVE_AVX512F)
+                if (!vmask)
+                    continue;
+#else
+                if (!_mm_uni_movemask_ps(vmask))
+                    continue;
+#endif
+                for (int j = i; j < i + block_size; j++) {
+                    std::pair<float, int> value(src[j], j);
+                    if (is_better<Compare2>(value, buffer[0]))
+                        heap_replace_top<Compare2>(buffer.data(), src_k, value);
+                }
+            }
+#endif
+            for (; i < dim; i++) {
+                std::pair<float, int> value(src[i], i);
+                if (is_better<Compare2>(value, buffer[0]))
+                    heap_replace_top<Compare2>(buffer.data(), src_k, value);
+            }
+            if (sort_value)
+                std::sort_heap(buffer.begin(), buffer.begin() + src_k, better);
+        }
+
+        if (!sort_value) {
+            std::sort(buffer.begin(), buffer.begin() + src_k,
+                      [](const std::pair<float, int>& l, const std::pair<float, int>& r) { return l.second < r.second; });
+        }
+        if (dst_data) {
+            for (int i = 0; i < src_k; i++)
+                dst_data[i * dst_stride] = buffer[i].first;
+        }
+        if (dst_idx) {
+            for (int i = 0; i < src_k; i++)
+                dst_idx[i * dst_stride] = buffer[i].second;
+        }
+    }
+
     template <class Compare1, template <typename> class Compare2>
     void topk_axis(const float* src_data, float* dst_data, int* dst_idx, SizeVector in_dims) {
         int after_num = count(in_dims, axis + 1, in_dims.size());
@@ -331,124 +432,41 @@ public:
         }
 #endif
         int rest = after_num - first_index;
-        parallel_for2d(before_num, rest, [&](int i0, int i1) {
-            std::vector<float> max_values(src_k + 1);
-            std::vector<int> max_indexes(src_k + 1);
-            float tmp_value;
-            int tmp_index;
-            int s_index = i0 * dim * after_num + first_index + i1;
-
-            auto swap_func = [&](int index1, int index2) {
-                tmp_value = max_values[index1];
-                max_values[index1] = max_values[index2];
-                max_values[index2] = tmp_value;
-
-                tmp_index = max_indexes[index1];
-                max_indexes[index1] = max_indexes[index2];
-                max_indexes[index2] = tmp_index;
-            };
-
-            for (int i2 = 0; i2 < src_k; i2++) {
-                max_values[i2] = src_data[s_index];
-                max_indexes[i2] = i2;
-                s_index += after_num;
-            }
-            for (int i2 = 0; i2 < src_k - 1; i2++) {
-                for (int i3 = src_k - 1; i3 > i2; i3--) {
-                    if (Compare2<float>()(max_values[i3], max_values[i3 - 1])) {
-                        swap_func(i3, i3 - 1);
-                    }
-                }
-            }
-            for (int i2 = src_k; i2 < dim; i2++) {
-                max_values[src_k] = src_data[s_index];
-                max_indexes[src_k] = i2;
-                for (int i3 = src_k; i3 > 0; i3--) {
-                    if (Compare2<float>()(max_values[i3], max_values[i3 - 1]))
-                        swap_func(i3, i3 - 1);
-                    else
-                        break;
-                }
-                s_index += after_num;
-            }
-            if (!sort_value) {
-                for (int i2 = 0; i2 < src_k - 1; i2++) {
-                    for (int i3 = src_k - 1; i3 > i2; i3--) {
-                        if (std::greater<int>()(max_indexes[i3 - 1], max_indexes[i3])) {
-                            swap_func(i3, i3 - 1);
-                        }
-                    }
+        parallel_nt(0, [&](const int ithr, const int nthr) {
+            int start = 0, end = 0;
+            splitter(before_num * rest, nthr, ithr, start, end);
+            if (start >= end)
+                return;
+
+            std::vector<float> column(dim);
+            std::vector<std::pair<float, int>> buffer(dim);
+            for (int iwork = start; iwork < end; iwork++) {
+                int i0 = iwork / rest;
+                int i1 = iwork % rest;
+                int s_index = i0 * dim * after_num + first_index + i1;
+                for (int i2 = 0; i2 < dim; i2++) {
+                    column[i2] = src_data[s_index];
+                    s_index += after_num;
                 }
-            }
-            if (dst_data) {
-                for (int i2 = 0; i2 < src_k; i2++)
-                    dst_data[i0 * src_k * after_num + i2 * after_num + first_index + i1] = max_values[i2];
-            }
-            if (dst_idx) {
-                for (int i2 = 0; i2 < src_k; i2++)
-                    dst_idx[i0 * src_k * after_num + i2 * after_num + first_index + i1] = max_indexes[i2];
+                int d_index = i0 * src_k * after_num + first_index + i1;
+                topk_slice<Compare1, Compare2>(column.data(), buffer, dst_data ? dst_data + d_index : nullptr,
+                                               dst_idx ? dst_idx + d_index : nullptr, after_num);
             }
         });
     }
 
-    template <template <typename> class Compare>
+    template <class Compare1, template <typename> class Compare2>
     void topk(const float* src_data, float* dst_data, int* dst_idx, SizeVector in_dims) {
-        parallel_for(before_num, [&](int i0) {
-            std::vector<float> max_values(src_k + 1);
-            std::vector<int> max_indexes(src_k + 1);
-            float tmp_value;
-            int tmp_index;
-            int s_index = i0 * dim;
-
-            auto swap_func = [&](int index1, int index2) {
-                tmp_value = max_values[index1];
-                max_values[index1] = max_values[index2];
-                max_values[index2] = tmp_value;
-
-                tmp_index = max_indexes[index1];
-                max_indexes[index1] = max_indexes[index2];
-                max_indexes[index2] = tmp_index;
-            };
-
-            for (int i2 = 0; i2 < src_k; i2++) {
-                max_values[i2] = src_data[s_index];
-                max_indexes[i2] = i2;
-                s_index++;
-            }
-            for (int i2 = 0; i2 < src_k - 1; i2++) {
-                for (int i3 = src_k - 1; i3 > i2; i3--) {
-                    if (Compare<float>()(max_values[i3], max_values[i3 - 1])) {
-                        swap_func(i3, i3 - 1);
-                    }
-                }
-            }
-            for (int i2 = src_k; i2 < dim; i2++) {
-                max_values[src_k] = src_data[s_index];
-                max_indexes[src_k] = i2;
-                for (int i3 = src_k; i3 > 0; i3--) {
-                    if (Compare<float>()(max_values[i3], max_values[i3 - 1]))
-                        swap_func(i3, i3 - 1);
-                    else
-                        break;
-                }
-                s_index++;
-            }
-            if (!sort_value) {
-                for (int i2 = 0; i2 < src_k - 1; i2++) {
-                    for (int i3 = src_k - 1; i3 > i2; i3--) {
-                        if (std::greater<int>()(max_indexes[i3 - 1], max_indexes[i3])) {
-                            swap_func(i3, i3 - 1);
-                        }
-                    }
-                }
-            }
-            if (dst_data) {
-                for (int i2 = 0; i2 < src_k; i2++)
-                    dst_data[i0 * src_k + i2] = max_values[i2];
-            }
-            if (dst_idx) {
-                for (int i2 = 0; i2 < src_k; i2++)
-                    dst_idx[i0 * src_k + i2] = max_indexes[i2];
+        parallel_nt(0, [&](const int ithr, const int nthr) {
+            int start = 0, end = 0;
+            splitter(before_num, nthr, ithr, start, end);
+            if (start >= end)
+                return;
+
+            std::vector<std::pair<float, int>> buffer(dim);
+            for (int i0 = start; i0 < end; i0++) {
+                topk_slice<Compare1, Compare2>(src_data + i0 * dim, buffer, dst_data ? dst_data + i0 * src_k : nullptr,
+                                               dst_idx ? dst_idx + i0 * src_k : nullptr, 1);
             }
         });
     }
@@ -522,9 +540,9 @@ public:
         } else {
             if (is_last_dim) {
                 if (mode_max)
-                    topk<std::greater>(src, dst_data, dst_idx, in_dims);
+                    topk<cmpgt_ps, std::greater>(src, dst_data, dst_idx, in_dims);
                 else
-                    topk<std::less>(src, dst_data, dst_idx, in_dims);
+                    topk<cmplt_ps, std::less>(src, dst_data, dst_idx, in_dims);
             } else {
                 if (mode_max)
                     topk_axis<cmpgt_ps, std::greater>(src, dst_data, dst_idx, in_dims);
@@ -560,6 +578,8 @@ private:
 #elif defined(HAVE_SSE) || defined(HAVE_AVX2)
     const int count_vec = 16;
 #endif
+    //  introselect is used once k is at least dim / introselect_ratio
+    const int introselect_ratio = 4;
 
     inline int count(SizeVector dims, size_t start_ind, size_t end_ind) {
         size_t count = 1;
@@ -575,6 +595,7 @@ private:
 
 REG_FACTORY_FOR(ImplFactory<TopKImpl>, TopK);
 
+CPU_EXT_ISA_NAMESPACE_END
 }  // namespace Cpu
 }  // namespace Extensions
 }  // namespace InferenceEngine
@@ -0,0 +1,201 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+/**
+ * @brief Bounded lock-free queues for passing frames and infer requests between demo threads
+ * @file lock_free_queue.hpp
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace lock_free_queue_details {
+static constexpr size_t cacheLineSize = 64;
+
+inline size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+}  // namespace lock_free_queue_details
+
+/**
+ * @brief Single-producer single-consumer ring buffer.
+ * One thread (or threads serialized by a lock) may push and one may pop at the same time.
+ * Popped slots are reset to T(), so a queue of cv::Mat or shared_ptr does not keep the data alive.
+ */
+template <typename T>
+class SPSCQueue {
+public:
+    explicit SPSCQueue(size_t capacity):
+        mask{lock_free_queue_details::roundUpToPowerOfTwo(capacity) - 1},
+        buffer{new T[mask + 1]} {}
+
+    SPSCQueue(const SPSCQueue&) = delete;
+    SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+    /// Returns false if the queue is full
+    bool push(T value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) {
+            return false;
+        }
+        buffer[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns false if the queue is empty
+    bool pop(T& value) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = std::move(buffer[h & mask]);
+        buffer[h & mask] = T();
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Exact only when neither side is running
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    const size_t mask;
+    std::unique_ptr<T[]> buffer;
+    // padding instead of alignas keeps both counters on their own cache lines without over-aligned new
+    char padding0[lock_free_queue_details::cacheLineSize];
+    std::atomic<size_t> head = {0};
+    char padding1[lock_free_queue_details::cacheLineSize];
+    std::atomic<size_t> tail = {0};
+    char padding2[lock_free_queue_details::cacheLineSize];
+};
+
+/**
+ * @brief Multi-producer multi-consumer ring buffer (per-cell sequence numbers, D. Vyukov's scheme).
+ * Any number of threads may push and pop concurrently.
+ */
+template <typename T>
+class MPMCQueue {
+public:
+    explicit MPMCQueue(size_t capacity):
+        mask{lock_free_queue_details::roundUpToPowerOfTwo(capacity) - 1},
+        cells{new Cell[mask + 1]} {
+        for (size_t i = 0; i <= mask; i++) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    /// Returns false if the queue is full
+    bool push(T value) {
+        Cell* cell;
+        size_t pos = enqueuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (0 == diff) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->data = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Returns false if the queue is empty
+    bool pop(T& value) {
+        Cell* cell;
+        size_t pos = dequeuePos.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells[pos & mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (0 == diff) {
+                if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        value = std::move(cell->data);
+        cell->data = T();
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Exact only when no thread is pushing or popping
+    size_t size() const {
+        return enqueuePos.load(std::memory_order_acquire) - dequeuePos.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    const size_t mask;
+    std::unique_ptr<Cell[]> cells;
+    char padding0[lock_free_queue_details::cacheLineSize];
+    std::atomic<size_t> enqueuePos = {0};
+    char padding1[lock_free_queue_details::cacheLineSize];
+    std::atomic<size_t> dequeuePos = {0};
+    char padding2[lock_free_queue_details::cacheLineSize];
+};
+
+/**
+ * @brief Waiting strategy for the queues above: yields first, then sleeps,
+ * so an idle consumer does not burn a core the inference threads need.
+ */
+class Backoff {
+public:
+    void pause() {
+        if (count < yieldLimit) {
+            count++;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    }
+
+    void reset() {
+        count = 0;
+    }
+
+private:
+    static constexpr unsigned yieldLimit = 16;
+    unsigned count = 0;
+};
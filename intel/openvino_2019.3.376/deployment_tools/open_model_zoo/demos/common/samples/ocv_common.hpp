@@ -12,6 +12,47 @@
 #include <samples/common.hpp>
 #include <opencv2/opencv.hpp>
 
+/**
+* @brief Packs an interleaved 8-bit image into planar (CHW) memory.
+* Deinterleaving and U8 to T conversion are done by cv::split and cv::Mat::convertTo,
+* which run the SIMD kernels OpenCV dispatches for the current CPU.
+* @param image - given cv::Mat object with 1 or 3 channels of 8-bit data.
+* @param data - destination for image.channels() planes of image.rows x image.cols elements.
+*/
+template <typename T>
+void matU8ToPlanar(const cv::Mat& image, T* data) {
+    const int channels = image.channels();
+    if (image.depth() != CV_8U || (channels != 1 && channels != 3)) {
+        THROW_IE_EXCEPTION << "Unsupported number of channels";
+    }
+
+    const int planeType = CV_MAKETYPE(cv::DataType<T>::depth, 1);
+    const size_t planeSize = image.total();
+    cv::Mat planes[3];
+    for (int c = 0; c < channels; c++) {
+        planes[c] = cv::Mat(image.size(), planeType, data + c * planeSize);
+    }
+
+    if (planeType == CV_8UC1) {
+        if (channels == 1) {
+            image.copyTo(planes[0]);
+        } else {
+            cv::split(image, planes);
+        }
+    } else {
+        // deinterleave into reused U8 planes, then widen each plane straight into the destination
+        thread_local cv::Mat planesU8[3];
+        if (channels == 1) {
+            image.convertTo(planes[0], planeType);
+        } else {
+            cv::split(image, planesU8);
+            for (int c = 0; c < channels; c++) {
+                planesU8[c].convertTo(planes[c], planeType);
+            }
+        }
+    }
+}
+
 /**
 * @brief Sets image data stored in cv::Mat object to a given Blob object.
 * @param orig_image - given cv::Mat object with an image data.
@@ -24,33 +65,23 @@ void matU8ToBlob(const cv::Mat& orig_image, InferenceEngine::Blob::Ptr& blob, in
     const size_t width = blobSize[3];
     const size_t height = blobSize[2];
     const size_t channels = blobSize[1];
-    T* blob_data = blob->buffer().as<T*>();
-
-    cv::Mat resized_image(orig_image);
-    if (static_cast<int>(width) != orig_image.size().width ||
-            static_cast<int>(height) != orig_image.size().height) {
-        cv::resize(orig_image, resized_image, cv::Size(width, height));
+    if (static_cast<int>(channels) != orig_image.channels()) {
+        THROW_IE_EXCEPTION << "Unsupported number of channels";
     }
+    T* blob_data = blob->buffer().as<T*>() + batchIndex * width * height * channels;
 
-    int batchOffset = batchIndex * width * height * channels;
-
-    if (channels == 1) {
-        for (size_t  h = 0; h < height; h++) {
-            for (size_t w = 0; w < width; w++) {
-                blob_data[batchOffset + h * width + w] = resized_image.at<uchar>(h, w);
-            }
-        }
-    } else if (channels == 3) {
-        for (size_t c = 0; c < channels; c++) {
-            for (size_t  h = 0; h < height; h++) {
-                for (size_t w = 0; w < width; w++) {
-                    blob_data[batchOffset + c * width * height + h * width + w] =
-                            resized_image.at<cv::Vec3b>(h, w)[c];
-                }
-            }
-        }
+    const cv::Size size(static_cast<int>(width), static_cast<int>(height));
+    if (size == orig_image.size()) {
+        matU8ToPlanar(orig_image, blob_data);
+    } else if (channels == 1 && cv::DataType<T>::depth == CV_8U) {
+        // a single U8 plane is resized right into the blob
+        cv::Mat plane(size, CV_8UC1, blob_data);
+        cv::resize(orig_image, plane, size);
     } else {
-        THROW_IE_EXCEPTION << "Unsupported number of channels";
+        // the resize buffer is kept per thread, so no allocation happens for a steady input size
+        thread_local cv::Mat resized_image;
+        cv::resize(orig_image, resized_image, size);
+        matU8ToPlanar(resized_image, blob_data);
     }
 }
 
@@ -0,0 +1,605 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+/**
+* \brief The entry point for the Inference Engine crossroad_counting demo application
+* \file crossroad_counting_demo/main.cpp
+* \example crossroad_counting_demo/main.cpp
+*/
+#include <gflags/gflags.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <inference_engine.hpp>
+
+#include <samples/slog.hpp>
+#include <samples/ocv_common.hpp>
+#include <samples/args_helper.hpp>
+#include "crossroad_counting_demo.hpp"
+#ifdef WITH_EXTENSIONS
+#include <ext_list.hpp>
+#endif
+
+using namespace InferenceEngine;
+
+bool ParseAndCheckCommandLine(int argc, char *argv[]) {
+    // ---------------------------Parsing and validation of input args--------------------------------------
+
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h) {
+        showUsage();
+        showAvailableDevices();
+        return false;
+    }
+
+    slog::info << "Parsing input parameters" << slog::endl;
+
+    if (FLAGS_i.empty()) {
+        throw std::logic_error("Parameter -i is not set");
+    }
+
+    if (FLAGS_m.empty()) {
+        throw std::logic_error("Parameter -m is not set");
+    }
+
+    if (FLAGS_n_iqs == 0) {
+        throw std::logic_error("-n_iqs can not be zero");
+    }
+
+    return true;
+}
+
+// -------------------------Bounded queue connecting the pipeline stages-------------------------------------------
+
+template <typename T>
+class BlockingQueue {
+public:
+    explicit BlockingQueue(size_t capacity): capacity{capacity}, closed{false} {}
+
+    /// Blocks while the queue is full; returns false if the queue was closed
+    bool push(T value) {
+        std::unique_lock<std::mutex> lock{mutex};
+        notFull.wait(lock, [this]{return closed || queue.size() < capacity;});
+        if (closed) {
+            return false;
+        }
+        queue.push(std::move(value));
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /// Blocks while the queue is empty; returns false once the queue is closed and drained
+    bool pop(T& value) {
+        std::unique_lock<std::mutex> lock{mutex};
+        notEmpty.wait(lock, [this]{return closed || !queue.empty();});
+        if (queue.empty()) {
+            return false;
+        }
+        value = std::move(queue.front());
+        queue.pop();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock{mutex};
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+private:
+    const size_t capacity;
+    bool closed;
+    std::queue<T> queue;
+    std::mutex mutex;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+};
+
+// -------------------------Generic routines for detection networks-------------------------------------------------
+
+struct BaseDetection {
+    ExecutableNetwork net;
+    std::vector<InferRequest> requests;
+    std::string & commandLineFlag;
+    std::string topoName;
+    std::string inputName;
+    std::string outputName;
+
+    BaseDetection(std::string &commandLineFlag, std::string topoName)
+            : commandLineFlag(commandLineFlag), topoName(topoName) {}
+    virtual ~BaseDetection() = default;
+
+    ExecutableNetwork * operator ->() {
+        return &net;
+    }
+    virtual CNNNetwork read()  = 0;
+
+    void createRequests(size_t nireq) {
+        requests.clear();
+        requests.reserve(nireq);
+        for (size_t i = 0; i < nireq; i++) {
+            requests.push_back(net.CreateInferRequest());
+        }
+    }
+
+    /// The frame must stay alive until the request completes when auto-resize wraps it without copying
+    virtual void enqueue(const cv::Mat &frame, InferRequest &request) {
+        if (FLAGS_auto_resize) {
+            request.SetBlob(inputName, wrapMat2Blob(frame));
+        } else {
+            Blob::Ptr inputBlob = request.GetBlob(inputName);
+            matU8ToBlob<uint8_t>(frame, inputBlob);
+        }
+    }
+
+    void printPerformanceCounts(std::string fullDeviceName) const {
+        ::printPerformanceCounts(requests.front(), std::cout, fullDeviceName);
+    }
+};
+
+struct PersonDetection : BaseDetection {
+    int maxProposalCount;
+    int objectSize;
+
+    struct Result {
+        int label;
+        float confidence;
+        cv::Rect location;
+    };
+
+    PersonDetection() : BaseDetection(FLAGS_m, "Person Detection"), maxProposalCount(0), objectSize(0) {}
+    CNNNetwork read() override {
+        slog::info << "Loading network files for PersonDetection" << slog::endl;
+        CNNNetReader netReader;
+        /** Read network model **/
+        netReader.ReadNetwork(FLAGS_m);
+        /** Set batch size to 1 **/
+        slog::info << "Batch size is forced to  1" << slog::endl;
+        netReader.getNetwork().setBatchSize(1);
+        /** Extract model name and load it's weights **/
+        std::string binFileName = fileNameNoExt(FLAGS_m) + ".bin";
+        netReader.ReadWeights(binFileName);
+        // -----------------------------------------------------------------------------------------------------
+
+        /** SSD-based network should have one input and one output **/
+        // ---------------------------Check inputs ------------------------------------------------------
+        slog::info << "Checking Person Detection inputs" << slog::endl;
+        InputsDataMap inputInfo(netReader.getNetwork().getInputsInfo());
+        if (inputInfo.size() != 1) {
+            throw std::logic_error("Person Detection network should have only one input");
+        }
+        InputInfo::Ptr& inputInfoFirst = inputInfo.begin()->second;
+        inputInfoFirst->setPrecision(Precision::U8);
+
+        if (FLAGS_auto_resize) {
+            inputInfoFirst->getPreProcess().setResizeAlgorithm(ResizeAlgorithm::RESIZE_BILINEAR);
+            inputInfoFirst->getInputData()->setLayout(Layout::NHWC);
+        } else {
+            inputInfoFirst->getInputData()->setLayout(Layout::NCHW);
+        }
+        inputName = inputInfo.begin()->first;
+        // -----------------------------------------------------------------------------------------------------
+
+        // ---------------------------Check outputs ------------------------------------------------------
+        slog::info << "Checking Person Detection outputs" << slog::endl;
+        OutputsDataMap outputInfo(netReader.getNetwork().getOutputsInfo());
+        if (outputInfo.size() != 1) {
+            throw std::logic_error("Person Detection network should have only one output");
+        }
+        DataPtr& _output = outputInfo.begin()->second;
+        const SizeVector outputDims = _output->getTensorDesc().getDims();
+        outputName = outputInfo.begin()->first;
+        if (outputDims.size() != 4) {
+            throw std::logic_error("Incorrect output dimensions for SSD");
+        }
+        maxProposalCount = outputDims[2];
+        objectSize = outputDims[3];
+        if (objectSize != 7) {
+            throw std::logic_error("Output should have 7 as a last dimension");
+        }
+        _output->setPrecision(Precision::FP32);
+        _output->setLayout(Layout::NCHW);
+
+        slog::info << "Loading Person Detection model to the "<< FLAGS_d << " device" << slog::endl;
+        return netReader.getNetwork();
+    }
+
+    std::vector<Result> fetchResults(InferRequest &request, const cv::Size &frameSize) const {
+        std::vector<Result> results;
+        const float width = static_cast<float>(frameSize.width);
+        const float height = static_cast<float>(frameSize.height);
+        const float *detections = request.GetBlob(outputName)->buffer().as<float *>();
+        // pretty much regular SSD post-processing
+        for (int i = 0; i < maxProposalCount; i++) {
+            float image_id = detections[i * objectSize + 0];  // in case of batch
+            if (image_id < 0) {  // indicates end of detections
+                break;
+            }
+
+            Result r;
+            r.label = static_cast<int>(detections[i * objectSize + 1]);
+            r.confidence = detections[i * objectSize + 2];
+
+            r.location.x = static_cast<int>(detections[i * objectSize + 3] * width);
+            r.location.y = static_cast<int>(detections[i * objectSize + 4] * height);
+            r.location.width = static_cast<int>(detections[i * objectSize + 5] * width - r.location.x);
+            r.location.height = static_cast<int>(detections[i * objectSize + 6] * height - r.location.y);
+
+            if (FLAGS_r) {
+                std::cout << "[" << i << "," << r.label << "] element, prob = " << r.confidence <<
+                          "    (" << r.location.x << "," << r.location.y << ")-(" << r.location.width << ","
+                          << r.location.height << ")"
+                          << ((r.confidence >= FLAGS_t) ? " WILL BE COUNTED!" : "") << std::endl;
+            }
+
+            if (r.confidence < FLAGS_t) {
+                continue;
+            }
+            results.push_back(r);
+        }
+        return results;
+    }
+};
+
+struct Load {
+    BaseDetection& detector;
+    explicit Load(BaseDetection& detector) : detector(detector) { }
+
+    void into(Core & ie, const std::string & deviceName) const {
+        detector.net = ie.LoadNetwork(detector.read(), deviceName);
+    }
+};
+
+// -------------------------Per-class counters------------------------------------------------------------------------
+
+/**
+ * @brief Mirrors addStatistics() of app.py: a detection is counted under its raw class id
+ * when the id is one of the first kNumClasses ids, and the current counts are added to the totals.
+ */
+struct ObjectCounter {
+    static constexpr size_t kNumClasses = 3;
+    std::array<uint64_t, kNumClasses> current;
+    std::array<uint64_t, kNumClasses> total;
+
+    ObjectCounter() {
+        current.fill(0);
+        total.fill(0);
+    }
+
+    void add(const std::vector<PersonDetection::Result> &results) {
+        current.fill(0);
+        for (const auto &result : results) {
+            if (result.label >= 0 && static_cast<size_t>(result.label) < kNumClasses) {
+                current[result.label]++;
+            }
+        }
+        for (size_t i = 0; i < kNumClasses; i++) {
+            total[i] += current[i];
+        }
+    }
+
+    void draw(cv::Mat &frame) const {
+        static const char *const captions[kNumClasses] = {
+            "Current Persons detected: ", "Current Bikes detected: ", "Current Vehicules detected: "};
+        static const int rows[kNumClasses] = {50, 150, 100};
+        for (size_t i = 0; i < kNumClasses; i++) {
+            cv::putText(frame, captions[i] + std::to_string(current[i]), cv::Point(50, rows[i]),
+                        cv::FONT_HERSHEY_SIMPLEX, 2, cv::Scalar(0));
+        }
+    }
+};
+
+// -------------------------Pipeline---------------------------------------------------------------------------------
+
+struct FramePacket {
+    int64_t frameId;
+    cv::Mat frame;
+};
+
+struct ProcessedFrame {
+    cv::Mat frame;
+    std::vector<PersonDetection::Result> results;
+};
+
+int main(int argc, char *argv[]) {
+    try {
+        /** This demo covers a certain topology and cannot be generalized **/
+        std::cout << "InferenceEngine: " << GetInferenceEngineVersion() << std::endl;
+
+        // ------------------------------ Parsing and validation of input args ---------------------------------
+        if (!ParseAndCheckCommandLine(argc, argv)) {
+            return 0;
+        }
+
+        slog::info << "Reading input" << slog::endl;
+        cv::Mat image = cv::imread(FLAGS_i, cv::IMREAD_COLOR);
+        const bool isVideo = image.empty();
+        cv::VideoCapture cap;
+        if (isVideo && !(FLAGS_i == "cam" ? cap.open(0) : cap.open(FLAGS_i))) {
+            throw std::logic_error("Cannot open input file or camera: " + FLAGS_i);
+        }
+        const int width  = isVideo ? static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH)) : image.cols;
+        const int height = isVideo ? static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT)) : image.rows;
+        double inputFps = isVideo ? cap.get(cv::CAP_PROP_FPS) : 0;
+        if (inputFps <= 0) {
+            inputFps = 30;
+        }
+
+        cv::VideoWriter videoWriter;
+        if (!FLAGS_o.empty()) {
+            videoWriter.open(FLAGS_o, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), inputFps, cv::Size(width, height));
+            if (!videoWriter.isOpened()) {
+                throw std::logic_error("Cannot open output video file: " + FLAGS_o);
+            }
+        }
+        // -----------------------------------------------------------------------------------------------------
+
+        // --------------------------- 1. Load inference engine -------------------------------------
+        Core ie;
+
+        std::set<std::string> devices;
+        for (const std::string& device : parseDevices(FLAGS_d)) {
+            devices.insert(device);
+        }
+        std::map<std::string, uint32_t> device_nstreams = parseValuePerDevice(devices, FLAGS_nstreams);
+
+        for (const std::string& device : devices) {
+            slog::info << "Loading device " << device << slog::endl;
+
+            /** Printing device version **/
+            std::cout << ie.GetVersions(device) << std::endl;
+
+            if ("CPU" == device) {
+#ifdef WITH_EXTENSIONS
+                /** Load default extensions lib for the CPU device (e.g. SSD's DetectionOutput)**/
+                ie.AddExtension(std::make_shared<Extensions::Cpu::CpuExtensions>(), "CPU");
+#endif
+                if (!FLAGS_l.empty()) {
+                    // CPU(MKLDNN) extensions are loaded as a shared library and passed as a pointer to base extension
+                    auto extension_ptr = make_so_pointer<IExtension>(FLAGS_l);
+                    ie.AddExtension(extension_ptr, "CPU");
+                    slog::info << "CPU Extension loaded: " << FLAGS_l << slog::endl;
+                }
+                if (FLAGS_nthreads != 0) {
+                    ie.SetConfig({{ CONFIG_KEY(CPU_THREADS_NUM), std::to_string(FLAGS_nthreads) }}, "CPU");
+                }
+                ie.SetConfig({{ CONFIG_KEY(CPU_BIND_THREAD), CONFIG_VALUE(NO) }}, "CPU");
+                ie.SetConfig({{ CONFIG_KEY(CPU_THROUGHPUT_STREAMS),
+                                (device_nstreams.count("CPU") > 0 ? std::to_string(device_nstreams.at("CPU")) :
+                                                                   "CPU_THROUGHPUT_AUTO") }}, "CPU");
+                device_nstreams["CPU"] = std::stoi(ie.GetConfig("CPU", CONFIG_KEY(CPU_THROUGHPUT_STREAMS)).as<std::string>());
+            }
+
+            if ("GPU" == device) {
+                // Load any user-specified clDNN Extensions
+                if (!FLAGS_c.empty()) {
+                    ie.SetConfig({ { PluginConfigParams::KEY_CONFIG_FILE, FLAGS_c } }, "GPU");
+                }
+                ie.SetConfig({{ CONFIG_KEY(GPU_THROUGHPUT_STREAMS),
+                                (device_nstreams.count("GPU") > 0 ? std::to_string(device_nstreams.at("GPU")) :
+                                                                    "GPU_THROUGHPUT_AUTO") }}, "GPU");
+                device_nstreams["GPU"] = std::stoi(ie.GetConfig("GPU", CONFIG_KEY(GPU_THROUGHPUT_STREAMS)).as<std::string>());
+            }
+        }
+
+        /** Per layer metrics **/
+        if (FLAGS_pc) {
+            ie.SetConfig({{PluginConfigParams::KEY_PERF_COUNT, PluginConfigParams::YES}});
+        }
+        // -----------------------------------------------------------------------------------------------------
+
+        // --------------------------- 2. Read IR model, load it to the device and create requests --------------
+        PersonDetection personDetection;
+        Load(personDetection).into(ie, FLAGS_d);
+
+        unsigned nireq = FLAGS_nireq;
+        if (nireq == 0) {
+            nireq = personDetection->GetMetric(METRIC_KEY(OPTIMAL_NUMBER_OF_INFER_REQUESTS)).as<unsigned int>();
+        }
+        personDetection.createRequests(nireq);
+        slog::info << "Number of InferRequests: " << nireq << slog::endl;
+        for (const auto& nstreams : device_nstreams) {
+            slog::info << "Number of streams for " << nstreams.first << ": " << nstreams.second << slog::endl;
+        }
+        // -----------------------------------------------------------------------------------------------------
+
+        // --------------------------- 3. Do inference ---------------------------------------------------------
+        /** Frames go decode thread -> decoded -> submit thread -> InferRequest -> completed -> postprocess thread ->
+            rendered -> main thread, which owns the HighGUI window. Requests are recycled through freeRequests,
+            so at most nireq frames are in flight **/
+        BlockingQueue<FramePacket> decoded(FLAGS_n_iqs);
+        BlockingQueue<size_t> freeRequests(nireq);
+        BlockingQueue<size_t> completed(nireq);
+        BlockingQueue<cv::Mat> rendered(FLAGS_n_iqs);
+        std::vector<FramePacket> inFlight(nireq);
+
+        for (size_t i = 0; i < nireq; i++) {
+            freeRequests.push(i);
+            personDetection.requests[i].SetCompletionCallback([&completed, i] {
+                completed.push(i);
+            });
+        }
+
+        std::atomic<bool> running{true};
+        std::exception_ptr pipelineException;
+        std::mutex exceptionMutex;
+        auto stopOnException = [&] {
+            std::lock_guard<std::mutex> lock{exceptionMutex};
+            if (nullptr == pipelineException) {
+                pipelineException = std::current_exception();
+            }
+            running = false;
+            decoded.close();
+            freeRequests.close();
+            completed.close();
+            rendered.close();
+        };
+
+        ObjectCounter counter;
+        uint64_t framesProcessed = 0;
+
+        typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
+        auto total_t0 = std::chrono::high_resolution_clock::now();
+        slog::info << "Start inference " << slog::endl;
+
+        std::cout << "To close the application, press 'CTRL+C' here";
+        if (!FLAGS_no_show) {
+            std::cout << " or switch to the output window and press ESC key";
+        }
+        std::cout << std::endl;
+
+        std::thread decodeThread([&] {
+            try {
+                int64_t frameId = 0;
+                while (running) {
+                    cv::Mat frame;
+                    if (isVideo) {
+                        if (!cap.read(frame)) {
+                            break;  // end of video file
+                        }
+                    } else if (0 == frameId) {
+                        frame = image;
+                    } else {
+                        break;
+                    }
+                    if (!decoded.push({frameId++, std::move(frame)})) {
+                        break;
+                    }
+                }
+                decoded.close();
+            } catch (...) {
+                stopOnException();
+            }
+        });
+
+        std::thread postprocessThread([&] {
+            try {
+                /** Completions arrive in any order, results are emitted in frame order **/
+                std::map<int64_t, ProcessedFrame> reorderBuffer;
+                int64_t nextFrameId = 0;
+                size_t requestId;
+                while (completed.pop(requestId)) {
+                    InferRequest &request = personDetection.requests[requestId];
+                    FramePacket packet = std::move(inFlight[requestId]);
+                    request.Wait(IInferRequest::WaitMode::RESULT_READY);
+                    ProcessedFrame processed{packet.frame, personDetection.fetchResults(request, packet.frame.size())};
+                    freeRequests.push(requestId);
+                    reorderBuffer.emplace(packet.frameId, std::move(processed));
+
+                    for (auto it = reorderBuffer.begin(); it != reorderBuffer.end() && it->first == nextFrameId;
+                         it = reorderBuffer.erase(it), nextFrameId++) {
+                        cv::Mat &frame = it->second.frame;
+                        counter.add(it->second.results);
+                        framesProcessed++;
+                        if (FLAGS_no_show && FLAGS_o.empty()) {
+                            continue;
+                        }
+                        for (const auto &result : it->second.results) {
+                            cv::rectangle(frame, result.location, cv::Scalar(0, 0, 255), 1);
+                        }
+                        counter.draw(frame);
+                        if (videoWriter.isOpened()) {
+                            videoWriter.write(frame);
+                        }
+                        if (!FLAGS_no_show) {
+                            rendered.push(frame);
+                        }
+                    }
+                }
+                rendered.close();
+            } catch (...) {
+                stopOnException();
+            }
+        });
+
+        std::thread submitThread([&] {
+            try {
+                FramePacket packet;
+                size_t requestId;
+                while (decoded.pop(packet) && freeRequests.pop(requestId)) {
+                    InferRequest &request = personDetection.requests[requestId];
+                    personDetection.enqueue(packet.frame, request);
+                    inFlight[requestId] = std::move(packet);
+                    request.StartAsync();
+                }
+                /** Every request returns to freeRequests once its frame is postprocessed **/
+                for (size_t i = 0; i < nireq && freeRequests.pop(requestId); i++) {}
+            } catch (...) {
+                stopOnException();
+            }
+            completed.close();
+        });
+
+        /** HighGUI is driven from the main thread only; after Esc the remaining frames are drained unseen **/
+        try {
+            cv::Mat shownFrame;
+            while (rendered.pop(shownFrame)) {
+                if (!running) {
+                    continue;
+                }
+                cv::imshow("Detection results", shownFrame);
+                // for still images wait until any key is pressed, for video 1 ms is enough per frame
+                const int key = cv::waitKey(isVideo ? 1 : 0);
+                if (27 == key) {  // Esc
+                    running = false;
+                    decoded.close();
+                }
+            }
+        } catch (...) {
+            stopOnException();
+        }
+
+        decodeThread.join();
+        submitThread.join();
+        postprocessThread.join();
+        if (nullptr != pipelineException) {
+            std::rethrow_exception(pipelineException);
+        }
+
+        auto total_t1 = std::chrono::high_resolution_clock::now();
+        ms total = std::chrono::duration_cast<ms>(total_t1 - total_t0);
+        slog::info << "Total Inference time: " << total.count() << slog::endl;
+        slog::info << "Frames processed: " << framesProcessed << " ("
+                   << std::fixed << std::setprecision(2) << framesProcessed * 1000.0 / total.count() << " fps)" << slog::endl;
+        slog::info << "Total Persons detected: " << counter.total[0] << slog::endl;
+        slog::info << "Total Bikes detected: " << counter.total[1] << slog::endl;
+        slog::info << "Total Vehicules detected: " << counter.total[2] << slog::endl;
+
+        /** Show performace results **/
+        if (FLAGS_pc) {
+            std::map<std::string, std::string> mapDevices = getMapFullDevicesNames(ie, {FLAGS_d});
+            std::cout << "Performance counts for person detection: " << std::endl;
+            personDetection.printPerformanceCounts(getFullDeviceName(mapDevices, FLAGS_d));
+        }
+        // -----------------------------------------------------------------------------------------------------
+    }
+    catch (const std::exception& error) {
+        std::cerr << "[ ERROR ] " << error.what() << std::endl;
+        return 1;
+    }
+    catch (...) {
+        std::cerr << "[ ERROR ] Unknown/internal exception happened." << std::endl;
+        return 1;
+    }
+
+    slog::info << "Execution successful" << slog::endl;
+    return 0;
+}
@@ -32,7 +32,6 @@ private:
             const cv::Size& imageSize) const;
     std::vector<HumanPose> extractPoses(const std::vector<cv::Mat>& heatMaps,
                                         const std::vector<cv::Mat>& pafs) const;
-    void resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const;
     void correctCoordinates(std::vector<HumanPose>& poses,
                             const cv::Size& featureMapsSize,
                             const cv::Size& imageSize) const;
@@ -39,10 +39,15 @@ struct TwoJointsConnection {
     float score;
 };
 
+/**
+ * Finds peaks of the network-resolution heatMaps[heatMapId]. Positions are refined to
+ * sub-pixel precision and given in coordinates of the map upsampled by upsampleRatio.
+ */
 void findPeaks(const std::vector<cv::Mat>& heatMaps,
                const float minPeaksDistance,
                std::vector<std::vector<Peak> >& allPeaks,
-               int heatMapId);
+               int heatMapId,
+               const int upsampleRatio);
 
 std::vector<HumanPose> groupPeaksToPoses(
         const std::vector<std::vector<Peak> >& allPeaks,
@@ -51,5 +56,6 @@ std::vector<HumanPose> groupPeaksToPoses(
         const float midPointsScoreThreshold,
         const float foundMidPointsRatioThreshold,
         const int minJointsNumber,
-        const float minSubsetScore);
+        const float minSubsetScore,
+        const int upsampleRatio);
 }  // namespace human_pose_estimation
@@ -119,7 +119,6 @@ std::vector<HumanPose> HumanPoseEstimator::postprocess(
                                   const_cast<float*>(
                                       heatMapsData + i * heatMapOffset)));
     }
-    resizeFeatureMaps(heatMaps);
 
     std::vector<cv::Mat> pafs(nPafs);
     for (size_t i = 0; i < pafs.size(); i++) {
@@ -128,30 +127,32 @@ std::vector<HumanPose> HumanPoseEstimator::postprocess(
                               const_cast<float*>(
                                   pafsData + i * pafOffset)));
     }
-    resizeFeatureMaps(pafs);
 
+    // Peaks and PAFs are processed at network resolution, keypoints are given in the upsampled maps coordinates
     std::vector<HumanPose> poses = extractPoses(heatMaps, pafs);
-    correctCoordinates(poses, heatMaps[0].size(), imageSize);
+    correctCoordinates(poses, heatMaps[0].size() * upsampleRatio, imageSize);
     return poses;
 }
 
 class FindPeaksBody: public cv::ParallelLoopBody {
 public:
-    FindPeaksBody(const std::vector<cv::Mat>& heatMaps, float minPeaksDistance,
+    FindPeaksBody(const std::vector<cv::Mat>& heatMaps, float minPeaksDistance, int upsampleRatio,
                   std::vector<std::vector<Peak> >& peaksFromHeatMap)
         : heatMaps(heatMaps),
           minPeaksDistance(minPeaksDistance),
+          upsampleRatio(upsampleRatio),
           peaksFromHeatMap(peaksFromHeatMap) {}
 
     virtual void operator()(const cv::Range& range) const {
         for (int i = range.start; i < range.end; i++) {
-            findPeaks(heatMaps, minPeaksDistance, peaksFromHeatMap, i);
+            findPeaks(heatMaps, minPeaksDistance, peaksFromHeatMap, i, upsampleRatio);
         }
     }
 
 private:
     const std::vector<cv::Mat>& heatMaps;
     float minPeaksDistance;
+    int upsampleRatio;
     std::vector<std::vector<Peak> >& peaksFromHeatMap;
 };
 
@@ -159,7 +160,7 @@ std::vector<HumanPose> HumanPoseEstimator::extractPoses(
         const std::vector<cv::Mat>& heatMaps,
         const std::vector<cv::Mat>& pafs) const {
     std::vector<std::vector<Peak> > peaksFromHeatMap(heatMaps.size());
-    FindPeaksBody findPeaksBody(heatMaps, minPeaksDistance, peaksFromHeatMap);
+    FindPeaksBody findPeaksBody(heatMaps, minPeaksDistance, upsampleRatio, peaksFromHeatMap);
     cv::parallel_for_(cv::Range(0, static_cast<int>(heatMaps.size())),
                       findPeaksBody);
     int peaksBefore = 0;
@@ -171,17 +172,10 @@ std::vector<HumanPose> HumanPoseEstimator::extractPoses(
     }
     std::vector<HumanPose> poses = groupPeaksToPoses(
                 peaksFromHeatMap, pafs, keypointsNumber, midPointsScoreThreshold,
-                foundMidPointsRatioThreshold, minJointsNumber, minSubsetScore);
+                foundMidPointsRatioThreshold, minJointsNumber, minSubsetScore, upsampleRatio);
     return poses;
 }
 
-void HumanPoseEstimator::resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const {
-    for (auto& featureMap : featureMaps) {
-        cv::resize(featureMap, featureMap, cv::Size(),
-                   upsampleRatio, upsampleRatio, cv::INTER_CUBIC);
-    }
-}
-
 void HumanPoseEstimator::correctCoordinates(std::vector<HumanPose>& poses,
                                             const cv::Size& featureMapsSize,
                                             const cv::Size& imageSize) const {
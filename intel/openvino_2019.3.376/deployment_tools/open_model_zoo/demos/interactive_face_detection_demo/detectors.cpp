@@ -251,48 +251,88 @@ void FaceDetection::fetchResults() {
 }
 
 
-AgeGenderDetection::AgeGenderDetection(const std::string &pathToModel,
-                                       const std::string &deviceForInference,
-                                       int maxBatch, bool isBatchDynamic, bool isAsync, bool doRawOutputMessages)
-    : BaseDetection("Age/Gender", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
-      enquedFaces(0) {
-}
-
-void AgeGenderDetection::submitRequest()  {
+FaceAnalyticsDetection::FaceAnalyticsDetection(std::string topoName,
+                                               const std::string &pathToModel,
+                                               const std::string &deviceForInference,
+                                               int maxBatch, bool isBatchDynamic, bool isAsync,
+                                               bool doRawOutputMessages)
+    : BaseDetection(topoName, pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
+      enquedFaces(0), submittedRequests(0) {}
+
+void FaceAnalyticsDetection::submitRequest() {
     if (!enquedFaces)
         return;
-    if (isBatchDynamic) {
-        request->SetBatch(enquedFaces);
+    submittedRequests = (enquedFaces + maxBatch - 1) / maxBatch;
+    queueTime.setStartTime();
+    // Batches run concurrently with each other and with the other networks, results are collected in wait()
+    for (size_t i = 0; i < submittedRequests; i++) {
+        if (isBatchDynamic) {
+            requests[i]->SetBatch(static_cast<int>(std::min(maxBatch, enquedFaces - i * maxBatch)));
+        }
+        requests[i]->StartAsync();
     }
-    BaseDetection::submitRequest();
     enquedFaces = 0;
 }
 
-void AgeGenderDetection::enqueue(const cv::Mat &face) {
-    if (!enabled()) {
+void FaceAnalyticsDetection::wait() {
+    if (!submittedRequests)
         return;
+    // The callbacks have run once Wait returns, so the stamps are not affected by how late wait() is called
+    auto lastCompletion = std::chrono::high_resolution_clock::time_point::min();
+    for (size_t i = 0; i < submittedRequests; i++) {
+        requests[i]->Wait(IInferRequest::WaitMode::RESULT_READY);
+        lastCompletion = std::max(lastCompletion, completionTimes[i]);
     }
-    if (enquedFaces == maxBatch) {
-        slog::warn << "Number of detected faces more than maximum(" << maxBatch << ") processed by Age/Gender Recognition network" << slog::endl;
+    queueTime.calculateDuration(lastCompletion);
+    submittedRequests = 0;
+}
+
+void FaceAnalyticsDetection::enqueue(const cv::Mat &face) {
+    if (!enabled()) {
         return;
     }
-    if (!request) {
-        request = net.CreateInferRequestPtr();
+    // The pool grows to the largest number of batches a frame has needed
+    if (enquedFaces / maxBatch == requests.size()) {
+        size_t idx = requests.size();
+        requests.push_back(net.CreateInferRequestPtr());
+        completionTimes.emplace_back();
+        requests.back()->SetCompletionCallback([this, idx] {
+            completionTimes[idx] = std::chrono::high_resolution_clock::now();
+        });
+        if (!request) {
+            request = requests.front();
+        }
     }
 
-    Blob::Ptr  inputBlob = request->GetBlob(input);
+    Blob::Ptr inputBlob = requests[enquedFaces / maxBatch]->GetBlob(input);
 
-    matU8ToBlob<uint8_t>(face, inputBlob, enquedFaces);
+    matU8ToBlob<uint8_t>(face, inputBlob, static_cast<int>(enquedFaces % maxBatch));
 
     enquedFaces++;
 }
 
+const InferRequest::Ptr& FaceAnalyticsDetection::requestOf(int idx) const {
+    return requests[idx / maxBatch];
+}
+
+size_t FaceAnalyticsDetection::batchIndexOf(int idx) const {
+    return idx % maxBatch;
+}
+
+
+AgeGenderDetection::AgeGenderDetection(const std::string &pathToModel,
+                                       const std::string &deviceForInference,
+                                       int maxBatch, bool isBatchDynamic, bool isAsync, bool doRawOutputMessages)
+    : FaceAnalyticsDetection("Age/Gender", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages) {
+}
+
 AgeGenderDetection::Result AgeGenderDetection::operator[] (int idx) const {
-    Blob::Ptr  genderBlob = request->GetBlob(outputGender);
-    Blob::Ptr  ageBlob    = request->GetBlob(outputAge);
+    Blob::Ptr  genderBlob = requestOf(idx)->GetBlob(outputGender);
+    Blob::Ptr  ageBlob    = requestOf(idx)->GetBlob(outputAge);
+    size_t b = batchIndexOf(idx);
 
-    AgeGenderDetection::Result r = {ageBlob->buffer().as<float*>()[idx] * 100,
-                                         genderBlob->buffer().as<float*>()[idx * 2 + 1]};
+    AgeGenderDetection::Result r = {ageBlob->buffer().as<float*>()[b] * 100,
+                                         genderBlob->buffer().as<float*>()[b * 2 + 1]};
     if (doRawOutputMessages) {
         std::cout << "[" << idx << "] element, male prob = " << r.maleProb << ", age = " << r.age << std::endl;
     }
@@ -384,46 +424,19 @@ CNNNetwork AgeGenderDetection::read() {
 HeadPoseDetection::HeadPoseDetection(const std::string &pathToModel,
                                      const std::string &deviceForInference,
                                      int maxBatch, bool isBatchDynamic, bool isAsync, bool doRawOutputMessages)
-    : BaseDetection("Head Pose", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
-      outputAngleR("angle_r_fc"), outputAngleP("angle_p_fc"), outputAngleY("angle_y_fc"), enquedFaces(0) {
-}
-
-void HeadPoseDetection::submitRequest()  {
-    if (!enquedFaces) return;
-    if (isBatchDynamic) {
-        request->SetBatch(enquedFaces);
-    }
-    BaseDetection::submitRequest();
-    enquedFaces = 0;
-}
-
-void HeadPoseDetection::enqueue(const cv::Mat &face) {
-    if (!enabled()) {
-        return;
-    }
-    if (enquedFaces == maxBatch) {
-        slog::warn << "Number of detected faces more than maximum(" << maxBatch << ") processed by Head Pose estimator" << slog::endl;
-        return;
-    }
-    if (!request) {
-        request = net.CreateInferRequestPtr();
-    }
-
-    Blob::Ptr inputBlob = request->GetBlob(input);
-
-    matU8ToBlob<uint8_t>(face, inputBlob, enquedFaces);
-
-    enquedFaces++;
+    : FaceAnalyticsDetection("Head Pose", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
+      outputAngleR("angle_r_fc"), outputAngleP("angle_p_fc"), outputAngleY("angle_y_fc") {
 }
 
 HeadPoseDetection::Results HeadPoseDetection::operator[] (int idx) const {
-    Blob::Ptr  angleR = request->GetBlob(outputAngleR);
-    Blob::Ptr  angleP = request->GetBlob(outputAngleP);
-    Blob::Ptr  angleY = request->GetBlob(outputAngleY);
+    Blob::Ptr  angleR = requestOf(idx)->GetBlob(outputAngleR);
+    Blob::Ptr  angleP = requestOf(idx)->GetBlob(outputAngleP);
+    Blob::Ptr  angleY = requestOf(idx)->GetBlob(outputAngleY);
+    size_t b = batchIndexOf(idx);
 
-    HeadPoseDetection::Results r = {angleR->buffer().as<float*>()[idx],
-                                    angleP->buffer().as<float*>()[idx],
-                                    angleY->buffer().as<float*>()[idx]};
+    HeadPoseDetection::Results r = {angleR->buffer().as<float*>()[b],
+                                    angleP->buffer().as<float*>()[b],
+                                    angleY->buffer().as<float*>()[b]};
 
     if (doRawOutputMessages) {
         std::cout << "[" << idx << "] element, yaw = " << r.angle_y <<
@@ -505,36 +518,7 @@ CNNNetwork HeadPoseDetection::read() {
 EmotionsDetection::EmotionsDetection(const std::string &pathToModel,
                                      const std::string &deviceForInference,
                                      int maxBatch, bool isBatchDynamic, bool isAsync, bool doRawOutputMessages)
-              : BaseDetection("Emotions Recognition", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
-                enquedFaces(0) {
-}
-
-void EmotionsDetection::submitRequest() {
-    if (!enquedFaces) return;
-    if (isBatchDynamic) {
-        request->SetBatch(enquedFaces);
-    }
-    BaseDetection::submitRequest();
-    enquedFaces = 0;
-}
-
-void EmotionsDetection::enqueue(const cv::Mat &face) {
-    if (!enabled()) {
-        return;
-    }
-    if (enquedFaces == maxBatch) {
-        slog::warn << "Number of detected faces more than maximum(" << maxBatch << ") processed by Emotions Recognition network" << slog::endl;
-        return;
-    }
-    if (!request) {
-        request = net.CreateInferRequestPtr();
-    }
-
-    Blob::Ptr inputBlob = request->GetBlob(input);
-
-    matU8ToBlob<uint8_t>(face, inputBlob, enquedFaces);
-
-    enquedFaces++;
+              : FaceAnalyticsDetection("Emotions Recognition", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages) {
 }
 
 std::map<std::string, float> EmotionsDetection::operator[] (int idx) const {
@@ -542,7 +526,7 @@ std::map<std::string, float> EmotionsDetection::operator[] (int idx) const {
     static const std::vector<std::string> emotionsVec = {"neutral", "happy", "sad", "surprise", "anger"};
     auto emotionsVecSize = emotionsVec.size();
 
-    Blob::Ptr emotionsBlob = request->GetBlob(outputEmotions);
+    Blob::Ptr emotionsBlob = requestOf(idx)->GetBlob(outputEmotions);
 
     /* emotions vector must have the same size as number of channels
      * in model output. Default output format is NCHW, so index 1 is checked */
@@ -555,7 +539,7 @@ std::map<std::string, float> EmotionsDetection::operator[] (int idx) const {
     }
 
     auto emotionsValues = emotionsBlob->buffer().as<float *>();
-    auto outputIdxPos = emotionsValues + idx * emotionsVecSize;
+    auto outputIdxPos = emotionsValues + batchIndexOf(idx) * emotionsVecSize;
     std::map<std::string, float> emotions;
 
     if (doRawOutputMessages) {
@@ -648,50 +632,23 @@ CNNNetwork EmotionsDetection::read() {
 FacialLandmarksDetection::FacialLandmarksDetection(const std::string &pathToModel,
                                                    const std::string &deviceForInference,
                                                    int maxBatch, bool isBatchDynamic, bool isAsync, bool doRawOutputMessages)
-    : BaseDetection("Facial Landmarks", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
-      outputFacialLandmarksBlobName("align_fc3"), enquedFaces(0) {
-}
-
-void FacialLandmarksDetection::submitRequest() {
-    if (!enquedFaces) return;
-    if (isBatchDynamic) {
-        request->SetBatch(enquedFaces);
-    }
-    BaseDetection::submitRequest();
-    enquedFaces = 0;
-}
-
-void FacialLandmarksDetection::enqueue(const cv::Mat &face) {
-    if (!enabled()) {
-        return;
-    }
-    if (enquedFaces == maxBatch) {
-        slog::warn << "Number of detected faces more than maximum(" << maxBatch << ") processed by Facial Landmarks estimator" << slog::endl;
-        return;
-    }
-    if (!request) {
-        request = net.CreateInferRequestPtr();
-    }
-
-    Blob::Ptr inputBlob = request->GetBlob(input);
-
-    matU8ToBlob<uint8_t>(face, inputBlob, enquedFaces);
-
-    enquedFaces++;
+    : FaceAnalyticsDetection("Facial Landmarks", pathToModel, deviceForInference, maxBatch, isBatchDynamic, isAsync, doRawOutputMessages),
+      outputFacialLandmarksBlobName("align_fc3") {
 }
 
 std::vector<float> FacialLandmarksDetection::operator[] (int idx) const {
     std::vector<float> normedLandmarks;
 
-    auto landmarksBlob = request->GetBlob(outputFacialLandmarksBlobName);
+    auto landmarksBlob = requestOf(idx)->GetBlob(outputFacialLandmarksBlobName);
     auto n_lm = getTensorChannels(landmarksBlob->getTensorDesc());
-    const float *normed_coordinates = request->GetBlob(outputFacialLandmarksBlobName)->buffer().as<float *>();
+    const float *normed_coordinates = landmarksBlob->buffer().as<float *>();
 
     if (doRawOutputMessages) {
         std::cout << "[" << idx << "] element, normed facial landmarks coordinates (x, y):" << std::endl;
     }
 
-    auto begin = n_lm * idx;
+    // n_lm values, i.e. n_lm / 2 points, per face
+    auto begin = n_lm / 2 * batchIndexOf(idx);
     auto end = begin + n_lm / 2;
     for (auto i_lm = begin; i_lm < end; ++i_lm) {
         float normed_x = normed_coordinates[2 * i_lm];
@@ -807,9 +764,16 @@ double CallStat::getLastCallDuration() {
     return _last_call_duration;
 }
 
+double CallStat::getAverageDuration() {
+    return _number_of_calls ? _total_duration / _number_of_calls : 0.0;
+}
+
 void CallStat::calculateDuration() {
-    auto t = std::chrono::high_resolution_clock::now();
-    _last_call_duration = std::chrono::duration_cast<ms>(t - _last_call_start).count();
+    calculateDuration(std::chrono::high_resolution_clock::now());
+}
+
+void CallStat::calculateDuration(const std::chrono::high_resolution_clock::time_point &finish) {
+    _last_call_duration = std::chrono::duration_cast<ms>(finish - _last_call_start).count();
     _number_of_calls++;
     _total_duration += _last_call_duration;
     if (_smoothed_duration < 0) {
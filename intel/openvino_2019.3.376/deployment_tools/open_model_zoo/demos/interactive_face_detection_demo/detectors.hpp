@@ -32,6 +32,28 @@
 
 // -------------------------Generic routines for detection networks-------------------------------------------------
 
+class CallStat {
+public:
+    typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
+
+    CallStat();
+
+    double getSmoothedDuration();
+    double getTotalDuration();
+    double getLastCallDuration();
+    double getAverageDuration();
+    void calculateDuration();
+    void calculateDuration(const std::chrono::high_resolution_clock::time_point &finish);
+    void setStartTime();
+
+private:
+    size_t _number_of_calls;
+    double _total_duration;
+    double _last_call_duration;
+    double _smoothed_duration;
+    std::chrono::time_point<std::chrono::high_resolution_clock> _last_call_start;
+};
+
 struct BaseDetection {
     InferenceEngine::ExecutableNetwork net;
     InferenceEngine::InferRequest::Ptr request;
@@ -97,16 +119,42 @@ struct FaceDetection : BaseDetection {
     void fetchResults();
 };
 
-struct AgeGenderDetection : BaseDetection {
+/// Per-face network: face crops of a frame are packed into as many batches of maxBatch faces as needed,
+/// every batch gets its own infer request, and all of them are started asynchronously
+struct FaceAnalyticsDetection : BaseDetection {
+    std::string input;
+    std::vector<InferenceEngine::InferRequest::Ptr> requests;
+    /// Completion time of every request, stamped by its completion callback
+    std::vector<std::chrono::high_resolution_clock::time_point> completionTimes;
+    size_t enquedFaces;
+    size_t submittedRequests;
+    /// Time from submitting the batches of a frame until the last of them completes
+    CallStat queueTime;
+
+    FaceAnalyticsDetection(std::string topoName,
+                           const std::string &pathToModel,
+                           const std::string &deviceForInference,
+                           int maxBatch, bool isBatchDynamic, bool isAsync,
+                           bool doRawOutputMessages);
+
+    void submitRequest() override;
+    void wait() override;
+
+    void enqueue(const cv::Mat &face);
+    /// Request holding results of the face idx
+    const InferenceEngine::InferRequest::Ptr& requestOf(int idx) const;
+    /// Index of the face idx in the batch of its request
+    size_t batchIndexOf(int idx) const;
+};
+
+struct AgeGenderDetection : FaceAnalyticsDetection {
     struct Result {
         float age;
         float maleProb;
     };
 
-    std::string input;
     std::string outputAge;
     std::string outputGender;
-    size_t enquedFaces;
 
     AgeGenderDetection(const std::string &pathToModel,
                        const std::string &deviceForInference,
@@ -114,24 +162,20 @@ struct AgeGenderDetection : BaseDetection {
                        bool doRawOutputMessages);
 
     InferenceEngine::CNNNetwork read() override;
-    void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
     Result operator[] (int idx) const;
 };
 
-struct HeadPoseDetection : BaseDetection {
+struct HeadPoseDetection : FaceAnalyticsDetection {
     struct Results {
         float angle_r;
         float angle_p;
         float angle_y;
     };
 
-    std::string input;
     std::string outputAngleR;
     std::string outputAngleP;
     std::string outputAngleY;
-    size_t enquedFaces;
     cv::Mat cameraMatrix;
 
     HeadPoseDetection(const std::string &pathToModel,
@@ -140,16 +184,12 @@ struct HeadPoseDetection : BaseDetection {
                       bool doRawOutputMessages);
 
     InferenceEngine::CNNNetwork read() override;
-    void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
     Results operator[] (int idx) const;
 };
 
-struct EmotionsDetection : BaseDetection {
-    std::string input;
+struct EmotionsDetection : FaceAnalyticsDetection {
     std::string outputEmotions;
-    size_t enquedFaces;
 
     EmotionsDetection(const std::string &pathToModel,
                       const std::string &deviceForInference,
@@ -157,18 +197,14 @@ struct EmotionsDetection : BaseDetection {
                       bool doRawOutputMessages);
 
     InferenceEngine::CNNNetwork read() override;
-    void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
     std::map<std::string, float> operator[] (int idx) const;
 
     const std::vector<std::string> emotionsVec = {"neutral", "happy", "sad", "surprise", "anger"};
 };
 
-struct FacialLandmarksDetection : BaseDetection {
-    std::string input;
+struct FacialLandmarksDetection : FaceAnalyticsDetection {
     std::string outputFacialLandmarksBlobName;
-    size_t enquedFaces;
     std::vector<std::vector<float>> landmarks_results;
     std::vector<cv::Rect> faces_bounding_boxes;
 
@@ -178,9 +214,7 @@ struct FacialLandmarksDetection : BaseDetection {
                              bool doRawOutputMessages);
 
     InferenceEngine::CNNNetwork read() override;
-    void submitRequest() override;
 
-    void enqueue(const cv::Mat &face);
     std::vector<float> operator[] (int idx) const;
 };
 
@@ -192,26 +226,6 @@ struct Load {
     void into(InferenceEngine::Core & ie, const std::string & deviceName, bool enable_dynamic_batch = false) const;
 };
 
-class CallStat {
-public:
-    typedef std::chrono::duration<double, std::ratio<1, 1000>> ms;
-
-    CallStat();
-
-    double getSmoothedDuration();
-    double getTotalDuration();
-    double getLastCallDuration();
-    void calculateDuration();
-    void setStartTime();
-
-private:
-    size_t _number_of_calls;
-    double _total_duration;
-    double _last_call_duration;
-    double _smoothed_duration;
-    std::chrono::time_point<std::chrono::high_resolution_clock> _last_call_start;
-};
-
 class Timer {
 public:
     void start(const std::string& name);
@@ -55,21 +55,21 @@ static const char target_device_message_lm[] = "Optional. Target device for Faci
 "(the list of available devices is shown below). Default value is CPU. Use \"-d HETERO:<comma-separated_devices_list>\" format to specify HETERO plugin. " \
 "The demo will look for a suitable plugin for device specified.";
 
-/// @brief Message for the maximum number of simultaneously processed faces for Age Gender network
-static const char num_batch_ag_message[] = "Optional. Number of maximum simultaneously processed faces for Age/Gender Recognition network " \
-"(by default, it is 16)";
+/// @brief Message for the batch size of Age Gender network
+static const char num_batch_ag_message[] = "Optional. Batch size for Age/Gender Recognition network. Faces of a frame are processed in as many batches " \
+"of this size as needed (by default, it is 16)";
 
-/// @brief Message for the maximum number of simultaneously processed faces for Head Pose network
-static const char num_batch_hp_message[] = "Optional. Number of maximum simultaneously processed faces for Head Pose Estimation network " \
-"(by default, it is 16)";
+/// @brief Message for the batch size of Head Pose network
+static const char num_batch_hp_message[] = "Optional. Batch size for Head Pose Estimation network. Faces of a frame are processed in as many batches " \
+"of this size as needed (by default, it is 16)";
 
-/// @brief Message for the maximum number of simultaneously processed faces for Emotions network
-static const char num_batch_em_message[] = "Optional. Number of maximum simultaneously processed faces for Emotions Recognition network " \
-"(by default, it is 16)";
+/// @brief Message for the batch size of Emotions network
+static const char num_batch_em_message[] = "Optional. Batch size for Emotions Recognition network. Faces of a frame are processed in as many batches " \
+"of this size as needed (by default, it is 16)";
 
-/// @brief Message for the maximum number of simultaneously processed faces for Facial Landmarks Estimation network
-static const char num_batch_lm_message[] = "Optional. Number of maximum simultaneously processed faces for Facial Landmarks Estimation network " \
-"(by default, it is 16)";
+/// @brief Message for the batch size of Facial Landmarks Estimation network
+static const char num_batch_lm_message[] = "Optional. Batch size for Facial Landmarks Estimation network. Faces of a frame are processed in as many batches " \
+"of this size as needed (by default, it is 16)";
 
 /// @brief Message for dynamic batching support for AgeGender net
 static const char dyn_batch_ag_message[] = "Optional. Enable dynamic batch size for Age/Gender Recognition network";
@@ -301,28 +301,24 @@ int main(int argc, char *argv[]) {
                     face = std::make_shared<Face>(id++, rect);
                 }
 
-                face->ageGenderEnable((ageGenderDetector.enabled() &&
-                                       i < ageGenderDetector.maxBatch));
+                face->ageGenderEnable(ageGenderDetector.enabled());
                 if (face->isAgeGenderEnabled()) {
                     AgeGenderDetection::Result ageGenderResult = ageGenderDetector[i];
                     face->updateGender(ageGenderResult.maleProb);
                     face->updateAge(ageGenderResult.age);
                 }
 
-                face->emotionsEnable((emotionsDetector.enabled() &&
-                                      i < emotionsDetector.maxBatch));
+                face->emotionsEnable(emotionsDetector.enabled());
                 if (face->isEmotionsEnabled()) {
                     face->updateEmotions(emotionsDetector[i]);
                 }
 
-                face->headPoseEnable((headPoseDetector.enabled() &&
-                                      i < headPoseDetector.maxBatch));
+                face->headPoseEnable(headPoseDetector.enabled());
                 if (face->isHeadPoseEnabled()) {
                     face->updateHeadPose(headPoseDetector[i]);
                 }
 
-                face->landmarksEnable((facialLandmarksDetector.enabled() &&
-                                       i < facialLandmarksDetector.maxBatch));
+                face->landmarksEnable(facialLandmarksDetector.enabled());
                 if (face->isLandmarksEnabled()) {
                     face->updateLandmarks(facialLandmarksDetector[i]);
                 }
@@ -374,6 +370,13 @@ int main(int argc, char *argv[]) {
 
         slog::info << "Number of processed frames: " << framesCounter << slog::endl;
         slog::info << "Total image throughput: " << framesCounter * (1000.f / timer["total"].getTotalDuration()) << " fps" << slog::endl;
+        for (FaceAnalyticsDetection* detector : std::vector<FaceAnalyticsDetection*>{&ageGenderDetector, &headPoseDetector,
+                                                                                   &emotionsDetector, &facialLandmarksDetector}) {
+            if (detector->enabled()) {
+                slog::info << detector->topoName << " average queue time: "
+                           << detector->queueTime.getAverageDuration() << " ms" << slog::endl;
+            }
+        }
 
         // Showing performance results
         if (FLAGS_pc) {
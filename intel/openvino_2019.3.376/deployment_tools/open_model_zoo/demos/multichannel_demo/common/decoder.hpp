@@ -30,6 +30,7 @@ public:
         unsigned output_height = 0;
         unsigned num_buffers = 1;
         bool collect_stats = false;
+        cv::MatAllocator* allocator = nullptr;  // used for the decoded images
     };
 
     explicit Decoder(const Settings& s);
@@ -52,18 +53,22 @@ public:
 
         auto mode = settings.mode;
         if (Mode::Immediate == mode) {
-            auto img = cv::imdecode(
+            cv::Mat img;
+            img.allocator = settings.allocator;
+            cv::imdecode(
             {static_cast<const char*>(data),
              static_cast<int>(size)},
-                           cv::IMREAD_COLOR);
+                           cv::IMREAD_COLOR, &img);
             callback(std::move(img));
         } else if (Mode::Async == mode) {
 #ifdef USE_TBB
             auto decode = [data, size, c = std::move(callback), this]() mutable {
-                auto img = cv::imdecode(
+                cv::Mat img;
+                img.allocator = settings.allocator;
+                cv::imdecode(
                 {static_cast<const char*>(data),
                  static_cast<int>(size)},
-                            cv::IMREAD_COLOR);
+                            cv::IMREAD_COLOR, &img);
                 c(std::move(img));
             };
             auto& arena = get_tbb_arena();
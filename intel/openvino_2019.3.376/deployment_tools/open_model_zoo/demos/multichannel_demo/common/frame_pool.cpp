@@ -0,0 +1,82 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "frame_pool.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+struct VideoFramePool::Impl {
+    std::vector<std::unique_ptr<VideoFrame>> frames;
+    std::vector<VideoFrame*> freeFrames;
+    mutable std::mutex mutex;
+    std::condition_variable hasFrame;
+    bool stopped = false;
+    std::atomic<uint64_t> exhausted = {0};
+
+    void release(VideoFrame* frame) {
+        frame->frame.release();
+        frame->sourceIdx = 0;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            freeFrames.push_back(frame);
+        }
+        hasFrame.notify_one();
+    }
+};
+
+VideoFramePool::VideoFramePool(std::size_t capacity):
+    impl(std::make_shared<Impl>()) {
+    impl->frames.reserve(capacity);
+    impl->freeFrames.reserve(capacity);
+    for (std::size_t i = 0; i < capacity; i++) {
+        impl->frames.emplace_back(new VideoFrame);
+        impl->freeFrames.push_back(impl->frames.back().get());
+    }
+}
+
+VideoFramePool::~VideoFramePool() {
+    stop();
+}
+
+std::shared_ptr<VideoFrame> VideoFramePool::acquire() {
+    VideoFrame* frame = nullptr;
+    {
+        std::unique_lock<std::mutex> lock(impl->mutex);
+        if (impl->freeFrames.empty() && !impl->stopped) {
+            ++impl->exhausted;
+            impl->hasFrame.wait(lock, [&]() {
+                return !impl->freeFrames.empty() || impl->stopped;
+            });
+        }
+        if (impl->stopped) {
+            return nullptr;
+        }
+        frame = impl->freeFrames.back();
+        impl->freeFrames.pop_back();
+    }
+    // the deleter keeps the frames alive if the pool is destroyed before the last frame is released
+    auto state = impl;
+    return std::shared_ptr<VideoFrame>(frame, [state](VideoFrame* f) {
+        state->release(f);
+    });
+}
+
+void VideoFramePool::stop() {
+    {
+        std::unique_lock<std::mutex> lock(impl->mutex);
+        impl->stopped = true;
+    }
+    impl->hasFrame.notify_all();
+}
+
+VideoFramePool::Stats VideoFramePool::getStats() const {
+    Stats ret;
+    std::unique_lock<std::mutex> lock(impl->mutex);
+    ret.capacity = impl->frames.size();
+    ret.inUse = impl->frames.size() - impl->freeFrames.size();
+    ret.exhausted = impl->exhausted;
+    return ret;
+}
@@ -0,0 +1,43 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "input.hpp"
+
+/**
+ * Fixed set of VideoFrame objects shared by the sources, the graph and the output.
+ * A frame returns to the pool when its last reference is dropped; its pixel buffer
+ * goes back to the Mat buffer pool and its detection storage is kept for the next use.
+ */
+class VideoFramePool final {
+public:
+    explicit VideoFramePool(std::size_t capacity);
+    VideoFramePool(const VideoFramePool&) = delete;
+    ~VideoFramePool();
+
+    /// Blocks while every frame is in use, returns nullptr once the pool is stopped
+    std::shared_ptr<VideoFrame> acquire();
+
+    /// Wakes up the callers blocked in acquire()
+    void stop();
+
+    struct Stats {
+        std::size_t capacity = 0;
+        std::size_t inUse = 0;
+        uint64_t exhausted = 0;  // acquire() calls that had to wait for a free frame
+    };
+
+    Stats getStats() const;
+
+private:
+    struct Impl;
+    std::shared_ptr<Impl> impl;
+};
@@ -7,6 +7,8 @@
 #include <vector>
 #include <utility>
 #include <algorithm>
+#include <numeric>
+#include <functional>
 
 #include "graph.hpp"
 #include "threading.hpp"
@@ -15,28 +17,6 @@
 #include <tbb/parallel_for.h>
 #endif
 
-namespace {
-
-void loadImgToIEGraph(const cv::Mat& img, size_t batch, void* ieBuffer) {
-    const int channels = img.channels();
-    const int height = img.rows;
-    const int width = img.cols;
-
-    float* ieData = reinterpret_cast<float*>(ieBuffer);
-    int bOffset = static_cast<int>(batch) * channels * width * height;
-    for (int c = 0; c < channels; c++) {
-        int cOffset = c * width * height;
-        for (int w = 0; w < width; w++) {
-            for (int h = 0; h < height; h++) {
-                ieData[bOffset + cOffset + h * width + w] =
-                        static_cast<float>(img.at<cv::Vec3b>(h, w)[c]);
-            }
-        }
-    }
-}
-
-}  // namespace
-
 void IEGraph::initNetwork(const std::string& deviceName) {
     InferenceEngine::CNNNetReader  netReader;
 
@@ -77,14 +57,18 @@ void IEGraph::initNetwork(const std::string& deviceName) {
         netReader.getNetwork().reshape(inShapes);
     }
 
-    InferenceEngine::ExecutableNetwork network;
-    network = ie.LoadNetwork(netReader.getNetwork(), deviceName);
-
     InferenceEngine::InputsDataMap inputInfo(netReader.getNetwork().getInputsInfo());
     if (inputInfo.size() != 1) {
         throw std::logic_error("Face Detection network should have only one input");
     }
     inputDataBlobName = inputInfo.begin()->first;
+    // Frames are resized straight into interleaved U8 batch slots, the plugin does the layout conversion
+    inputInfo.begin()->second->setPrecision(InferenceEngine::Precision::U8);
+    inputInfo.begin()->second->getInputData()->setLayout(InferenceEngine::Layout::NHWC);
+    const InferenceEngine::TensorDesc inputDesc = inputInfo.begin()->second->getTensorDesc();
+
+    InferenceEngine::ExecutableNetwork network;
+    network = ie.LoadNetwork(netReader.getNetwork(), deviceName);
 
     InferenceEngine::OutputsDataMap outputInfo(netReader.getNetwork().getOutputsInfo());
     outputDataBlobNames.reserve(outputInfo.size());
@@ -92,13 +76,20 @@ void IEGraph::initNetwork(const std::string& deviceName) {
         outputDataBlobNames.push_back(i.first);
     }
 
+    // Input blobs of all requests share one pre-allocated pool
+    const size_t inputSize = std::accumulate(inputDesc.getDims().begin(), inputDesc.getDims().end(),
+                                             size_t(1), std::multiplies<size_t>());
+    inputBuffersPool.assign(maxRequests * inputSize, 0);
     for (size_t i = 0; i < maxRequests; ++i) {
         auto req = network.CreateInferRequestPtr();
+        req->SetBlob(inputDataBlobName,
+                     InferenceEngine::make_shared_blob<uint8_t>(inputDesc, &inputBuffersPool[i * inputSize], inputSize));
+        requests.push_back(req);
         availableRequests.push(req);
     }
 
-    availableRequests.front()->StartAsync();
-    availableRequests.front()->Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
+    requests.front()->StartAsync();
+    requests.front()->Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
 }
 
 void IEGraph::start(GetterFunc getterFunc, PostprocessingFunc postprocessingFunc) {
@@ -109,14 +100,16 @@ void IEGraph::start(GetterFunc getterFunc, PostprocessingFunc postprocessingFunc
     postprocessing = std::move(postprocessingFunc);
     getterThread = std::thread([&]() {
         std::vector<std::shared_ptr<VideoFrame>> vframes;
-        std::vector<cv::Mat> imgsToProc(batchSize);
         while (!terminate) {
             vframes.clear();
             size_t b = 0;
             while (b != batchSize) {
-                VideoFrame vframe;
-                if (getter(vframe)) {
-                    vframes.push_back(std::make_shared<VideoFrame>(vframe));
+                auto vframe = framePool.acquire();
+                if (nullptr == vframe) {
+                    break;
+                }
+                if (getter(*vframe)) {
+                    vframes.push_back(std::move(vframe));
                     ++b;
                 } else {
                     if (terminate) {
@@ -126,38 +119,24 @@ void IEGraph::start(GetterFunc getterFunc, PostprocessingFunc postprocessingFunc
             }
 
             InferenceEngine::InferRequest::Ptr req;
-            {
-                std::unique_lock<std::mutex> lock(mtxAvalableRequests);
-                condVarAvailableRequests.wait(lock, [&]() {
-                    return !availableRequests.empty() || terminate;
-                });
-                if (terminate) {
-                    break;
-                }
-                req = std::move(availableRequests.front());
-                availableRequests.pop();
+            Backoff backoff;
+            while (!terminate && !availableRequests.pop(req)) {
+                backoff.pause();
             }
-
-            auto inputBlob = req->GetBlob(inputDataBlobName);
-            imgsToProc.resize(batchSize);
-            for (size_t i = 0; i < batchSize; i++) {
-                if (imgsToProc[i].empty()) {
-                    auto& dims = inputBlob->getTensorDesc().getDims();
-                    assert(4 == dims.size());
-                    auto height = static_cast<int>(dims[2]);
-                    auto width  = static_cast<int>(dims[3]);
-                    imgsToProc[i] = cv::Mat(height, width, CV_8UC3);
-                }
+            if (terminate) {
+                break;
             }
 
             auto preprocess = [&]() {
-                auto buff = inputBlob->buffer();
-                float* inputPtr = static_cast<float*>(buff);
+                auto inputBlob = req->GetBlob(inputDataBlobName);
+                auto& dims = inputBlob->getTensorDesc().getDims();
+                assert(4 == dims.size());
+                const cv::Size slotSize(static_cast<int>(dims[3]), static_cast<int>(dims[2]));
+                const size_t slotLength = dims[1] * dims[2] * dims[3];
+                uint8_t* inputPtr = inputBlob->buffer().as<uint8_t*>();
                 auto loopBody = [&](size_t i) {
-                    cv::resize(vframes[i]->frame,
-                               imgsToProc[i],
-                               imgsToProc[i].size());
-                    loadImgToIEGraph(imgsToProc[i], i, inputPtr);
+                    cv::Mat slot(slotSize, CV_8UC3, inputPtr + i * slotLength);
+                    cv::resize(vframes[i]->frame, slot, slotSize);
                 };
 #ifdef USE_TBB
                 run_in_arena([&](){
@@ -170,6 +149,7 @@ void IEGraph::start(GetterFunc getterFunc, PostprocessingFunc postprocessingFunc
 #endif
             };
 
+            bool pushed = false;
             if (perfTimerInfer.enabled()) {
                 {
                     ScopedTimer st(perfTimerPreprocess);
@@ -177,16 +157,16 @@ void IEGraph::start(GetterFunc getterFunc, PostprocessingFunc postprocessingFunc
                 }
                 auto startTime = std::chrono::high_resolution_clock::now();
                 req->StartAsync();
-                std::unique_lock<std::mutex> lock(mtxBusyRequests);
-                busyBatchRequests.push({std::move(vframes), std::move(req), startTime});
+                pushed = busyBatchRequests.push({std::move(vframes), std::move(req), startTime});
             } else {
                 preprocess();
                 req->StartAsync();
-                std::unique_lock<std::mutex> lock(mtxBusyRequests);
-                busyBatchRequests.push({std::move(vframes), std::move(req),
-                                    std::chrono::high_resolution_clock::time_point()});
+                pushed = busyBatchRequests.push({std::move(vframes), std::move(req),
+                                                 std::chrono::high_resolution_clock::time_point()});
             }
-            condVarBusyRequests.notify_one();
+            // every entry holds one of maxRequests requests, so the queue can not overflow
+            assert(pushed);
+            (void)pushed;
         }
     });
 }
@@ -198,38 +178,33 @@ IEGraph::IEGraph(const InitParams& p):
     modelPath(p.modelPath), weightsPath(p.weightsPath),
     cpuExtensionPath(p.cpuExtPath), cldnnConfigPath(p.cldnnConfigPath),
     printPerfReport(p.reportPerf), deviceName(p.deviceName),
-    maxRequests(p.maxRequests) {
+    maxRequests(p.maxRequests),
+    availableRequests(p.maxRequests),
+    busyBatchRequests(p.maxRequests),
+    framePool(p.framePoolSize > 0 ? p.framePoolSize : (p.maxRequests + 1) * p.batchSize) {
     assert(p.maxRequests > 0);
 
     initNetwork(p.deviceName);
 }
 
 InferenceEngine::SizeVector IEGraph::getInputDims() const {
-    assert(!availableRequests.empty());
-    auto inputBlob = availableRequests.front()->GetBlob(inputDataBlobName);
+    assert(!requests.empty());
+    auto inputBlob = requests.front()->GetBlob(inputDataBlobName);
     return inputBlob->getTensorDesc().getDims();
 }
 
 std::vector<std::shared_ptr<VideoFrame> > IEGraph::getBatchData(cv::Size frameSize) {
-    std::vector<std::shared_ptr<VideoFrame>> vframes;
-    InferenceEngine::InferRequest::Ptr req;
-    std::chrono::high_resolution_clock::time_point startTime;
-    {
-        std::unique_lock<std::mutex> lock(mtxBusyRequests);
-        condVarBusyRequests.wait(lock, [&]() {
-            return !busyBatchRequests.empty();
-        });
-        vframes = std::move(busyBatchRequests.front().vfPtrVec);
-        req = std::move(busyBatchRequests.front().req);
-        startTime = std::move(busyBatchRequests.front().startTime);
-        busyBatchRequests.pop();
+    BatchRequestDesc desc;
+    Backoff backoff;
+    while (!busyBatchRequests.pop(desc)) {
+        backoff.pause();
     }
+    std::vector<std::shared_ptr<VideoFrame>> vframes = std::move(desc.vfPtrVec);
+    InferenceEngine::InferRequest::Ptr req = std::move(desc.req);
+    std::chrono::high_resolution_clock::time_point startTime = desc.startTime;
 
     if (nullptr != req && InferenceEngine::OK == req->Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY)) {
-        auto detections = postprocessing(req, outputDataBlobNames, frameSize);
-        for (decltype(detections.size()) i = 0; i < detections.size(); i ++) {
-            vframes[i]->detections = std::move(detections[i]);
-        }
+        postprocessing(req, outputDataBlobNames, frameSize, vframes);
         if (perfTimerInfer.enabled()) {
             auto endTime = std::chrono::high_resolution_clock::now();
             perfTimerInfer.addValue(endTime - startTime);
@@ -237,10 +212,7 @@ std::vector<std::shared_ptr<VideoFrame> > IEGraph::getBatchData(cv::Size frameSi
     }
 
     if (nullptr != req) {
-        std::unique_lock<std::mutex> lock(mtxAvalableRequests);
         availableRequests.push(std::move(req));
-        lock.unlock();
-        condVarAvailableRequests.notify_one();
     }
 
     return vframes;
@@ -256,38 +228,27 @@ void IEGraph::setDetectionConfidence(float conf) {
 
 IEGraph::~IEGraph() {
     terminate = true;
-    {
-        std::unique_lock<std::mutex> lock(mtxAvalableRequests);
-        bool ready = false;
-        while (!ready) {
-            std::unique_lock<std::mutex> lock(mtxBusyRequests);
-            if (!busyBatchRequests.empty()) {
-                auto& req = busyBatchRequests.front().req;
-                if (nullptr != req) {
-                    req->Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
-                    availableRequests.push(std::move(req));
-                }
-                busyBatchRequests.pop();
-            }
-            if (availableRequests.size() == maxRequests) {
-                ready = true;
-            }
-        }
-        if (printPerfReport) {
-            slog::info << "Performance counts report" << slog::endl << slog::endl;
-            printPerformanceCounts(getFullDeviceName(ie, deviceName));
-        }
-        condVarAvailableRequests.notify_one();
-    }
+    framePool.stop();
     if (getterThread.joinable()) {
         getterThread.join();
     }
+    BatchRequestDesc desc;
+    while (busyBatchRequests.pop(desc)) {
+        if (nullptr != desc.req) {
+            desc.req->Wait(InferenceEngine::IInferRequest::WaitMode::RESULT_READY);
+            availableRequests.push(std::move(desc.req));
+        }
+    }
+    if (printPerfReport) {
+        slog::info << "Performance counts report" << slog::endl << slog::endl;
+        printPerformanceCounts(getFullDeviceName(ie, deviceName));
+    }
 }
 
 IEGraph::Stats IEGraph::getStats() const {
-    return Stats{perfTimerPreprocess.getValue(), perfTimerInfer.getValue()};
+    return Stats{perfTimerPreprocess.getValue(), perfTimerInfer.getValue(), framePool.getStats().exhausted};
 }
 
 void IEGraph::printPerformanceCounts(std::string fullDeviceName) {
-    ::printPerformanceCounts(*availableRequests.front(), std::cout, fullDeviceName, false);
+    ::printPerformanceCounts(*requests.front(), std::cout, fullDeviceName, false);
 }
@@ -24,15 +24,15 @@
 #include <ie_plugin_config.hpp>
 
 #include <samples/common.hpp>
+#include <samples/lock_free_queue.hpp>
 #include <samples/slog.hpp>
 #include "perf_timer.hpp"
 #include "input.hpp"
+#include "frame_pool.hpp"
 #ifdef WITH_EXTENSIONS
 #include <ext_list.hpp>
 #endif
 
-void loadImageToIEGraph(cv::Mat img, void* ie_buffer);
-
 class VideoFrame;
 
 class IEGraph{
@@ -56,26 +56,30 @@ private:
     std::string deviceName;
 
     InferenceEngine::Core ie;
-    std::queue<InferenceEngine::InferRequest::Ptr> availableRequests;
+    std::vector<InferenceEngine::InferRequest::Ptr> requests;
+    std::vector<uint8_t> inputBuffersPool;
 
     struct BatchRequestDesc {
         std::vector<std::shared_ptr<VideoFrame>> vfPtrVec;
         InferenceEngine::InferRequest::Ptr req;
         std::chrono::high_resolution_clock::time_point startTime;
     };
-    std::queue<BatchRequestDesc> busyBatchRequests;
 
     std::size_t maxRequests = 0;
 
+    // returned by the main thread, taken by the getter thread
+    MPMCQueue<InferenceEngine::InferRequest::Ptr> availableRequests;
+    // filled by the getter thread, drained by getBatchData()
+    SPSCQueue<BatchRequestDesc> busyBatchRequests;
+
+    VideoFramePool framePool;
+
     std::atomic_bool terminate = {false};
-    std::mutex mtxAvalableRequests;
-    std::mutex mtxBusyRequests;
-    std::condition_variable condVarAvailableRequests;
-    std::condition_variable condVarBusyRequests;
 
     using GetterFunc = std::function<bool(VideoFrame&)>;
     GetterFunc getter;
-    using PostprocessingFunc = std::function<std::vector<Detections>(InferenceEngine::InferRequest::Ptr, const std::vector<std::string>&, cv::Size)>;
+    using PostprocessingFunc = std::function<void(InferenceEngine::InferRequest::Ptr, const std::vector<std::string>&, cv::Size,
+                                                  const std::vector<std::shared_ptr<VideoFrame>>&)>;
     PostprocessingFunc postprocessing;
     std::thread getterThread;
 
@@ -85,6 +89,7 @@ public:
     struct InitParams {
         std::size_t batchSize = 1;
         std::size_t maxRequests = 5;
+        std::size_t framePoolSize = 0;  // 0 means just enough frames to fill every request
         bool collectStats = false;
         bool reportPerf = false;
         std::string modelPath;
@@ -111,6 +116,7 @@ public:
     struct Stats {
         float preprocessTime;
         float inferTime;
+        uint64_t framePoolExhausted;
     };
 
     Stats getStats() const;
@@ -497,6 +497,7 @@ template<bool CollectStats>
 void VideoSourceOCV::thread_fn(VideoSourceOCV *vs) {
     while (!vs->terminate) {
         cv::Mat frame;
+        frame.allocator = &get_mat_buffer_pool();
         bool result = false;
         while (!((result = vs->readFrame<CollectStats>(frame)) || vs->terminate)) {
             std::unique_lock<std::mutex> lock(vs->mutex);
@@ -568,6 +569,9 @@ bool VideoSourceOCV::read(cv::Mat& frame) {
         condVar.notify_one();
         return res;
     } else {
+        if (frame.empty()) {
+            frame.allocator = &get_mat_buffer_pool();
+        }
         return source.read(frame);
     }
 }
@@ -591,6 +595,7 @@ Decoder::Settings makeDecoderSettings(bool collectStats, std::size_t queueSize,
     ret.mode = Decoder::Mode::Immediate;
 #endif
     ret.collect_stats = collectStats;
+    ret.allocator = &get_mat_buffer_pool();
     return ret;
 }
 }  // namespace
@@ -674,6 +679,7 @@ VideoSources::Stats VideoSources::getStats() const {
             ret.readTimes.push_back(input->getAvgReadTime());
         }
         ret.decodingLatency = decoder.getStats().decoding_latency;
+        ret.bufferAllocations = get_mat_buffer_pool().getStats().allocations;
     }
     return ret;
 }
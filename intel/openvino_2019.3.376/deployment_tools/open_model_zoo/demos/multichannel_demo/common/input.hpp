@@ -20,6 +20,7 @@
 #endif
 
 #include "decoder.hpp"
+#include "mat_buffer_pool.hpp"
 
 class Detections {
 public:
@@ -28,9 +29,24 @@ public:
     }
     template <typename T> void set(T* detections) {
         this->detections.reset(detections);
+        type = typeTag<T>();
+    }
+    /// Returns empty detections of type T, reusing the storage of the previous frame if it held a T
+    template <typename T> T& reset() {
+        if (nullptr == detections || typeTag<T>() != type) {
+            set(new T);
+        }
+        T& ret = get<T>();
+        ret.clear();
+        return ret;
     }
 private:
+    template <typename T> static const void* typeTag() {
+        static const char tag = 0;
+        return &tag;
+    }
     std::shared_ptr<void> detections;
+    const void* type = nullptr;
 };
 
 class VideoFrame final {
@@ -95,6 +111,7 @@ public:
     struct Stats {
         std::vector<float> readTimes;
         float decodingLatency = 0.0f;
+        uint64_t bufferAllocations = 0;
     };
 
     Stats getStats() const;
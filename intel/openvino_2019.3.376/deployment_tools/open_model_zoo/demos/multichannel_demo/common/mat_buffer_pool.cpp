@@ -0,0 +1,88 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include "mat_buffer_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+MatBufferPool::~MatBufferPool() {
+    for (auto& buffer : freeBuffers) {
+        cv::fastFree(buffer.second);
+    }
+}
+
+cv::UMatData* MatBufferPool::allocate(int dims, const int* sizes, int type, void* data,
+                                      size_t* step, cv::AccessFlag /*flags*/,
+                                      cv::UMatUsageFlags /*usageFlags*/) const {
+    size_t total = CV_ELEM_SIZE(type);
+    for (int i = dims - 1; i >= 0; i--) {
+        if (step) {
+            if (data && step[i] != cv::Mat::AUTO_STEP) {
+                total = step[i];
+            } else {
+                step[i] = total;
+            }
+        }
+        total *= sizes[i];
+    }
+
+    uchar* buffer = static_cast<uchar*>(data);
+    if (!buffer) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = std::find_if(freeBuffers.begin(), freeBuffers.end(),
+                               [total](const std::pair<size_t, uchar*>& b) { return b.first == total; });
+        if (it != freeBuffers.end()) {
+            buffer = it->second;
+            *it = freeBuffers.back();
+            freeBuffers.pop_back();
+            lock.unlock();
+            ++reuses;
+        } else {
+            lock.unlock();
+            buffer = static_cast<uchar*>(cv::fastMalloc(total));
+            ++allocations;
+        }
+    }
+
+    cv::UMatData* u = new cv::UMatData(this);
+    u->data = u->origdata = buffer;
+    u->size = total;
+    if (data) {
+        u->flags |= cv::UMatData::USER_ALLOCATED;
+    }
+    return u;
+}
+
+bool MatBufferPool::allocate(cv::UMatData* data, cv::AccessFlag /*accessFlags*/,
+                             cv::UMatUsageFlags /*usageFlags*/) const {
+    return nullptr != data;
+}
+
+void MatBufferPool::deallocate(cv::UMatData* data) const {
+    if (!data) {
+        return;
+    }
+    CV_Assert(data->urefcount == 0);
+    CV_Assert(data->refcount == 0);
+    if (!(data->flags & cv::UMatData::USER_ALLOCATED)) {
+        std::unique_lock<std::mutex> lock(mutex);
+        freeBuffers.emplace_back(data->size, data->origdata);
+        data->origdata = nullptr;
+    }
+    delete data;
+}
+
+MatBufferPool::Stats MatBufferPool::getStats() const {
+    Stats ret;
+    ret.allocations = allocations;
+    ret.reuses = reuses;
+    return ret;
+}
+
+MatBufferPool& get_mat_buffer_pool() {
+    static MatBufferPool pool;
+    return pool;
+}
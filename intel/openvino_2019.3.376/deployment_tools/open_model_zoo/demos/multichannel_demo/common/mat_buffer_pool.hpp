@@ -0,0 +1,49 @@
+// Copyright (C) 2018-2019 Intel Corporation
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * cv::Mat allocator that keeps released buffers and hands them out again
+ * for requests of the same size. Decoded frames all have the same few sizes,
+ * so after warm-up frames stop hitting the heap.
+ * Assign it to cv::Mat::allocator before the Mat is filled by a reader or a decoder.
+ */
+class MatBufferPool final : public cv::MatAllocator {
+public:
+    MatBufferPool() = default;
+    MatBufferPool(const MatBufferPool&) = delete;
+    ~MatBufferPool();
+
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                           size_t* step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usageFlags) const override;
+    bool allocate(cv::UMatData* data, cv::AccessFlag accessFlags,
+                  cv::UMatUsageFlags usageFlags) const override;
+    void deallocate(cv::UMatData* data) const override;
+
+    struct Stats {
+        uint64_t allocations = 0;  // buffers taken from the heap because none was free
+        uint64_t reuses = 0;       // buffers handed out again
+    };
+
+    Stats getStats() const;
+
+private:
+    mutable std::mutex mutex;
+    mutable std::vector<std::pair<size_t, uchar*>> freeBuffers;
+    mutable std::atomic<uint64_t> allocations = {0};
+    mutable std::atomic<uint64_t> reuses = {0};
+};
+
+/// Process-wide pool, it outlives every frame allocated from it
+MatBufferPool& get_mat_buffer_pool();
@@ -226,23 +226,6 @@ int main(int argc, char* argv[]) {
         slog::info << "Model   path: " << modelPath << slog::endl;
         slog::info << "Weights path: " << weightsPath << slog::endl;
 
-        IEGraph::InitParams graphParams;
-        graphParams.batchSize       = FLAGS_bs;
-        graphParams.maxRequests     = FLAGS_nireq;
-        graphParams.collectStats    = FLAGS_show_stats;
-        graphParams.reportPerf      = FLAGS_pc;
-        graphParams.modelPath       = modelPath;
-        graphParams.weightsPath     = weightsPath;
-        graphParams.cpuExtPath      = FLAGS_l;
-        graphParams.cldnnConfigPath = FLAGS_c;
-        graphParams.deviceName      = FLAGS_d;
-
-        std::shared_ptr<IEGraph> network(new IEGraph(graphParams));
-        auto inputDims = network->getInputDims();
-        if (4 != inputDims.size()) {
-            throw std::runtime_error("Invalid network input dimensions");
-        }
-
         std::vector<std::string> files;
         parseInputFilesArguments(files);
 
@@ -260,6 +243,25 @@ int main(int argc, char* argv[]) {
             throw std::logic_error("Number of inputs exceed maximum value [25]");
         }
 
+        IEGraph::InitParams graphParams;
+        graphParams.batchSize       = FLAGS_bs;
+        graphParams.maxRequests     = FLAGS_nireq;
+        graphParams.collectStats    = FLAGS_show_stats;
+        graphParams.reportPerf      = FLAGS_pc;
+        graphParams.modelPath       = modelPath;
+        graphParams.weightsPath     = weightsPath;
+        graphParams.cpuExtPath      = FLAGS_l;
+        graphParams.cldnnConfigPath = FLAGS_c;
+        graphParams.deviceName      = FLAGS_d;
+        // frames held by the requests, the batch being filled, the display batch and the output queue
+        graphParams.framePoolSize   = (FLAGS_nireq + 2) * FLAGS_bs + 3 * numberOfInputs;
+
+        std::shared_ptr<IEGraph> network(new IEGraph(graphParams));
+        auto inputDims = network->getInputDims();
+        if (4 != inputDims.size()) {
+            throw std::runtime_error("Invalid network input dimensions");
+        }
+
         VideoSources::InitParams vsParams;
         vsParams.queueSize            = FLAGS_n_iqs;
         vsParams.collectStats         = FLAGS_show_stats;
@@ -299,7 +301,8 @@ int main(int argc, char* argv[]) {
             auto camIdx = currentFrame / duplicateFactor;
             currentFrame = (currentFrame + 1) % numberOfInputs;
             return sources.getFrame(camIdx, img);
-        }, [](InferenceEngine::InferRequest::Ptr req, const std::vector<std::string>& outputDataBlobNames, cv::Size frameSize) {
+        }, [](InferenceEngine::InferRequest::Ptr req, const std::vector<std::string>& outputDataBlobNames, cv::Size frameSize,
+              const std::vector<std::shared_ptr<VideoFrame>>& frames) {
             auto output = req->GetBlob(outputDataBlobNames[0]);
 
             float* dataPtr = output->buffer();
@@ -310,9 +313,8 @@ int main(int argc, char* argv[]) {
             }
 
 
-            std::vector<Detections> detections(getTensorHeight(output->getTensorDesc()) / 200);
-            for (auto& d : detections) {
-                d.set(new std::vector<Face>);
+            for (auto& frame : frames) {
+                frame->detections.reset<std::vector<Face>>();
             }
 
             for (size_t i = 0; i < total; i+=7) {
@@ -325,10 +327,9 @@ int main(int argc, char* argv[]) {
                     float y1 = std::min(std::max(0.0f, dataPtr[i + 6]), 1.0f);
 
                     cv::Rect2f rect = {x0 , y0, x1-x0, y1-y0};
-                    detections[idxInBatch].get<std::vector<Face>>().emplace_back(rect, conf, 0, 0);
+                    frames[idxInBatch]->detections.get<std::vector<Face>>().emplace_back(rect, conf, 0, 0);
                 }
             }
-            return detections;
         });
 
         network->setDetectionConfidence(static_cast<float>(FLAGS_t));
@@ -436,6 +437,12 @@ int main(int argc, char* argv[]) {
                     statStream << "Plugin latency: "
                                << inferStat.inferTime << "ms";
                     statStream << std::endl;
+                    statStream << "Frame pool waits: "
+                               << inferStat.framePoolExhausted;
+                    statStream << std::endl;
+                    statStream << "Frame buffer allocations: "
+                               << inputStat.bufferAllocations;
+                    statStream << std::endl;
 
                     statStream << "Render time: " << outputStat.renderTime
                                << "ms" << std::endl;
@@ -224,23 +224,6 @@ int main(int argc, char* argv[]) {
         slog::info << "Model   path: " << modelPath << slog::endl;
         slog::info << "Weights path: " << weightsPath << slog::endl;
 
-        IEGraph::InitParams graphParams;
-        graphParams.batchSize       = FLAGS_bs;
-        graphParams.maxRequests     = FLAGS_nireq;
-        graphParams.collectStats    = FLAGS_show_stats;
-        graphParams.reportPerf      = FLAGS_pc;
-        graphParams.modelPath       = modelPath;
-        graphParams.weightsPath     = weightsPath;
-        graphParams.cpuExtPath      = FLAGS_l;
-        graphParams.cldnnConfigPath = FLAGS_c;
-        graphParams.deviceName      = FLAGS_d;
-
-        std::shared_ptr<IEGraph> network(new IEGraph(graphParams));
-        auto inputDims = network->getInputDims();
-        if (4 != inputDims.size()) {
-            throw std::runtime_error("Invalid network input dimensions");
-        }
-
         std::vector<std::string> files;
         parseInputFilesArguments(files);
 
@@ -258,6 +241,25 @@ int main(int argc, char* argv[]) {
             throw std::logic_error("Number of inputs exceed maximum value [25]");
         }
 
+        IEGraph::InitParams graphParams;
+        graphParams.batchSize       = FLAGS_bs;
+        graphParams.maxRequests     = FLAGS_nireq;
+        graphParams.collectStats    = FLAGS_show_stats;
+        graphParams.reportPerf      = FLAGS_pc;
+        graphParams.modelPath       = modelPath;
+        graphParams.weightsPath     = weightsPath;
+        graphParams.cpuExtPath      = FLAGS_l;
+        graphParams.cldnnConfigPath = FLAGS_c;
+        graphParams.deviceName      = FLAGS_d;
+        // frames held by the requests, the batch being filled, the display batch and the output queue
+        graphParams.framePoolSize   = (FLAGS_nireq + 2) * FLAGS_bs + 3 * numberOfInputs;
+
+        std::shared_ptr<IEGraph> network(new IEGraph(graphParams));
+        auto inputDims = network->getInputDims();
+        if (4 != inputDims.size()) {
+            throw std::runtime_error("Invalid network input dimensions");
+        }
+
         VideoSources::InitParams vsParams;
         vsParams.queueSize            = FLAGS_n_iqs;
         vsParams.collectStats         = FLAGS_show_stats;
@@ -297,7 +299,8 @@ int main(int argc, char* argv[]) {
             auto camIdx = currentFrame / duplicateFactor;
             currentFrame = (currentFrame + 1) % numberOfInputs;
             return sources.getFrame(camIdx, img);
-        }, [](InferenceEngine::InferRequest::Ptr req, const std::vector<std::string>& outputDataBlobNames, cv::Size frameSize) {
+        }, [](InferenceEngine::InferRequest::Ptr req, const std::vector<std::string>& outputDataBlobNames, cv::Size frameSize,
+              const std::vector<std::shared_ptr<VideoFrame>>& frames) {
             auto pafsBlobIt   = req->GetBlob(outputDataBlobNames[0]);
             auto pafsDesc     = pafsBlobIt->getTensorDesc();
             auto pafsWidth    = getTensorWidth(pafsDesc);
@@ -310,25 +313,20 @@ int main(int argc, char* argv[]) {
             auto heatMapsWidth    = getTensorWidth(heatMapsDesc);
             auto heatMapsHeight   = getTensorHeight(heatMapsDesc);
             auto heatMapsChannels = getTensorChannels(heatMapsDesc);
-            std::vector<Detections> detections(pafsBatch);
 
 
             for (size_t i = 0; i < pafsBatch; i++) {
-                std::vector<HumanPose> poses = postprocess(
+                // poses are written to the storage the frame recycles from its previous use
+                postprocess(
                 static_cast<float*>(heatMapsBlobIt->buffer()) + i * heatMapsWidth * heatMapsHeight * heatMapsChannels,
                 heatMapsWidth * heatMapsHeight,
                 keypointsNumber,
                 static_cast<float*>(pafsBlobIt->buffer()) + i * pafsWidth * pafsHeight * pafsChannels,
                 pafsWidth * pafsHeight,
                 pafsChannels,
-                heatMapsWidth, heatMapsHeight, frameSize);
-
-                detections[i].set(new std::vector<HumanPose>(poses.size()));
-                for (decltype(poses.size()) j = 0; j < poses.size(); j++) {
-                    detections[i].get<std::vector<HumanPose>>()[j] = std::move(poses[j]);
-                }
+                heatMapsWidth, heatMapsHeight, frameSize,
+                frames[i]->detections.reset<std::vector<HumanPose>>());
             }
-            return detections;
         });
 
         std::atomic<float> averageFps = {0.0f};
@@ -434,6 +432,12 @@ int main(int argc, char* argv[]) {
                     statStream << "Plugin latency: "
                                << inferStat.inferTime << "ms";
                     statStream << std::endl;
+                    statStream << "Frame pool waits: "
+                               << inferStat.framePoolExhausted;
+                    statStream << std::endl;
+                    statStream << "Frame buffer allocations: "
+                               << inputStat.bufferAllocations;
+                    statStream << std::endl;
 
                     statStream << "Render time: " << outputStat.renderTime
                                << "ms" << std::endl;
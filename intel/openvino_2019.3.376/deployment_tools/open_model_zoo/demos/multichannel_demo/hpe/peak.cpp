@@ -15,11 +15,152 @@
 */
 
 #include <algorithm>
+#include <cmath>
 #include <utility>
 #include <vector>
 
+#include <opencv2/imgproc/imgproc.hpp>
+
 #include "peak.hpp"
 
+namespace {
+// Bilinear sample of a network-resolution map at a point given in coordinates
+// of the map upsampled by upsampleRatio (pixel centers aligned as in cv::resize)
+float sampleUpsampled(const cv::Mat& map, const cv::Point2f& point, const int upsampleRatio) {
+    float x = (point.x + 0.5f) / upsampleRatio - 0.5f;
+    float y = (point.y + 0.5f) / upsampleRatio - 0.5f;
+    x = std::min(std::max(x, 0.0f), static_cast<float>(map.cols - 1));
+    y = std::min(std::max(y, 0.0f), static_cast<float>(map.rows - 1));
+    int x0 = static_cast<int>(x);
+    int y0 = static_cast<int>(y);
+    int x1 = std::min(x0 + 1, map.cols - 1);
+    int y1 = std::min(y0 + 1, map.rows - 1);
+    float dx = x - x0;
+    float dy = y - y0;
+    const float* row0 = map.ptr<float>(y0);
+    const float* row1 = map.ptr<float>(y1);
+    return (1 - dy) * ((1 - dx) * row0[x0] + dx * row0[x1])
+            + dy * ((1 - dx) * row1[x0] + dx * row1[x1]);
+}
+
+// Offset of the vertex of the parabola through (-1, prev), (0, center), (1, next)
+float parabolaVertex(const float prev, const float center, const float next) {
+    float curvature = prev - 2 * center + next;
+    if (curvature >= 0) {
+        return 0.0f;
+    }
+    return std::min(std::max(0.5f * (prev - next) / curvature, -0.5f), 0.5f);
+}
+
+std::vector<TwoJointsConnection> scoreLimbConnections(const std::vector<Peak>& candA,
+                                                      const std::vector<Peak>& candB,
+                                                      const std::pair<cv::Mat, cv::Mat>& scoreMid,
+                                                      const float midPointsScoreThreshold,
+                                                      const float foundMidPointsRatioThreshold,
+                                                      const int upsampleRatio) {
+    std::vector<TwoJointsConnection> tempJointConnections;
+    const size_t nJointsA = candA.size();
+    const size_t nJointsB = candB.size();
+    for (size_t i = 0; i < nJointsA; i++) {
+        for (size_t j = 0; j < nJointsB; j++) {
+            cv::Point2f mid = candA[i].pos * 0.5 + candB[j].pos * 0.5;
+            cv::Point2f vec = candB[j].pos - candA[i].pos;
+            double norm_vec = cv::norm(vec);
+            if (norm_vec == 0) {
+                continue;
+            }
+            vec /= norm_vec;
+            float score = vec.x * sampleUpsampled(scoreMid.first, mid, upsampleRatio)
+                    + vec.y * sampleUpsampled(scoreMid.second, mid, upsampleRatio);
+            int height_n  = scoreMid.first.rows * upsampleRatio / 2;
+            float suc_ratio = 0.0f;
+            float mid_score = 0.0f;
+            const int mid_num = 10;
+            const float scoreThreshold = -100.0f;
+            if (score > scoreThreshold) {
+                float p_sum = 0;
+                int p_count = 0;
+                cv::Size2f step((candB[j].pos.x - candA[i].pos.x)/(mid_num - 1),
+                                (candB[j].pos.y - candA[i].pos.y)/(mid_num - 1));
+                for (int n = 0; n < mid_num; n++) {
+                    cv::Point2f midPoint(candA[i].pos.x + n * step.width,
+                                         candA[i].pos.y + n * step.height);
+                    cv::Point2f pred(sampleUpsampled(scoreMid.first, midPoint, upsampleRatio),
+                                     sampleUpsampled(scoreMid.second, midPoint, upsampleRatio));
+                    score = vec.x * pred.x + vec.y * pred.y;
+                    if (score > midPointsScoreThreshold) {
+                        p_sum += score;
+                        p_count++;
+                    }
+                }
+                suc_ratio = static_cast<float>(p_count / mid_num);
+                float ratio = p_count > 0 ? p_sum / p_count : 0.0f;
+                mid_score = ratio + static_cast<float>(std::min(height_n / norm_vec - 1, 0.0));
+            }
+            if (mid_score > 0
+                    && suc_ratio > foundMidPointsRatioThreshold) {
+                tempJointConnections.push_back(TwoJointsConnection(i, j, mid_score));
+            }
+        }
+    }
+    if (!tempJointConnections.empty()) {
+        std::sort(tempJointConnections.begin(), tempJointConnections.end(),
+                  [](const TwoJointsConnection& a,
+                     const TwoJointsConnection& b) {
+            return (a.score > b.score);
+        });
+    }
+    return tempJointConnections;
+}
+
+class ScoreLimbsBody: public cv::ParallelLoopBody {
+public:
+    ScoreLimbsBody(const std::vector<std::vector<Peak> >& allPeaks,
+                   const std::vector<cv::Mat>& pafs,
+                   const std::vector<std::pair<int, int> >& limbIdsHeatmap,
+                   const std::vector<std::pair<int, int> >& limbIdsPaf,
+                   const int mapIdxOffset,
+                   const float midPointsScoreThreshold,
+                   const float foundMidPointsRatioThreshold,
+                   const int upsampleRatio,
+                   std::vector<std::vector<TwoJointsConnection> >& limbConnections)
+        : allPeaks(allPeaks),
+          pafs(pafs),
+          limbIdsHeatmap(limbIdsHeatmap),
+          limbIdsPaf(limbIdsPaf),
+          mapIdxOffset(mapIdxOffset),
+          midPointsScoreThreshold(midPointsScoreThreshold),
+          foundMidPointsRatioThreshold(foundMidPointsRatioThreshold),
+          upsampleRatio(upsampleRatio),
+          limbConnections(limbConnections) {}
+
+    virtual void operator()(const cv::Range& range) const {
+        for (int k = range.start; k < range.end; k++) {
+            const std::vector<Peak>& candA = allPeaks[limbIdsHeatmap[k].first - 1];
+            const std::vector<Peak>& candB = allPeaks[limbIdsHeatmap[k].second - 1];
+            if (candA.empty() || candB.empty()) {
+                continue;
+            }
+            std::pair<cv::Mat, cv::Mat> scoreMid = { pafs[limbIdsPaf[k].first - mapIdxOffset],
+                                                     pafs[limbIdsPaf[k].second - mapIdxOffset] };
+            limbConnections[k] = scoreLimbConnections(candA, candB, scoreMid, midPointsScoreThreshold,
+                                                      foundMidPointsRatioThreshold, upsampleRatio);
+        }
+    }
+
+private:
+    const std::vector<std::vector<Peak> >& allPeaks;
+    const std::vector<cv::Mat>& pafs;
+    const std::vector<std::pair<int, int> >& limbIdsHeatmap;
+    const std::vector<std::pair<int, int> >& limbIdsPaf;
+    int mapIdxOffset;
+    float midPointsScoreThreshold;
+    float foundMidPointsRatioThreshold;
+    int upsampleRatio;
+    std::vector<std::vector<TwoJointsConnection> >& limbConnections;
+};
+}  // namespace
+
 Peak::Peak(const int id, const cv::Point2f& pos, const float score)
     : id(id),
       pos(pos),
@@ -40,89 +181,84 @@ TwoJointsConnection::TwoJointsConnection(const int firstJointIdx,
 void findPeaks(const std::vector<cv::Mat>& heatMaps,
                const float minPeaksDistance,
                std::vector<std::vector<Peak> >& allPeaks,
-               int heatMapId) {
+               int heatMapId,
+               const int upsampleRatio) {
     const float threshold = 0.1f;
-    std::vector<cv::Point> peaks;
     const cv::Mat& heatMap = heatMaps[heatMapId];
-    const float* heatMapData = heatMap.ptr<float>();
-    size_t heatMapStep = heatMap.step1();
-    for (int y = -1; y < heatMap.rows + 1; y++) {
-        for (int x = -1; x < heatMap.cols + 1; x++) {
-            float val = 0;
-            if (x >= 0
-                    && y >= 0
-                    && x < heatMap.cols
-                    && y < heatMap.rows) {
-                val = heatMapData[y * heatMapStep + x];
-                val = val >= threshold ? val : 0;
-            }
-
-            float left_val = 0;
-            if (y >= 0
-                    && x < (heatMap.cols - 1)
-                    && y < heatMap.rows) {
-                left_val = heatMapData[y * heatMapStep + x + 1];
-                left_val = left_val >= threshold ? left_val : 0;
-            }
-
-            float right_val = 0;
-            if (x > 0
-                    && y >= 0
-                    && y < heatMap.rows) {
-                right_val = heatMapData[y * heatMapStep + x - 1];
-                right_val = right_val >= threshold ? right_val : 0;
-            }
-
-            float top_val = 0;
-            if (x >= 0
-                    && x < heatMap.cols
-                    && y < (heatMap.rows - 1)) {
-                top_val = heatMapData[(y + 1) * heatMapStep + x];
-                top_val = top_val >= threshold ? top_val : 0;
-            }
 
-            float bottom_val = 0;
-            if (x >= 0
-                    && y > 0
-                    && x < heatMap.cols) {
-                bottom_val = heatMapData[(y - 1) * heatMapStep + x];
-                bottom_val = bottom_val >= threshold ? bottom_val : 0;
-            }
+    // A pixel is a peak if it is greater than its 4 neighbours, values below threshold count as 0.
+    // The map is compared with the maximum of its neighbours, both computed by vectorized OpenCV kernels.
+    cv::Mat thresholded;
+    cv::threshold(heatMap, thresholded, std::nextafter(threshold, 0.0f), 0, cv::THRESH_TOZERO);
+    cv::Mat neighbours = (cv::Mat_<uchar>(3, 3) << 0, 1, 0,
+                                                   1, 0, 1,
+                                                   0, 1, 0);
+    cv::Mat neighboursMax;
+    cv::dilate(thresholded, neighboursMax, neighbours, cv::Point(-1, -1), 1,
+               cv::BORDER_CONSTANT, cv::Scalar::all(0));
+    std::vector<cv::Point> peaks;
+    cv::findNonZero(thresholded > neighboursMax, peaks);
 
-            if ((val > left_val)
-                    && (val > right_val)
-                    && (val > top_val)
-                    && (val > bottom_val)) {
-                peaks.push_back(cv::Point(x, y));
-            }
+    // Refine peaks to sub-pixel positions in coordinates of the upsampled map
+    std::vector<Peak> candidates;
+    candidates.reserve(peaks.size());
+    for (const auto& peak : peaks) {
+        const float* row = heatMap.ptr<float>(peak.y);
+        float dx = 0.0f;
+        float dy = 0.0f;
+        if (peak.x > 0 && peak.x < heatMap.cols - 1) {
+            dx = parabolaVertex(row[peak.x - 1], row[peak.x], row[peak.x + 1]);
+        }
+        if (peak.y > 0 && peak.y < heatMap.rows - 1) {
+            dy = parabolaVertex(heatMap.at<float>(peak.y - 1, peak.x), row[peak.x],
+                                heatMap.at<float>(peak.y + 1, peak.x));
         }
+        cv::Point2f pos((peak.x + dx + 0.5f) * upsampleRatio - 0.5f,
+                        (peak.y + dy + 0.5f) * upsampleRatio - 0.5f);
+        candidates.push_back(Peak(-1, pos, row[peak.x]));
     }
-    std::sort(peaks.begin(), peaks.end(), [](const cv::Point& a, const cv::Point& b) {
-        return a.x < b.x;
+    std::sort(candidates.begin(), candidates.end(), [](const Peak& a, const Peak& b) {
+        return a.score > b.score;
     });
-    std::vector<bool> isActualPeak(peaks.size(), true);
-    int peakCounter = 0;
+
+    // Keep the strongest of the peaks closer than minPeaksDistance. Kept peaks are bucketed
+    // into cells of minPeaksDistance size, so only the 3x3 surrounding cells have to be checked.
+    const float cellSize = std::max(minPeaksDistance, 1.0f);
+    const int gridCols = static_cast<int>(heatMap.cols * upsampleRatio / cellSize) + 1;
+    const int gridRows = static_cast<int>(heatMap.rows * upsampleRatio / cellSize) + 1;
+    std::vector<std::vector<int> > grid(gridCols * gridRows);
     std::vector<Peak>& peaksWithScoreAndID = allPeaks[heatMapId];
-    for (size_t i = 0; i < peaks.size(); i++) {
-        if (isActualPeak[i]) {
-            for (size_t j = i + 1; j < peaks.size(); j++) {
-                if (sqrt((peaks[i].x - peaks[j].x) * (peaks[i].x - peaks[j].x) +
-                         (peaks[i].y - peaks[j].y) * (peaks[i].y - peaks[j].y)) < minPeaksDistance) {
-                    isActualPeak[j] = false;
+    for (const auto& candidate : candidates) {
+        int cellX = std::min(std::max(static_cast<int>(candidate.pos.x / cellSize), 0), gridCols - 1);
+        int cellY = std::min(std::max(static_cast<int>(candidate.pos.y / cellSize), 0), gridRows - 1);
+        bool isActualPeak = true;
+        for (int y = std::max(cellY - 1, 0); y <= std::min(cellY + 1, gridRows - 1) && isActualPeak; y++) {
+            for (int x = std::max(cellX - 1, 0); x <= std::min(cellX + 1, gridCols - 1) && isActualPeak; x++) {
+                for (int keptId : grid[y * gridCols + x]) {
+                    if (cv::norm(peaksWithScoreAndID[keptId].pos - candidate.pos) < minPeaksDistance) {
+                        isActualPeak = false;
+                        break;
+                    }
                 }
             }
-            peaksWithScoreAndID.push_back(Peak(peakCounter++, peaks[i], heatMap.at<float>(peaks[i])));
+        }
+        if (isActualPeak) {
+            int peakCounter = static_cast<int>(peaksWithScoreAndID.size());
+            grid[cellY * gridCols + cellX].push_back(peakCounter);
+            peaksWithScoreAndID.push_back(Peak(peakCounter, candidate.pos, candidate.score));
         }
     }
 }
 
-std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >& allPeaks,
+void groupPeaksToPoses(const std::vector<std::vector<Peak> >& allPeaks,
                                          const std::vector<cv::Mat>& pafs,
                                          const size_t keypointsNumber,
                                          const float midPointsScoreThreshold,
                                          const float foundMidPointsRatioThreshold,
                                          const int minJointsNumber,
-                                         const float minSubsetScore) {
+                                         const float minSubsetScore,
+                                         const int upsampleRatio,
+                                         std::vector<HumanPose>& poses) {
     const std::vector<std::pair<int, int> > limbIdsHeatmap = {
         {2, 3}, {2, 6}, {3, 4}, {4, 5}, {6, 7}, {7, 8}, {2, 9}, {9, 10}, {10, 11}, {2, 12}, {12, 13}, {13, 14},
         {2, 1}, {1, 15}, {15, 17}, {1, 16}, {16, 18}, {3, 17}, {6, 18}
@@ -136,12 +272,17 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
     for (const auto& peaks : allPeaks) {
          candidates.insert(candidates.end(), peaks.begin(), peaks.end());
     }
+    // PAF line integrals of all limb types are independent, score them in parallel
+    const int mapIdxOffset = keypointsNumber + 1;
+    std::vector<std::vector<TwoJointsConnection> > limbConnections(limbIdsPaf.size());
+    ScoreLimbsBody scoreLimbsBody(allPeaks, pafs, limbIdsHeatmap, limbIdsPaf, mapIdxOffset,
+                                  midPointsScoreThreshold, foundMidPointsRatioThreshold,
+                                  upsampleRatio, limbConnections);
+    cv::parallel_for_(cv::Range(0, static_cast<int>(limbIdsPaf.size())), scoreLimbsBody);
+
     std::vector<HumanPoseByPeaksIndices> subset(0, HumanPoseByPeaksIndices(keypointsNumber));
     for (size_t k = 0; k < limbIdsPaf.size(); k++) {
         std::vector<TwoJointsConnection> connections;
-        const int mapIdxOffset = keypointsNumber + 1;
-        std::pair<cv::Mat, cv::Mat> scoreMid = { pafs[limbIdsPaf[k].first - mapIdxOffset],
-                                                 pafs[limbIdsPaf[k].second - mapIdxOffset] };
         const int idxJointA = limbIdsHeatmap[k].first - 1;
         const int idxJointB = limbIdsHeatmap[k].second - 1;
         const std::vector<Peak>& candA = allPeaks[idxJointA];
@@ -189,56 +330,7 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
             continue;
         }
 
-        std::vector<TwoJointsConnection> tempJointConnections;
-        for (size_t i = 0; i < nJointsA; i++) {
-            for (size_t j = 0; j < nJointsB; j++) {
-                cv::Point2f pt = candA[i].pos * 0.5 + candB[j].pos * 0.5;
-                cv::Point mid = cv::Point(cvRound(pt.x), cvRound(pt.y));
-                cv::Point2f vec = candB[j].pos - candA[i].pos;
-                double norm_vec = cv::norm(vec);
-                if (norm_vec == 0) {
-                    continue;
-                }
-                vec /= norm_vec;
-                float score = vec.x * scoreMid.first.at<float>(mid) + vec.y * scoreMid.second.at<float>(mid);
-                int height_n  = pafs[0].rows / 2;
-                float suc_ratio = 0.0f;
-                float mid_score = 0.0f;
-                const int mid_num = 10;
-                const float scoreThreshold = -100.0f;
-                if (score > scoreThreshold) {
-                    float p_sum = 0;
-                    int p_count = 0;
-                    cv::Size2f step((candB[j].pos.x - candA[i].pos.x)/(mid_num - 1),
-                                    (candB[j].pos.y - candA[i].pos.y)/(mid_num - 1));
-                    for (int n = 0; n < mid_num; n++) {
-                        cv::Point midPoint(cvRound(candA[i].pos.x + n * step.width),
-                                           cvRound(candA[i].pos.y + n * step.height));
-                        cv::Point2f pred(scoreMid.first.at<float>(midPoint),
-                                         scoreMid.second.at<float>(midPoint));
-                        score = vec.x * pred.x + vec.y * pred.y;
-                        if (score > midPointsScoreThreshold) {
-                            p_sum += score;
-                            p_count++;
-                        }
-                    }
-                    suc_ratio = static_cast<float>(p_count / mid_num);
-                    float ratio = p_count > 0 ? p_sum / p_count : 0.0f;
-                    mid_score = ratio + static_cast<float>(std::min(height_n / norm_vec - 1, 0.0));
-                }
-                if (mid_score > 0
-                        && suc_ratio > foundMidPointsRatioThreshold) {
-                    tempJointConnections.push_back(TwoJointsConnection(i, j, mid_score));
-                }
-            }
-        }
-        if (!tempJointConnections.empty()) {
-            std::sort(tempJointConnections.begin(), tempJointConnections.end(),
-                      [](const TwoJointsConnection& a,
-                         const TwoJointsConnection& b) {
-                return (a.score > b.score);
-            });
-        }
+        const std::vector<TwoJointsConnection>& tempJointConnections = limbConnections[k];
         int num_limbs = static_cast<int>(std::min(nJointsA, nJointsB));
         int cnt = 0;
         std::vector<int> occurA(nJointsA, 0);
@@ -313,7 +405,6 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
             }
         }
     }
-    std::vector<HumanPose> poses;
     for (const auto& subsetI : subset) {
         if (subsetI.nJoints < minJointsNumber
                 || subsetI.score / subsetI.nJoints < minSubsetScore) {
@@ -330,7 +421,6 @@ std::vector<HumanPose> groupPeaksToPoses(const std::vector<std::vector<Peak> >&
                 pose.keypoints[position].y += 0.5;
             }
         }
-        poses.push_back(pose);
+        poses.push_back(std::move(pose));
     }
-    return poses;
 }
@@ -50,16 +50,26 @@ struct TwoJointsConnection {
     float score;
 };
 
+/**
+ * Finds peaks of the network-resolution heatMaps[heatMapId]. Positions are refined to
+ * sub-pixel precision and given in coordinates of the map upsampled by upsampleRatio.
+ */
 void findPeaks(const std::vector<cv::Mat>& heatMaps,
                const float minPeaksDistance,
                std::vector<std::vector<Peak> >& allPeaks,
-               int heatMapId);
+               int heatMapId,
+               const int upsampleRatio);
 
-std::vector<HumanPose> groupPeaksToPoses(
+/**
+ * Appends the found poses to poses, which lets the caller reuse its storage.
+ */
+void groupPeaksToPoses(
         const std::vector<std::vector<Peak> >& allPeaks,
         const std::vector<cv::Mat>& pafs,
         const size_t keypointsNumber,
         const float midPointsScoreThreshold,
         const float foundMidPointsRatioThreshold,
         const int minJointsNumber,
-        const float minSubsetScore);
+        const float minSubsetScore,
+        const int upsampleRatio,
+        std::vector<HumanPose>& poses);
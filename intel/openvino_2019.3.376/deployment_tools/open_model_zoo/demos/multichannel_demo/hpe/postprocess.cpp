@@ -23,21 +23,23 @@
 namespace {
 class FindPeaksBody: public cv::ParallelLoopBody {
 public:
-    FindPeaksBody(const std::vector<cv::Mat>& heatMaps, float minPeaksDistance,
+    FindPeaksBody(const std::vector<cv::Mat>& heatMaps, float minPeaksDistance, int upsampleRatio,
                   std::vector<std::vector<Peak> >& peaksFromHeatMap)
         : heatMaps(heatMaps),
           minPeaksDistance(minPeaksDistance),
+          upsampleRatio(upsampleRatio),
           peaksFromHeatMap(peaksFromHeatMap) {}
 
     virtual void operator()(const cv::Range& range) const {
         for (int i = range.start; i < range.end; i++) {
-            findPeaks(heatMaps, minPeaksDistance, peaksFromHeatMap, i);
+            findPeaks(heatMaps, minPeaksDistance, peaksFromHeatMap, i, upsampleRatio);
         }
     }
 
 private:
     const std::vector<cv::Mat>& heatMaps;
     float minPeaksDistance;
+    int upsampleRatio;
     std::vector<std::vector<Peak> >& peaksFromHeatMap;
 };
 
@@ -51,11 +53,12 @@ float const foundMidPointsRatioThreshold = 0.8f;
 int minJointsNumber = 3;
 float minSubsetScore = 0.2f;
 
-std::vector<HumanPose> extractPoses(
+void extractPoses(
         const std::vector<cv::Mat>& heatMaps,
-        const std::vector<cv::Mat>& pafs) {
+        const std::vector<cv::Mat>& pafs,
+        std::vector<HumanPose>& poses) {
     std::vector<std::vector<Peak> > peaksFromHeatMap(heatMaps.size());
-    FindPeaksBody findPeaksBody(heatMaps, minPeaksDistance, peaksFromHeatMap);
+    FindPeaksBody findPeaksBody(heatMaps, minPeaksDistance, upsampleRatio, peaksFromHeatMap);
     cv::parallel_for_(cv::Range(0, static_cast<int>(heatMaps.size())),
                       findPeaksBody);
     int peaksBefore = 0;
@@ -65,18 +68,17 @@ std::vector<HumanPose> extractPoses(
             peak.id += peaksBefore;
         }
     }
-    std::vector<HumanPose> poses = groupPeaksToPoses(
-                peaksFromHeatMap, pafs, keypointsNumber, midPointsScoreThreshold,
-                foundMidPointsRatioThreshold, minJointsNumber, minSubsetScore);
-    return poses;
+    groupPeaksToPoses(peaksFromHeatMap, pafs, keypointsNumber, midPointsScoreThreshold,
+                      foundMidPointsRatioThreshold, minJointsNumber, minSubsetScore, upsampleRatio, poses);
 }
 }  // namespace
 
-std::vector<HumanPose> postprocess(
+void postprocess(
         const float* heatMapsData, const int heatMapOffset, const int nHeatMaps,
         const float* pafsData, const int pafOffset, const int nPafs,
         const int featureMapWidth, const int featureMapHeight,
-        const cv::Size& imageSize) {
+        const cv::Size& imageSize,
+        std::vector<HumanPose>& poses) {
     std::vector<cv::Mat> heatMaps(nHeatMaps);
     for (size_t i = 0; i < heatMaps.size(); i++) {
         heatMaps[i] = cv::Mat(featureMapHeight, featureMapWidth, CV_32FC1,
@@ -84,7 +86,6 @@ std::vector<HumanPose> postprocess(
                                   const_cast<float*>(
                                       heatMapsData + i * heatMapOffset)));
     }
-    postprocessor.resizeFeatureMaps(heatMaps);
 
     std::vector<cv::Mat> pafs(nPafs);
     for (size_t i = 0; i < pafs.size(); i++) {
@@ -93,9 +94,8 @@ std::vector<HumanPose> postprocess(
                               const_cast<float*>(
                                   pafsData + i * pafOffset)));
     }
-    postprocessor.resizeFeatureMaps(pafs);
 
-    std::vector<HumanPose> poses = extractPoses(heatMaps, pafs);
-    postprocessor.correctCoordinates(poses, heatMaps[0].size(), imageSize);
-    return poses;
+    // Peaks and PAFs are processed at network resolution, keypoints are given in the upsampled maps coordinates
+    extractPoses(heatMaps, pafs, poses);
+    postprocessor.correctCoordinates(poses, heatMaps[0].size() * upsampleRatio, imageSize);
 }
@@ -24,8 +24,10 @@
 
 size_t constexpr keypointsNumber = 18;
 
-std::vector<HumanPose> postprocess(
+/// Appends the poses found in the network outputs to poses
+void postprocess(
         float const* heatMapsData, int const heatMapOffset, int const nHeatMaps,
         float const* pafsData, int const pafOffset, int const nPafs,
         int const featureMapWidth, int const featureMapHeight,
-        cv::Size const& imageSize);
+        cv::Size const& imageSize,
+        std::vector<HumanPose>& poses);
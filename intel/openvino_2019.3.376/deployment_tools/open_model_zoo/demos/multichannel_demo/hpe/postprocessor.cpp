@@ -16,8 +16,6 @@
 
 #include <vector>
 
-#include <opencv2/imgproc/imgproc.hpp>
-
 #include "postprocessor.hpp"
 
 
@@ -26,13 +24,6 @@ Postprocessor::Postprocessor(int const upsampleRatio, int const stride, cv::Vec4
       stride(stride),
       pad(pad) {}
 
-void Postprocessor::resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const {
-    for (auto& featureMap : featureMaps) {
-        cv::resize(featureMap, featureMap, cv::Size(),
-                   upsampleRatio, upsampleRatio, cv::INTER_CUBIC);
-    }
-}
-
 void Postprocessor::correctCoordinates(std::vector<HumanPose>& poses,
                                        const cv::Size& featureMapsSize,
                                        const cv::Size& imageSize) const {
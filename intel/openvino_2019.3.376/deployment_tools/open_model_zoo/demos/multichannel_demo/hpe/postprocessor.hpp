@@ -25,7 +25,6 @@
 class Postprocessor {
 public:
     explicit Postprocessor(int const upsampleRatio = 4, int const stride = 8, cv::Vec4i const pad = cv::Vec4i::all(0));
-    void resizeFeatureMaps(std::vector<cv::Mat>& featureMaps) const;
     void correctCoordinates(std::vector<HumanPose>& poses,
                             const cv::Size& featureMapsSize,
                             const cv::Size& imageSize) const;
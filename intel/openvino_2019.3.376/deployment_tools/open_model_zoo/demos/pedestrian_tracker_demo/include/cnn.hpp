@@ -28,6 +28,8 @@ struct CnnConfig {
     std::string path_to_weights;
     /** @brief Maximal size of batch */
     int max_batch_size{1};
+    /** @brief Maximal number of batches inferred at the same time */
+    int max_num_requests{1};
 };
 
 /**
@@ -88,12 +90,17 @@ protected:
     InferenceEngine::OutputsDataMap outInfo_;
     /** @brief IE network */
     InferenceEngine::ExecutableNetwork executable_network_;
-    /** @brief IE InferRequest */
-    mutable InferenceEngine::InferRequest infer_request_;
-    /** @brief Pointer to the pre-allocated input blob */
-    mutable InferenceEngine::Blob::Ptr input_blob_;
-    /** @brief Map of output blobs */
-    InferenceEngine::BlobMap outputs_;
+    /** @brief IE InferRequest with its pre-allocated blobs */
+    struct Request {
+        /** @brief IE InferRequest */
+        InferenceEngine::InferRequest infer_request;
+        /** @brief Pointer to the pre-allocated input blob */
+        InferenceEngine::Blob::Ptr input_blob;
+        /** @brief Map of output blobs */
+        InferenceEngine::BlobMap outputs;
+    };
+    /** @brief InferRequests used in turn, several batches may be in flight */
+    mutable std::vector<Request> requests_;
 };
 
 class VectorCNN : public CnnBase {
@@ -39,6 +39,16 @@ public:
     virtual std::vector<float> Compute(const std::vector<cv::Mat> &descrs1,
                                        const std::vector<cv::Mat> &descrs2) = 0;
 
+    ///
+    /// \brief Computes distances between every descriptor of the first set
+    /// and every descriptor of the second set.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \return descrs1.size() x descrs2.size() CV_32F matrix of distances.
+    ///
+    virtual cv::Mat ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                  const std::vector<cv::Mat> &descrs2);
+
     virtual ~IDescriptorDistance() {}
 };
 
@@ -72,6 +82,16 @@ public:
         const std::vector<cv::Mat> &descrs1,
         const std::vector<cv::Mat> &descrs2) override;
 
+    ///
+    /// \brief Computes distances between all pairs of descriptors of two sets
+    /// with a single matrix product of the normalized descriptors.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \return descrs1.size() x descrs2.size() CV_32F matrix of distances.
+    ///
+    cv::Mat ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                          const std::vector<cv::Mat> &descrs2) override;
+
 private:
     cv::Size descriptor_size_;
 };
@@ -114,6 +134,16 @@ public:
     ///
     std::vector<float> Compute(const std::vector<cv::Mat> &descrs1,
                                const std::vector<cv::Mat> &descrs2) override;
+    ///
+    /// \brief Computes distances between all pairs of descriptors of two sets.
+    /// TM_CCORR_NORMED of equally sized images is their cosine similarity,
+    /// so that method is computed as one matrix product.
+    /// \param[in] descrs1 First set of descriptors.
+    /// \param[in] descrs2 Second set of descriptors.
+    /// \return descrs1.size() x descrs2.size() CV_32F matrix of distances.
+    ///
+    cv::Mat ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                          const std::vector<cv::Mat> &descrs2) override;
     virtual ~MatchTemplateDistance() {}
 
 private:
@@ -13,7 +13,9 @@
 ///
 /// \brief The KuhnMunkres class
 ///
-/// Solves the assignment problem.
+/// Solves the assignment problem with the shortest augmenting path method
+/// (Jonker-Volgenant). Keep one instance alive between frames: its buffers
+/// are reused instead of being allocated for every call.
 ///
 class KuhnMunkres {
 public:
@@ -30,25 +32,41 @@ public:
     ///
     std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix);
 
-private:
-    static constexpr int kStar = 1;
-    static constexpr int kPrime = 2;
+    ///
+    /// \brief Solves the assignment problem only over the pairs whose
+    /// dissimilarity does not exceed the gate. Gated pairs are never visited,
+    /// so sparse matrices are solved much faster than by the dense solver.
+    /// Leaving a row unassigned costs max_dissimilarity.
+    /// \param dissimilarity_matrix CV_32F dissimilarity matrix.
+    /// \param max_dissimilarity Pairs with larger dissimilarity are not
+    /// assigned.
+    /// \return Optimal column index for each row. -1 means that there is no
+    /// column for row.
+    ///
+    std::vector<size_t> Solve(const cv::Mat &dissimilarity_matrix,
+                              float max_dissimilarity);
 
-    cv::Mat dm_;
-    cv::Mat marked_;
-    std::vector<cv::Point> points_;
+private:
+    // Rows and columns are numbered from 1, column 0 is the root of the
+    // alternating tree.
+    std::vector<double> u_;        // Row potentials.
+    std::vector<double> v_;        // Column potentials.
+    std::vector<double> minv_;     // Minimal reduced cost to reach a column.
+    std::vector<int> col_to_row_;  // Matching, 0 means a free column.
+    std::vector<int> way_;         // Previous column on the augmenting path.
+    std::vector<char> used_;       // Columns in the alternating tree.
+    std::vector<int> free_rows_;   // Rows left unassigned by the warm start.
 
-    std::vector<int> is_row_visited_;
-    std::vector<int> is_col_visited_;
+    cv::Mat transposed_;
 
-    int n_;
+    // Non-gated pairs in CSR layout for the sparse solver.
+    std::vector<int> edge_offsets_;
+    std::vector<int> edge_cols_;
+    std::vector<float> edge_costs_;
 
-    void TrySimpleCase();
-    bool CheckIfOptimumIsFound();
-    cv::Point FindUncoveredMinValPos();
-    void UpdateDissimilarityMatrix(float val);
-    int FindInRow(int row, int what);
-    int FindInCol(int col, int what);
-    void Run();
+    void Init(int rows, int cols);
+    void AssignCheapestFree(int row, int col, float cost);
+    void UpdatePotentials(double delta);
+    void AugmentDense(const cv::Mat &dm, int row);
+    void AugmentSparse(int row);
 };
-
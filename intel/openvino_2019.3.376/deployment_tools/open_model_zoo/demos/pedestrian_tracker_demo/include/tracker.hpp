@@ -18,6 +18,7 @@
 #include "utils.hpp"
 #include "descriptor.hpp"
 #include "distance.hpp"
+#include "kuhn_munkres.hpp"
 
 ///
 /// \brief The TrackerParams struct stores parameters of PedestrianTracker
@@ -405,8 +406,8 @@ private:
     std::vector<std::pair<size_t, size_t>> GetTrackToDetectionIds(
         const std::set<std::tuple<size_t, size_t, float>> &matches);
 
-    float AffinityFast(const cv::Mat &descriptor1, const TrackedObject &obj1,
-                       const cv::Mat &descriptor2, const TrackedObject &obj2);
+    float AffinityFast(float appearance_distance, const TrackedObject &obj1,
+                       const TrackedObject &obj2);
 
     float Affinity(const TrackedObject &obj1, const TrackedObject &obj2);
 
@@ -471,6 +472,9 @@ private:
     // Distance strong (reid classifier).
     Distance distance_strong_;
 
+    // Assignment solver, its buffers are reused from frame to frame.
+    KuhnMunkres assignment_solver_;
+
     // All tracks.
     std::unordered_map<size_t, Track> tracks_;
 
@@ -52,6 +52,7 @@ CreatePedestrianTracker(const std::string& reid_model,
     if (!reid_model.empty() && !reid_weights.empty()) {
         CnnConfig reid_config(reid_model, reid_weights);
         reid_config.max_batch_size = 16;
+        reid_config.max_num_requests = 2;
 
         std::shared_ptr<IImageDescriptor> descriptor_strong =
             std::make_shared<DescriptorIE>(reid_config, ie, deviceName);
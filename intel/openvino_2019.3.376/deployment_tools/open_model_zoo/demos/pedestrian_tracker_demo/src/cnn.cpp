@@ -43,50 +43,68 @@ void CnnBase::Load() {
 
     SizeVector inputDims = in.begin()->second->getTensorDesc().getDims();
     in.begin()->second->setPrecision(Precision::U8);
-    input_blob_ = make_shared_blob<uint8_t>(TensorDesc(Precision::U8, inputDims, Layout::NCHW));
-    input_blob_->allocate();
-    BlobMap inputs;
-    inputs[in.begin()->first] = input_blob_;
     outInfo_ = net_reader.getNetwork().getOutputsInfo();
-
     for (auto&& item : outInfo_) {
-        SizeVector outputDims = item.second->getTensorDesc().getDims();
-        auto outputLayout = item.second->getTensorDesc().getLayout();
         item.second->setPrecision(Precision::FP32);
-        TBlob<float>::Ptr output =
-            make_shared_blob<float>(TensorDesc(Precision::FP32, outputDims, outputLayout));
-        output->allocate();
-        outputs_[item.first] = output;
     }
 
     executable_network_ = ie_.LoadNetwork(net_reader.getNetwork(), deviceName_);
-    infer_request_ = executable_network_.CreateInferRequest();
-    infer_request_.SetInput(inputs);
-    infer_request_.SetOutput(outputs_);
+
+    requests_.resize(std::max(config_.max_num_requests, 1));
+    for (auto& request : requests_) {
+        request.input_blob = make_shared_blob<uint8_t>(TensorDesc(Precision::U8, inputDims, Layout::NCHW));
+        request.input_blob->allocate();
+        BlobMap inputs;
+        inputs[in.begin()->first] = request.input_blob;
+
+        for (auto&& item : outInfo_) {
+            SizeVector outputDims = item.second->getTensorDesc().getDims();
+            auto outputLayout = item.second->getTensorDesc().getLayout();
+            TBlob<float>::Ptr output =
+                make_shared_blob<float>(TensorDesc(Precision::FP32, outputDims, outputLayout));
+            output->allocate();
+            request.outputs[item.first] = output;
+        }
+
+        request.infer_request = executable_network_.CreateInferRequest();
+        request.infer_request.SetInput(inputs);
+        request.infer_request.SetOutput(request.outputs);
+    }
 }
 
 void CnnBase::InferBatch(
     const std::vector<cv::Mat>& frames,
     std::function<void(const InferenceEngine::BlobMap&, size_t)> fetch_results) const {
-    const size_t batch_size = input_blob_->getTensorDesc().getDims()[0];
+    const size_t batch_size = requests_.front().input_blob->getTensorDesc().getDims()[0];
+
+    // Batches are submitted to the requests in turn, the next batch is filled
+    // while the previous ones are inferred, results are fetched in order.
+    const size_t num_imgs = frames.size();
+    const size_t num_batches = (num_imgs + batch_size - 1) / batch_size;
+    size_t num_submitted = 0;
+    for (size_t batch_id = 0; batch_id < num_batches; batch_id++) {
+        while (num_submitted < num_batches && num_submitted - batch_id < requests_.size()) {
+            Request& request = requests_[num_submitted % requests_.size()];
+            const size_t batch_i = num_submitted * batch_size;
+            const size_t current_batch_size = std::min(batch_size, num_imgs - batch_i);
+            for (size_t b = 0; b < current_batch_size; b++) {
+                matU8ToBlob<uint8_t>(frames[batch_i + b], request.input_blob, b);
+            }
 
-    size_t num_imgs = frames.size();
-    for (size_t batch_i = 0; batch_i < num_imgs; batch_i += batch_size) {
-        const size_t current_batch_size = std::min(batch_size, num_imgs - batch_i);
-        for (size_t b = 0; b < current_batch_size; b++) {
-            matU8ToBlob<uint8_t>(frames[batch_i + b], input_blob_, b);
+            request.infer_request.SetBatch(current_batch_size);
+            request.infer_request.StartAsync();
+            num_submitted++;
         }
 
-        infer_request_.SetBatch(current_batch_size);
-        infer_request_.Infer();
-
-        fetch_results(outputs_, current_batch_size);
+        Request& request = requests_[batch_id % requests_.size()];
+        request.infer_request.Wait(IInferRequest::WaitMode::RESULT_READY);
+        fetch_results(request.outputs, std::min(batch_size, num_imgs - batch_id * batch_size));
     }
 }
 
 void CnnBase::PrintPerformanceCounts(std::string fullDeviceName) const {
     std::cout << "Performance counts for " << config_.path_to_model << std::endl << std::endl;
-    ::printPerformanceCounts(infer_request_, std::cout, fullDeviceName, false);
+    ::printPerformanceCounts(requests_.front().infer_request, std::cout, fullDeviceName, false);
 }
 
 void CnnBase::Infer(const cv::Mat& frame,
@@ -100,7 +118,7 @@ VectorCNN::VectorCNN(const Config& config,
     : CnnBase(config, ie, deviceName) {
     Load();
 
-    if (outputs_.size() != 1) {
+    if (outInfo_.size() != 1) {
         THROW_IE_EXCEPTION << "Demo supports topologies only with 1 output";
     }
 
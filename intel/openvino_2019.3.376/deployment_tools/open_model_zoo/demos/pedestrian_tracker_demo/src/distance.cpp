@@ -7,6 +7,50 @@
 
 #include <vector>
 
+namespace {
+///
+/// \brief Packs descriptors into rows of a contiguous CV_32F matrix
+/// and scales every row to the unit length.
+///
+cv::Mat PackNormalizedRows(const std::vector<cv::Mat> &descrs) {
+    const int row_length = static_cast<int>(descrs.front().total() * descrs.front().channels());
+    cv::Mat packed(static_cast<int>(descrs.size()), row_length, CV_32F);
+    for (size_t i = 0; i < descrs.size(); i++) {
+        const cv::Mat &descr = descrs[i];
+        PT_CHECK(!descr.empty());
+        PT_CHECK_EQ(static_cast<int>(descr.total() * descr.channels()), row_length);
+        cv::Mat row = packed.row(static_cast<int>(i));
+        (descr.isContinuous() ? descr : descr.clone()).reshape(1, 1).convertTo(row, CV_32F);
+        row *= 1.0 / (cv::norm(row) + 1e-6);
+    }
+    return packed;
+}
+
+///
+/// \brief Cosine similarities of all pairs: one GEMM of the packed
+/// descriptors, which OpenCV runs blocked and vectorized.
+///
+cv::Mat ComputeCosineSimilarities(const std::vector<cv::Mat> &descrs1,
+                                  const std::vector<cv::Mat> &descrs2) {
+    cv::Mat similarities;
+    cv::gemm(PackNormalizedRows(descrs1), PackNormalizedRows(descrs2), 1.0,
+             cv::noArray(), 0.0, similarities, cv::GEMM_2_T);
+    return similarities;
+}
+}  // anonymous namespace
+
+cv::Mat IDescriptorDistance::ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                           const std::vector<cv::Mat> &descrs2) {
+    cv::Mat distances(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    for (size_t i = 0; i < descrs1.size(); i++) {
+        auto ptr = distances.ptr<float>(static_cast<int>(i));
+        for (size_t j = 0; j < descrs2.size(); j++) {
+            ptr[j] = Compute(descrs1[i], descrs2[j]);
+        }
+    }
+    return distances;
+}
+
 CosDistance::CosDistance(const cv::Size &descriptor_size)
     : descriptor_size_(descriptor_size) {
     PT_CHECK(descriptor_size.area() != 0);
@@ -38,6 +82,19 @@ std::vector<float> CosDistance::Compute(const std::vector<cv::Mat> &descrs1,
     return distances;
 }
 
+cv::Mat CosDistance::ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                   const std::vector<cv::Mat> &descrs2) {
+    if (descrs1.empty() || descrs2.empty()) {
+        return cv::Mat(static_cast<int>(descrs1.size()), static_cast<int>(descrs2.size()), CV_32F);
+    }
+    PT_CHECK(descrs1.front().size() == descriptor_size_);
+    PT_CHECK(descrs2.front().size() == descriptor_size_);
+
+    cv::Mat distances;
+    ComputeCosineSimilarities(descrs1, descrs2).convertTo(distances, CV_32F, -0.5, 0.5);
+    return distances;
+}
+
 
 float MatchTemplateDistance::Compute(const cv::Mat &descr1,
                                      const cv::Mat &descr2) {
@@ -59,3 +116,16 @@ std::vector<float> MatchTemplateDistance::Compute(const std::vector<cv::Mat> &de
     }
     return result;
 }
+
+cv::Mat MatchTemplateDistance::ComputeMatrix(const std::vector<cv::Mat> &descrs1,
+                                             const std::vector<cv::Mat> &descrs2) {
+    if (type_ != cv::TemplateMatchModes::TM_CCORR_NORMED || descrs1.empty() || descrs2.empty()) {
+        return IDescriptorDistance::ComputeMatrix(descrs1, descrs2);
+    }
+    PT_CHECK_EQ(descrs1.front().size(), descrs2.front().size());
+    PT_CHECK_EQ(descrs1.front().type(), descrs2.front().type());
+
+    cv::Mat distances;
+    ComputeCosineSimilarities(descrs1, descrs2).convertTo(distances, CV_32F, scale_, offset_);
+    return distances;
+}
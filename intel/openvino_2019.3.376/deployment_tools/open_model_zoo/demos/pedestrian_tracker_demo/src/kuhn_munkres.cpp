@@ -9,162 +9,204 @@
 #include <limits>
 #include <vector>
 
-KuhnMunkres::KuhnMunkres() : n_() {}
+namespace {
+constexpr double kInf = std::numeric_limits<double>::max();
+}  // anonymous namespace
+
+KuhnMunkres::KuhnMunkres() {}
 
 std::vector<size_t> KuhnMunkres::Solve(const cv::Mat& dissimilarity_matrix) {
     PT_CHECK(dissimilarity_matrix.type() == CV_32F);
+    std::vector<size_t> results(dissimilarity_matrix.rows, -1);
+    if (dissimilarity_matrix.empty()) {
+        return results;
+    }
     double min_val;
     cv::minMaxLoc(dissimilarity_matrix, &min_val);
     PT_CHECK(min_val >= 0);
 
-    n_ = std::max(dissimilarity_matrix.rows, dissimilarity_matrix.cols);
-    dm_ = cv::Mat(n_, n_, CV_32F, cv::Scalar(0));
-    marked_ = cv::Mat(n_, n_, CV_8S, cv::Scalar(0));
-    points_ = std::vector<cv::Point>(n_ * 2);
-
-    dissimilarity_matrix.copyTo(dm_(
-            cv::Rect(0, 0, dissimilarity_matrix.cols, dissimilarity_matrix.rows)));
-
-    is_row_visited_ = std::vector<int>(n_, 0);
-    is_col_visited_ = std::vector<int>(n_, 0);
+    // The solver assigns every row, so it needs rows <= cols.
+    const bool transpose = dissimilarity_matrix.rows > dissimilarity_matrix.cols;
+    if (transpose) {
+        cv::transpose(dissimilarity_matrix, transposed_);
+    }
+    const cv::Mat& dm = transpose ? transposed_ : dissimilarity_matrix;
 
-    Run();
+    Init(dm.rows, dm.cols);
+    for (int i = 1; i <= dm.rows; i++) {
+        const auto ptr = dm.ptr<float>(i - 1);
+        const auto min_it = std::min_element(ptr, ptr + dm.cols);
+        AssignCheapestFree(i, static_cast<int>(min_it - ptr) + 1, *min_it);
+    }
+    for (int i : free_rows_) {
+        AugmentDense(dm, i);
+    }
 
-    std::vector<size_t> results(dissimilarity_matrix.rows, -1);
-    for (int i = 0; i < dissimilarity_matrix.rows; i++) {
-        const auto ptr = marked_.ptr<char>(i);
-        for (int j = 0; j < dissimilarity_matrix.cols; j++) {
-            if (ptr[j] == kStar) {
-                results[i] = j;
+    for (int j = 1; j <= dm.cols; j++) {
+        if (col_to_row_[j] != 0) {
+            if (transpose) {
+                results[j - 1] = col_to_row_[j] - 1;
+            } else {
+                results[col_to_row_[j] - 1] = j - 1;
             }
         }
     }
     return results;
 }
 
-void KuhnMunkres::TrySimpleCase() {
-    auto is_row_visited = std::vector<int>(n_, 0);
-    auto is_col_visited = std::vector<int>(n_, 0);
-
-    for (int row = 0; row < n_; row++) {
-        auto ptr = dm_.ptr<float>(row);
-        auto marked_ptr = marked_.ptr<char>(row);
-        auto min_val = *std::min_element(ptr, ptr + n_);
-        for (int col = 0; col < n_; col++) {
-            ptr[col] -= min_val;
-            if (ptr[col] == 0 && !is_col_visited[col] && !is_row_visited[row]) {
-                marked_ptr[col] = kStar;
-                is_col_visited[col] = 1;
-                is_row_visited[row] = 1;
-            }
-        }
+std::vector<size_t> KuhnMunkres::Solve(const cv::Mat& dissimilarity_matrix,
+                                       float max_dissimilarity) {
+    PT_CHECK(dissimilarity_matrix.type() == CV_32F);
+    PT_CHECK(max_dissimilarity >= 0);
+    const int rows = dissimilarity_matrix.rows;
+    const int cols = dissimilarity_matrix.cols;
+    std::vector<size_t> results(rows, -1);
+    if (dissimilarity_matrix.empty()) {
+        return results;
     }
-}
 
-bool KuhnMunkres::CheckIfOptimumIsFound() {
-    int count = 0;
-    for (int i = 0; i < n_; i++) {
-        const auto marked_ptr = marked_.ptr<char>(i);
-        for (int j = 0; j < n_; j++) {
-            if (marked_ptr[j] == kStar) {
-                is_col_visited_[j] = 1;
-                count++;
+    // Every row gets a private dummy column cols + row with the gate cost,
+    // taking it means that the row stays unassigned.
+    edge_offsets_.assign(1, 0);
+    edge_cols_.clear();
+    edge_costs_.clear();
+    for (int i = 1; i <= rows; i++) {
+        const auto ptr = dissimilarity_matrix.ptr<float>(i - 1);
+        for (int j = 0; j < cols; j++) {
+            if (ptr[j] <= max_dissimilarity) {
+                PT_CHECK(ptr[j] >= 0);
+                edge_cols_.push_back(j + 1);
+                edge_costs_.push_back(ptr[j]);
             }
         }
+        edge_cols_.push_back(cols + i);
+        edge_costs_.push_back(max_dissimilarity);
+        edge_offsets_.push_back(static_cast<int>(edge_cols_.size()));
     }
 
-    return count >= n_;
-}
+    Init(rows, cols + rows);
+    for (int i = 1; i <= rows; i++) {
+        const auto begin = edge_costs_.begin() + edge_offsets_[i - 1];
+        const auto min_it = std::min_element(begin, edge_costs_.begin() + edge_offsets_[i]);
+        AssignCheapestFree(i, edge_cols_[min_it - edge_costs_.begin()], *min_it);
+    }
+    for (int i : free_rows_) {
+        AugmentSparse(i);
+    }
 
-cv::Point KuhnMunkres::FindUncoveredMinValPos() {
-    auto min_val = std::numeric_limits<float>::max();
-    cv::Point min_val_pos(-1, -1);
-    for (int i = 0; i < n_; i++) {
-        if (!is_row_visited_[i]) {
-            auto dm_ptr = dm_.ptr<float>(i);
-            for (int j = 0; j < n_; j++) {
-                if (!is_col_visited_[j] && dm_ptr[j] < min_val) {
-                    min_val = dm_ptr[j];
-                    min_val_pos = cv::Point(j, i);
-                }
-            }
+    for (int j = 1; j <= cols; j++) {
+        if (col_to_row_[j] != 0) {
+            results[col_to_row_[j] - 1] = j - 1;
         }
     }
-    return min_val_pos;
+    return results;
 }
 
-void KuhnMunkres::UpdateDissimilarityMatrix(float val) {
-    for (int i = 0; i < n_; i++) {
-        auto dm_ptr = dm_.ptr<float>(i);
-        for (int j = 0; j < n_; j++) {
-            if (is_row_visited_[i]) dm_ptr[j] += val;
-            if (!is_col_visited_[j]) dm_ptr[j] -= val;
-        }
-    }
+void KuhnMunkres::Init(int rows, int cols) {
+    u_.assign(rows + 1, 0);
+    v_.assign(cols + 1, 0);
+    col_to_row_.assign(cols + 1, 0);
+    way_.assign(cols + 1, 0);
+    minv_.resize(cols + 1);
+    used_.resize(cols + 1);
+    free_rows_.clear();
 }
 
-int KuhnMunkres::FindInRow(int row, int what) {
-    for (int j = 0; j < n_; j++) {
-        if (marked_.at<char>(row, j) == what) {
-            return j;
-        }
+// Warm start: row reduction keeps the potentials feasible (all reduced costs
+// are non-negative) and a row whose cheapest column is free gets it for
+// nothing, so only the conflicting rows need augmenting paths.
+void KuhnMunkres::AssignCheapestFree(int row, int col, float cost) {
+    u_[row] = cost;
+    if (col_to_row_[col] == 0) {
+        col_to_row_[col] = row;
+    } else {
+        free_rows_.push_back(row);
     }
-    return -1;
 }
 
-int KuhnMunkres::FindInCol(int col, int what) {
-    for (int i = 0; i < n_; i++) {
-        if (marked_.at<char>(i, col) == what) {
-            return i;
+void KuhnMunkres::UpdatePotentials(double delta) {
+    for (size_t j = 0; j < used_.size(); j++) {
+        if (used_[j]) {
+            u_[col_to_row_[j]] += delta;
+            v_[j] -= delta;
+        } else {
+            minv_[j] -= delta;
         }
     }
-    return -1;
 }
 
-void KuhnMunkres::Run() {
-    TrySimpleCase();
-    while (!CheckIfOptimumIsFound()) {
-        while (true) {
-            auto point = FindUncoveredMinValPos();
-            auto min_val = dm_.at<float>(point.y, point.x);
-            if (min_val > 0) {
-                UpdateDissimilarityMatrix(min_val);
-            } else {
-                marked_.at<char>(point.y, point.x) = kPrime;
-                int col = FindInRow(point.y, kStar);
-                if (col >= 0) {
-                    is_row_visited_[point.y] = 1;
-                    is_col_visited_[col] = 0;
-                } else {
-                    int count = 0;
-                    points_[count] = point;
-
-                    while (true) {
-                        int row = FindInCol(points_[count].x, kStar);
-                        if (row >= 0) {
-                            count++;
-                            points_[count] = cv::Point(points_[count - 1].x, row);
-                            int col = FindInRow(points_[count].y, kPrime);
-                            count++;
-                            points_[count] = cv::Point(col, points_[count - 1].y);
-                        } else {
-                            break;
-                        }
-                    }
-
-                    for (int i = 0; i < count + 1; i++) {
-                        auto& mark = marked_.at<char>(points_[i].y, points_[i].x);
-                        mark = mark == kStar ? 0 : kStar;
-                    }
-
-                    is_row_visited_ = std::vector<int>(n_, 0);
-                    is_col_visited_ = std::vector<int>(n_, 0);
-
-                    marked_.setTo(0, marked_ == kPrime);
-                    break;
+void KuhnMunkres::AugmentDense(const cv::Mat& dm, int row) {
+    const int cols = dm.cols;
+    col_to_row_[0] = row;
+    std::fill(minv_.begin(), minv_.end(), kInf);
+    std::fill(used_.begin(), used_.end(), 0);
+    int j0 = 0;
+    do {
+        used_[j0] = 1;
+        const int i0 = col_to_row_[j0];
+        const auto ptr = dm.ptr<float>(i0 - 1);
+        double delta = kInf;
+        int j1 = 0;
+        for (int j = 1; j <= cols; j++) {
+            if (!used_[j]) {
+                const double cur = ptr[j - 1] - u_[i0] - v_[j];
+                if (cur < minv_[j]) {
+                    minv_[j] = cur;
+                    way_[j] = j0;
+                }
+                if (minv_[j] < delta) {
+                    delta = minv_[j];
+                    j1 = j;
                 }
             }
         }
-    }
+        UpdatePotentials(delta);
+        j0 = j1;
+    } while (col_to_row_[j0] != 0);
+
+    do {
+        const int j1 = way_[j0];
+        col_to_row_[j0] = col_to_row_[j1];
+        j0 = j1;
+    } while (j0 != 0);
 }
 
+void KuhnMunkres::AugmentSparse(int row) {
+    const int cols = static_cast<int>(used_.size()) - 1;
+    col_to_row_[0] = row;
+    std::fill(minv_.begin(), minv_.end(), kInf);
+    std::fill(used_.begin(), used_.end(), 0);
+    int j0 = 0;
+    do {
+        used_[j0] = 1;
+        const int i0 = col_to_row_[j0];
+        for (int e = edge_offsets_[i0 - 1]; e < edge_offsets_[i0]; e++) {
+            const int j = edge_cols_[e];
+            if (!used_[j]) {
+                const double cur = edge_costs_[e] - u_[i0] - v_[j];
+                if (cur < minv_[j]) {
+                    minv_[j] = cur;
+                    way_[j] = j0;
+                }
+            }
+        }
+        // The dummy column of the starting row is always free and reachable,
+        // so delta is finite.
+        double delta = kInf;
+        int j1 = 0;
+        for (int j = 1; j <= cols; j++) {
+            if (!used_[j] && minv_[j] < delta) {
+                delta = minv_[j];
+                j1 = j;
+            }
+        }
+        UpdatePotentials(delta);
+        j0 = j1;
+    } while (col_to_row_[j0] != 0);
+
+    do {
+        const int j1 = way_[j0];
+        col_to_row_[j0] = col_to_row_[j1];
+        j0 = j1;
+    } while (j0 != 0);
+}
@@ -277,7 +277,9 @@ void PedestrianTracker::SolveAssignmentProblem(
     ComputeDissimilarityMatrix(track_ids, detections, descriptors,
                                &dissimilarity);
 
-    auto res = KuhnMunkres().Solve(dissimilarity);
+    // Pairs with affinity not above thr are rejected after matching anyway,
+    // so the solver does not consider them at all.
+    auto res = assignment_solver_.Solve(dissimilarity, 1.0f - thr);
 
     for (size_t i = 0; i < detections.size(); i++) {
         unmatched_detections->insert(i);
@@ -438,7 +440,7 @@ void PedestrianTracker::Process(const cv::Mat &frame,
         std::set<std::tuple<size_t, size_t, float>> matches;
 
         SolveAssignmentProblem(active_tracks, detections, descriptors_fast,
-                               params_.aff_thr_fast, &unmatched_tracks,
+                               params_.strong_affinity_thr, &unmatched_tracks,
                                &unmatched_detections, &matches);
 
         std::map<size_t, std::pair<bool, cv::Mat>> is_matching_to_track;
@@ -581,15 +583,23 @@ void PedestrianTracker::ComputeDissimilarityMatrix(
     const std::set<size_t> &active_tracks, const TrackedObjects &detections,
     const std::vector<cv::Mat> &descriptors_fast,
     cv::Mat *dissimilarity_matrix) {
+    std::vector<cv::Mat> tracks_descriptors_fast;
+    tracks_descriptors_fast.reserve(active_tracks.size());
+    for (auto id : active_tracks) {
+        tracks_descriptors_fast.push_back(tracks_.at(id).descriptor_fast);
+    }
+    // appearance distances of all track x detection pairs in one call
+    cv::Mat distances = distance_fast_->ComputeMatrix(tracks_descriptors_fast, descriptors_fast);
+
     cv::Mat am(active_tracks.size(), detections.size(), CV_32F, cv::Scalar(0));
     size_t i = 0;
     for (auto id : active_tracks) {
         auto ptr = am.ptr<float>(i);
+        auto distances_ptr = distances.ptr<float>(i);
+        auto last_det = tracks_.at(id).objects.back();
+        last_det.rect = tracks_.at(id).predicted_rect;
         for (size_t j = 0; j < descriptors_fast.size(); j++) {
-            auto last_det = tracks_.at(id).objects.back();
-            last_det.rect = tracks_.at(id).predicted_rect;
-            ptr[j] = AffinityFast(tracks_.at(id).descriptor_fast, last_det,
-                                  descriptors_fast[j], detections[j]);
+            ptr[j] = AffinityFast(distances_ptr[j], last_det, detections[j]);
         }
         i++;
     }
@@ -784,9 +794,8 @@ void PedestrianTracker::AppendToTrack(const cv::Mat &frame,
     }
 }
 
-float PedestrianTracker::AffinityFast(const cv::Mat &descriptor1,
+float PedestrianTracker::AffinityFast(float appearance_distance,
                                       const TrackedObject &obj1,
-                                      const cv::Mat &descriptor2,
                                       const TrackedObject &obj2) {
     const float eps = 1e-6f;
     float shp_aff = ShapeAffinity(params_.shape_affinity_w, obj1.rect, obj2.rect);
@@ -800,7 +809,7 @@ float PedestrianTracker::AffinityFast(const cv::Mat &descriptor1,
 
     if (time_aff < eps) return 0.0f;
 
-    float app_aff = 1.0f - distance_fast_->Compute(descriptor1, descriptor2);
+    float app_aff = 1.0f - appearance_distance;
 
     return shp_aff * mot_aff * app_aff * time_aff;
 }
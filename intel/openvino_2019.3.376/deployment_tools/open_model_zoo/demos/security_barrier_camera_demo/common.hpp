@@ -18,6 +18,8 @@
 
 #include <opencv2/core/core.hpp>
 
+#include <samples/lock_free_queue.hpp>
+
 class VideoFrame {  // VideoFrame can represent not a single image but the whole grid
 public:
     typedef std::shared_ptr<VideoFrame> Ptr;
@@ -53,38 +55,80 @@ struct HigherPriority {
     }
 };
 
-class Worker {
+class Worker {  // every thread owns a task set and steals ready tasks from the others when its own has none
 public:
     explicit Worker(unsigned threadNum):
-        threadPull(threadNum), running{false} {}
+        threadPull(threadNum), queues(threadNum + 1), running{false}, pendingTasks{0}, sleepingThreads{0}, nextQueue{0} {}
     ~Worker() {
         stop();
     }
     void runThreads() {
         running = true;
-        for (std::thread& t : threadPull) {
-            t = std::thread(&Worker::threadFunc, this);
+        for (std::size_t i = 0; i < threadPull.size(); i++) {
+            threadPull[i] = std::thread(&Worker::threadLoop, this, i);
         }
     }
     void push(std::shared_ptr<Task> task) {
-        tasksMutex.lock();
-        tasks.insert(task);
-        tasksMutex.unlock();
-        tasksCondVar.notify_one();
+        // worker threads keep their own tasks local, other threads (readers, InferRequest callbacks) spread them
+        const ThreadId& threadId = currentThread();
+        const std::size_t queueId = this == threadId.worker ? threadId.queueId : nextQueue++ % queues.size();
+        queues[queueId].mutex.lock();
+        queues[queueId].tasks.insert(std::move(task));
+        queues[queueId].mutex.unlock();
+        pendingTasks++;
+        if (0 != sleepingThreads) {
+            std::lock_guard<std::mutex> lock{sleepMutex};
+            sleepCondVar.notify_one();
+        }
+    }
+    void threadFunc() {  // the calling thread joins the pool with the last task set
+        threadLoop(threadPull.size());
+    }
+    void stop() {
+        running = false;
+        std::lock_guard<std::mutex> lock{sleepMutex};
+        sleepCondVar.notify_all();
+    }
+    void join() {
+        for (auto& t : threadPull) {
+            t.join();
+        }
+        if (nullptr != currentException) {
+            std::rethrow_exception(currentException);
+        }
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::set<std::shared_ptr<Task>, HigherPriority> tasks;
+    };
+    struct ThreadId {
+        const Worker* worker;
+        std::size_t queueId;
+    };
+
+    static ThreadId& currentThread() {
+        static thread_local ThreadId threadId{nullptr, 0};
+        return threadId;
     }
-    void threadFunc() {
+
+    void threadLoop(std::size_t queueId) {
+        currentThread() = ThreadId{this, queueId};
+        Backoff backoff;
         while (running) {
-            std::unique_lock<std::mutex> lk(tasksMutex);
-            while (running && tasks.empty()) {
-                tasksCondVar.wait(lk);
-            }
             try {
-                auto it = std::find_if(tasks.begin(), tasks.end(), [](const std::shared_ptr<Task>& task){return task->isReady();});
-                if (tasks.end() != it) {
-                    const std::shared_ptr<Task> task = std::move(*it);
-                    tasks.erase(it);
-                    lk.unlock();
+                std::shared_ptr<Task> task;
+                if (take(queueId, task)) {
                     task->process();
+                    backoff.reset();
+                } else if (0 == pendingTasks) {
+                    std::unique_lock<std::mutex> lk(sleepMutex);
+                    sleepingThreads++;
+                    sleepCondVar.wait(lk, [this]{return !running || 0 != pendingTasks;});
+                    sleepingThreads--;
+                } else {
+                    backoff.pause();  // there are tasks but none of them is ready
                 }
             } catch (...) {
                 std::lock_guard<std::mutex> lock{excpetionMutex};
@@ -94,26 +138,38 @@ public:
                 }
             }
         }
+        currentThread() = ThreadId{nullptr, 0};
     }
-    void stop() {
-        running = false;
-        tasksCondVar.notify_all();
-    }
-    void join() {
-        for (auto& t : threadPull) {
-            t.join();
-        }
-        if (nullptr != currentException) {
-            std::rethrow_exception(currentException);
+
+    // isReady() is called under the mutex of the task set it belongs to and process() runs in the same thread right after
+    bool take(std::size_t queueId, std::shared_ptr<Task>& task) {
+        for (std::size_t i = 0; i < queues.size(); i++) {
+            TaskQueue& queue = queues[(queueId + i) % queues.size()];
+            std::unique_lock<std::mutex> lk(queue.mutex, std::defer_lock);
+            if (0 == i) {
+                lk.lock();
+            } else if (!lk.try_lock()) {  // the owner or another thief is there, do not wait for it
+                continue;
+            }
+            auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(), [](const std::shared_ptr<Task>& task){return task->isReady();});
+            if (queue.tasks.end() != it) {
+                task = std::move(*it);
+                queue.tasks.erase(it);
+                pendingTasks--;
+                return true;
+            }
         }
+        return false;
     }
 
-private:
-    std::condition_variable tasksCondVar;
-    std::set<std::shared_ptr<Task>, HigherPriority> tasks;
-    std::mutex tasksMutex;
     std::vector<std::thread> threadPull;
+    std::vector<TaskQueue> queues;
     std::atomic<bool> running;
+    std::atomic<std::size_t> pendingTasks;
+    std::atomic<unsigned> sleepingThreads;
+    std::atomic<std::size_t> nextQueue;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondVar;
     std::exception_ptr currentException;
     std::mutex excpetionMutex;
 };
@@ -4,15 +4,17 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <thread>
 #include <vector>
-#include <queue>
 
 #include <opencv2/core/core.hpp>
 
+#include <samples/lock_free_queue.hpp>
+
 class InputChannel;
 
 class IInputSource {
@@ -40,40 +42,38 @@ public:
         source->addSubscriber(tmp);
         return tmp;
     }
+    // Reads of one channel are serialized by the caller and pushes happen under the source lock,
+    // so readQueue has a single producer and a single consumer at any time
     bool read(cv::Mat& mat) {
-        readQueueMutex.lock();
-        if (readQueue.empty()) {
-            readQueueMutex.unlock();
-            source->lock();
-            readQueueMutex.lock();
-            if (readQueue.empty()) {
-                bool res = source->read(mat, shared_from_this());
-                readQueueMutex.unlock();
-                source->unlock();
-                return res;
-            } else {
-                source->unlock();
+        cv::Mat shared;
+        if (!readQueue.pop(shared)) {
+            std::lock_guard<IInputSource> lock(*source);
+            if (!readQueue.pop(shared)) {
+                return source->read(mat, shared_from_this());
             }
         }
-        mat = readQueue.front().clone();
-        readQueue.pop();
-        readQueueMutex.unlock();
+        mat = shared.clone();
         return true;
     }
+    /// Drops the frame if the channel lags readQueueSize frames behind the source, see getDroppedFrames()
     void push(const cv::Mat& mat) {
-        readQueueMutex.lock();
-        readQueue.push(mat);
-        readQueueMutex.unlock();
+        if (!readQueue.push(mat)) {
+            droppedFrames.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    size_t getDroppedFrames() const {
+        return droppedFrames.load(std::memory_order_relaxed);
     }
     cv::Size getSize() {
         return source->getSize();
     }
 
 private:
-    explicit InputChannel(const std::shared_ptr<IInputSource>& source): source{source} {}
+    static constexpr size_t readQueueSize = 16;
+    explicit InputChannel(const std::shared_ptr<IInputSource>& source): source{source}, readQueue{readQueueSize}, droppedFrames{0} {}
     std::shared_ptr<IInputSource> source;
-    std::queue<cv::Mat, std::list<cv::Mat>> readQueue;
-    std::mutex readQueueMutex;
+    SPSCQueue<cv::Mat> readQueue;
+    std::atomic<size_t> droppedFrames;
 };
 
 class VideoCaptureSource: public IInputSource {
@@ -869,6 +869,13 @@ int main(int argc, char* argv[]) {
                 / (frameCounter * context.nireq) * 100;
             std::cout << "Detection InferRequests usage: " << detectionsInfersUsage << "%\n";
         }
+        size_t droppedFrames = 0;
+        for (const auto& inputChannel : inputChannels) {
+            droppedFrames += inputChannel->getDroppedFrames();
+        }
+        if (0 != droppedFrames) {
+            std::cout << "Frames dropped by input channels lagging behind a shared source: " << droppedFrames << "\n";
+        }
     } catch (const std::exception& error) {
         std::cerr << "[ ERROR ] " << error.what() << std::endl;
         return 1;
@@ -69,6 +69,11 @@ public:
     */
     bool Enabled() const;
 
+    /**
+    * @brief Returns config the network was created with
+    */
+    const Config& GetConfig() const;
+
 protected:
     /**
    * @brief Run network
@@ -112,6 +117,11 @@ public:
                  cv::Mat* vector, cv::Size outp_shape = cv::Size()) const;
     void Compute(const std::vector<cv::Mat>& images,
                  std::vector<cv::Mat>* vectors, cv::Size outp_shape = cv::Size()) const;
+
+    /**
+    * @brief Number of values computed for one image, 0 if the network is disabled
+    */
+    int OutputSize() const;
 };
 
 class BaseCnnDetection {
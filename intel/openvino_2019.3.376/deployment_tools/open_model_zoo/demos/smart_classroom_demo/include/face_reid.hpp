@@ -6,6 +6,7 @@
 
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <opencv2/core/core.hpp>
@@ -36,7 +37,8 @@ public:
     EmbeddingsGallery(const std::string& ids_list, double threshold, int min_size_fr,
                       bool crop_gallery, detection::FaceDetection& detector,
                       const VectorCNN& landmarks_det,
-                      const VectorCNN& image_reid);
+                      const VectorCNN& image_reid,
+                      const std::string& cache_path = "", int ivf_lists = 0);
     size_t size() const;
     std::vector<int> GetIDsByEmbeddings(const std::vector<cv::Mat>& embeddings) const;
     std::string GetLabelByID(int id) const;
@@ -52,9 +54,24 @@ private:
                                         const VectorCNN& landmarks_det,
                                         const VectorCNN& image_reid,
                                         cv::Mat & embedding);
+    /// (label, image path) of every gallery entry, in the order of the gallery file
+    using GalleryItems = std::vector<std::pair<std::string, std::string>>;
+    void AddIdentity(const std::string& label, const cv::Mat& embedding);
+    bool LoadCache(const std::string& cache_path, const std::string& key, size_t max_rows, int embedding_size);
+    void SaveCache(const std::string& cache_path, const std::string& key) const;
+    void BuildIndex(int num_lists);
+    cv::Mat ComputeDistances(const cv::Mat& queries) const;
+
     std::vector<int> idx_to_id;
     double reid_threshold;
     std::vector<GalleryObject> identities;
+    /// L2-normalized reference embeddings, one per row
+    cv::Mat gallery_embeddings;
+    /// Normalized centroids of the inverted lists, empty for exact search
+    cv::Mat ivf_centroids;
+    /// Rows of gallery_embeddings in every inverted list and their contiguous copies
+    std::vector<std::vector<int>> ivf_members;
+    std::vector<cv::Mat> ivf_embeddings;
 };
 
 void AlignFaces(std::vector<cv::Mat>* face_images,
@@ -71,6 +71,15 @@ static const char threshold_output_message_face_reid[] = "Optional. Cosine dista
 /// @brief Message for faces gallery path
 static const char reid_gallery_path_message[] = "Optional. Path to a faces gallery in .json format.";
 
+/// @brief Message for faces gallery cache path
+static const char reid_gallery_cache_message[] = "Optional. Path to a binary cache of the faces gallery embeddings. "
+                                                 "It is written after the gallery is built and is read instead of "
+                                                 "the gallery images while the gallery stays the same.";
+
+/// @brief Message for number of inverted lists of faces gallery index
+static const char reid_gallery_ivf_message[] = "Optional. Number of inverted lists for approximate search in a large faces "
+                                               "gallery. 0 (default) means exact search.";
+
 /// @brief Message for output video path
 static const char output_video_message[] = "Optional. File to write output video with visualization to.";
 
@@ -209,6 +218,14 @@ DEFINE_double(t_reid, 0.7, threshold_output_message_face_reid);
 /// It is a optional parameter
 DEFINE_string(fg, "", reid_gallery_path_message);
 
+/// @brief Path to a binary cache of the faces gallery <br>
+/// It is a optional parameter
+DEFINE_string(fg_cache, "", reid_gallery_cache_message);
+
+/// @brief Number of inverted lists of the faces gallery index <br>
+/// It is a optional parameter
+DEFINE_int32(fg_ivf, 0, reid_gallery_ivf_message);
+
 /// @brief File to write output video with visualization to.
 /// It is a optional parameter
 DEFINE_string(out_v, "", output_video_message);
@@ -318,6 +335,8 @@ static void showUsage() {
     std::cout << "    -exp_r_fd                      " << expand_ratio_output_message << std::endl;
     std::cout << "    -t_reid                        " << threshold_output_message_face_reid << std::endl;
     std::cout << "    -fg                            " << reid_gallery_path_message << std::endl;
+    std::cout << "    -fg_cache                      " << reid_gallery_cache_message << std::endl;
+    std::cout << "    -fg_ivf                        " << reid_gallery_ivf_message << std::endl;
     std::cout << "    -teacher_id                    " << teacher_id_message << std::endl;
     std::cout << "    -no_show                       " << no_show_processed_video << std::endl;
     std::cout << "    -last_frame                    " << last_frame_message << std::endl;
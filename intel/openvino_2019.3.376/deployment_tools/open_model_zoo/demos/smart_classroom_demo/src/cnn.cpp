@@ -21,6 +21,10 @@ bool CnnDLSDKBase::Enabled() const {
     return config_.enabled;
 }
 
+const CnnDLSDKBase::Config& CnnDLSDKBase::GetConfig() const {
+    return config_;
+}
+
 void CnnDLSDKBase::Load() {
     CNNNetReader net_reader;
     net_reader.ReadNetwork(config_.path_to_model);
@@ -140,3 +144,11 @@ void VectorCNN::Compute(const std::vector<cv::Mat>& images, std::vector<cv::Mat>
     };
     InferBatch(images, results_fetcher);
 }
+
+int VectorCNN::OutputSize() const {
+    if (!config_.enabled) {
+        return 0;
+    }
+    ConstOutputsDataMap outputs = executable_network_.GetOutputsInfo();
+    return static_cast<int>(outputs.begin()->second->getTensorDesc().getDims()[1]);
+}
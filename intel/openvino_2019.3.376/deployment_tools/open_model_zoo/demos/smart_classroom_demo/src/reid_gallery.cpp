@@ -5,21 +5,65 @@
 #include "face_reid.hpp"
 #include "tracker.hpp"
 
+#include <algorithm>
+#include <cstdint>
 #include <fstream>
 #include <iostream>
+#include <numeric>
 #include <vector>
 #include <string>
 #include <limits>
 
+#include <sys/stat.h>
+
 #include <opencv2/opencv.hpp>
+#include <samples/slog.hpp>
 
 namespace {
-    float ComputeReidDistance(const cv::Mat& descr1, const cv::Mat& descr2) {
-        float xy = static_cast<float>(descr1.dot(descr2));
-        float xx = static_cast<float>(descr1.dot(descr1));
-        float yy = static_cast<float>(descr2.dot(descr2));
-        float norm = sqrt(xx * yy) + 1e-6f;
-        return 1.0f - xy / norm;
+    // Cosine distance given to references of inverted lists that are not probed
+    const float kMaxReidDistance = 2.0f;
+    // A query probes one of every kIvfProbeRatio inverted lists
+    const int kIvfProbeRatio = 8;
+
+    const char kGalleryCacheMagic[] = "FGALLRY2";
+    const size_t kGalleryCacheMagicSize = sizeof(kGalleryCacheMagic) - 1;
+    // Longer labels in a cache file mean that the file is corrupt
+    const uint32_t kMaxCachedLabelSize = 1 << 16;
+
+    template <typename T>
+    void append_value(std::string* key, T value) {
+        key->append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void append_string(std::string* key, const std::string& str) {
+        append_value(key, static_cast<uint32_t>(str.size()));
+        key->append(str);
+    }
+
+    // A file is considered unchanged while its size and modification time stay the same
+    void append_file_stamp(std::string* key, const std::string& path) {
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0) {
+            info.st_size = 0;
+            info.st_mtime = 0;
+        }
+        append_string(key, path);
+        append_value(key, static_cast<int64_t>(info.st_size));
+        append_value(key, static_cast<int64_t>(info.st_mtime));
+    }
+
+    void write_string(std::ofstream& file, const std::string& str) {
+        uint32_t size = static_cast<uint32_t>(str.size());
+        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        file.write(str.data(), size);
+    }
+
+    bool read_string(std::ifstream& file, std::string* str, uint32_t max_size) {
+        uint32_t size = 0;
+        if (!file.read(reinterpret_cast<char*>(&size), sizeof(size)) || size > max_size)
+            return false;
+        str->resize(size);
+        return size == 0 || static_cast<bool>(file.read(&(*str)[0], size));
     }
 
     bool file_exists(const std::string& name) {
@@ -84,7 +128,8 @@ EmbeddingsGallery::EmbeddingsGallery(const std::string& ids_list,
                                      double threshold, int min_size_fr,
                                      bool crop_gallery, detection::FaceDetection& detector,
                                      const VectorCNN& landmarks_det,
-                                     const VectorCNN& image_reid)
+                                     const VectorCNN& image_reid,
+                                     const std::string& cache_path, int ivf_lists)
     : reid_threshold(threshold) {
     if (ids_list.empty()) {
         return;
@@ -96,60 +141,243 @@ EmbeddingsGallery::EmbeddingsGallery(const std::string& ids_list,
 
     cv::FileStorage fs(ids_list, cv::FileStorage::Mode::READ);
     cv::FileNode fn = fs.root();
-    int total_images = 0;
-    int id = 0;
+    GalleryItems items;
     for (cv::FileNodeIterator fit = fn.begin(); fit != fn.end(); ++fit) {
         cv::FileNode item = *fit;
-        std::string label = item.name();
-        std::vector<cv::Mat> embeddings;
         CV_Assert(item.size() == 1);
 
-        for (size_t i = 0; i < item.size(); i++) {
-            std::string path;
-            if (file_exists(item[i].string())) {
-                path = item[i].string();
-            } else {
-                path = folder_name(ids_list) + separator() + item[i].string();
-            }
+        std::string path;
+        if (file_exists(item[0].string())) {
+            path = item[0].string();
+        } else {
+            path = folder_name(ids_list) + separator() + item[0].string();
+        }
+        items.emplace_back(item.name(), path);
+    }
+
+    // Everything the embeddings depend on, the cache is used only if all of it is unchanged
+    std::string cache_key;
+    if (!cache_path.empty()) {
+        append_file_stamp(&cache_key, image_reid.GetConfig().path_to_model);
+        append_file_stamp(&cache_key, image_reid.GetConfig().path_to_weights);
+        append_file_stamp(&cache_key, landmarks_det.GetConfig().path_to_model);
+        append_file_stamp(&cache_key, landmarks_det.GetConfig().path_to_weights);
+        append_value(&cache_key, static_cast<int32_t>(image_reid.OutputSize()));
+        append_value(&cache_key, static_cast<int32_t>(min_size_fr));
+        append_value(&cache_key, static_cast<uint8_t>(crop_gallery));
+        append_value(&cache_key, static_cast<uint32_t>(items.size()));
+        for (const auto& item : items) {
+            append_string(&cache_key, item.first);
+            append_file_stamp(&cache_key, item.second);
+        }
+    }
 
-            cv::Mat image = cv::imread(path);
+    if (cache_path.empty() || !LoadCache(cache_path, cache_key, items.size(), image_reid.OutputSize())) {
+        for (const auto& item : items) {
+            cv::Mat image = cv::imread(item.second);
             CV_Assert(!image.empty());
             cv::Mat emb;
-            RegistrationStatus status = RegisterIdentity(label, image, min_size_fr, crop_gallery,  detector, landmarks_det, image_reid, emb);
+            RegistrationStatus status = RegisterIdentity(item.first, image, min_size_fr, crop_gallery,  detector, landmarks_det, image_reid, emb);
             if (status == RegistrationStatus::SUCCESS) {
-                embeddings.push_back(emb);
-                idx_to_id.push_back(id);
-                total_images++;
-                identities.emplace_back(embeddings, label, id);
-                ++id;
+                AddIdentity(item.first, emb);
+            }
+        }
+        if (!cache_path.empty()) {
+            SaveCache(cache_path, cache_key);
+        }
+    }
+
+    BuildIndex(ivf_lists);
+}
+
+void EmbeddingsGallery::AddIdentity(const std::string& label, const cv::Mat& embedding) {
+    int id = static_cast<int>(identities.size());
+    cv::Mat normalized;
+    cv::normalize(embedding.reshape(1, 1), normalized);
+    gallery_embeddings.push_back(normalized);
+    idx_to_id.push_back(id);
+    identities.emplace_back(std::vector<cv::Mat>{embedding}, label, id);
+}
+
+bool EmbeddingsGallery::LoadCache(const std::string& cache_path, const std::string& key,
+                                  size_t max_rows, int embedding_size) {
+    std::ifstream file(cache_path, std::ios::binary);
+    if (!file.good())
+        return false;
+
+    std::string magic(kGalleryCacheMagicSize, '\0');
+    file.read(&magic[0], kGalleryCacheMagicSize);
+    std::string cached_key;
+    if (!file || magic != kGalleryCacheMagic ||
+        !read_string(file, &cached_key, static_cast<uint32_t>(key.size())) || cached_key != key)
+        return false;
+
+    int32_t rows = 0, cols = 0;
+    file.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+    file.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+    if (!file || rows < 0 || static_cast<size_t>(rows) > max_rows || cols != embedding_size)
+        return false;
+    std::vector<std::string> labels(rows);
+    for (auto& cached_label : labels) {
+        if (!read_string(file, &cached_label, kMaxCachedLabelSize))
+            return false;
+    }
+    // Embeddings are stored normalized and contiguous, so they are read in one go
+    cv::Mat embeddings(rows, cols, CV_32F);
+    file.read(reinterpret_cast<char*>(embeddings.data), embeddings.total() * embeddings.elemSize());
+    if (!file)
+        return false;
+
+    gallery_embeddings = embeddings;
+    for (int i = 0; i < rows; i++) {
+        idx_to_id.push_back(i);
+        identities.emplace_back(std::vector<cv::Mat>{gallery_embeddings.row(i)}, labels[i], i);
+    }
+    slog::info << "Face reid gallery is loaded from " << cache_path << slog::endl;
+    return true;
+}
+
+void EmbeddingsGallery::SaveCache(const std::string& cache_path, const std::string& key) const {
+    std::ofstream file(cache_path, std::ios::binary);
+    file.write(kGalleryCacheMagic, kGalleryCacheMagicSize);
+    write_string(file, key);
+
+    int32_t rows = gallery_embeddings.rows;
+    int32_t cols = gallery_embeddings.empty() ? 1 : gallery_embeddings.cols;
+    file.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+    file.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+    for (const auto& identity : identities) {
+        write_string(file, identity.label);
+    }
+    if (!gallery_embeddings.empty()) {
+        file.write(reinterpret_cast<const char*>(gallery_embeddings.data),
+                   gallery_embeddings.total() * gallery_embeddings.elemSize());
+    }
+    if (!file)
+        slog::warn << "Failed to write face reid gallery cache to " << cache_path << slog::endl;
+}
+
+void EmbeddingsGallery::BuildIndex(int num_lists) {
+    // Small galleries are always searched exactly
+    if (num_lists <= 1 || gallery_embeddings.rows < num_lists)
+        return;
+
+    cv::Mat labels;
+    cv::kmeans(gallery_embeddings, num_lists, labels,
+               cv::TermCriteria(cv::TermCriteria::EPS + cv::TermCriteria::COUNT, 20, 1e-4),
+               1, cv::KMEANS_PP_CENTERS, ivf_centroids);
+    for (int i = 0; i < ivf_centroids.rows; i++) {
+        cv::Mat centroid = ivf_centroids.row(i);
+        cv::normalize(centroid, centroid);
+    }
+
+    ivf_members.assign(num_lists, std::vector<int>());
+    for (int i = 0; i < gallery_embeddings.rows; i++) {
+        ivf_members[labels.at<int>(i)].push_back(i);
+    }
+    ivf_embeddings.resize(num_lists);
+    for (int list = 0; list < num_lists; list++) {
+        const auto& members = ivf_members[list];
+        ivf_embeddings[list].create(static_cast<int>(members.size()), gallery_embeddings.cols, CV_32F);
+        for (size_t k = 0; k < members.size(); k++) {
+            gallery_embeddings.row(members[k]).copyTo(ivf_embeddings[list].row(static_cast<int>(k)));
+        }
+    }
+}
+
+cv::Mat EmbeddingsGallery::ComputeDistances(const cv::Mat& queries) const {
+    cv::Mat similarity;
+    if (ivf_centroids.empty()) {
+        cv::gemm(queries, gallery_embeddings, 1.0, cv::noArray(), 0.0, similarity, cv::GEMM_2_T);
+    } else {
+        similarity = cv::Mat(queries.rows, gallery_embeddings.rows, CV_32F, cv::Scalar(1.0f - kMaxReidDistance));
+        cv::Mat centroid_similarity, list_similarity;
+        cv::gemm(queries, ivf_centroids, 1.0, cv::noArray(), 0.0, centroid_similarity, cv::GEMM_2_T);
+
+        const int num_probes = std::max(1, ivf_centroids.rows / kIvfProbeRatio);
+        std::vector<int> lists(ivf_centroids.rows);
+        for (int i = 0; i < queries.rows; i++) {
+            const float* scores = centroid_similarity.ptr<float>(i);
+            std::iota(lists.begin(), lists.end(), 0);
+            std::partial_sort(lists.begin(), lists.begin() + num_probes, lists.end(),
+                              [scores](int a, int b) { return scores[a] > scores[b]; });
+
+            float* row = similarity.ptr<float>(i);
+            for (int p = 0; p < num_probes; p++) {
+                const auto& members = ivf_members[lists[p]];
+                if (members.empty())
+                    continue;
+                cv::gemm(queries.row(i), ivf_embeddings[lists[p]], 1.0, cv::noArray(), 0.0,
+                         list_similarity, cv::GEMM_2_T);
+                const float* list_row = list_similarity.ptr<float>(0);
+                for (size_t k = 0; k < members.size(); k++) {
+                    row[members[k]] = list_row[k];
+                }
             }
         }
     }
+
+    cv::Mat distances = 1.0 - similarity;
+    // Rounding may push the similarity of unit vectors slightly above one
+    distances = cv::max(distances, 0.0);
+    return distances;
 }
 
 std::vector<int> EmbeddingsGallery::GetIDsByEmbeddings(const std::vector<cv::Mat>& embeddings) const {
     if (embeddings.empty() || idx_to_id.empty())
         return std::vector<int>();
 
-    cv::Mat distances(static_cast<int>(embeddings.size()), static_cast<int>(idx_to_id.size()), CV_32F);
+    cv::Mat queries(static_cast<int>(embeddings.size()), gallery_embeddings.cols, CV_32F);
+    for (int i = 0; i < queries.rows; i++) {
+        CV_Assert(embeddings[i].total() == static_cast<size_t>(queries.cols));
+        cv::Mat query = queries.row(i);
+        cv::normalize(embeddings[i].reshape(1, 1), query);
+    }
+    cv::Mat distances = ComputeDistances(queries);
 
-    for (int i = 0; i < distances.rows; i++) {
-        int k = 0;
-        for (size_t j = 0; j < identities.size(); j++) {
-            for (const auto& reference_emb : identities[j].embeddings) {
-                distances.at<float>(i, k) = ComputeReidDistance(embeddings[i], reference_emb);
-                k++;
+    // An optimal assignment gives every query one of its `rows` closest references: the other
+    // queries hold at most rows - 1 of them, so any other reference can be swapped for a free one
+    // without raising the cost. Solving over these columns only keeps KuhnMunkres small.
+    std::vector<int> candidates;
+    cv::Mat assignment_distances;
+    if (distances.cols > distances.rows) {
+        std::vector<uchar> is_candidate(distances.cols, 0);
+        std::vector<int> order(distances.cols);
+        for (int i = 0; i < distances.rows; i++) {
+            const float* row = distances.ptr<float>(i);
+            std::iota(order.begin(), order.end(), 0);
+            std::nth_element(order.begin(), order.begin() + (distances.rows - 1), order.end(),
+                             [row](int a, int b) { return row[a] < row[b]; });
+            for (int k = 0; k < distances.rows; k++) {
+                is_candidate[order[k]] = 1;
             }
         }
+        for (int j = 0; j < distances.cols; j++) {
+            if (is_candidate[j])
+                candidates.push_back(j);
+        }
+        assignment_distances.create(distances.rows, static_cast<int>(candidates.size()), CV_32F);
+        for (int i = 0; i < distances.rows; i++) {
+            for (size_t k = 0; k < candidates.size(); k++) {
+                assignment_distances.at<float>(i, static_cast<int>(k)) = distances.at<float>(i, candidates[k]);
+            }
+        }
+    } else {
+        candidates.resize(distances.cols);
+        std::iota(candidates.begin(), candidates.end(), 0);
+        assignment_distances = distances;
     }
+
     KuhnMunkres matcher;
-    auto matched_idx = matcher.Solve(distances);
+    auto matched_idx = matcher.Solve(assignment_distances);
     std::vector<int> output_ids;
     for (auto col_idx : matched_idx) {
-        if (distances.at<float>(output_ids.size(), col_idx) > reid_threshold)
+        // Queries left without a reference (more faces than the gallery holds) are unknown
+        if (col_idx >= candidates.size() ||
+            distances.at<float>(static_cast<int>(output_ids.size()), candidates[col_idx]) > reid_threshold)
             output_ids.push_back(unknown_id);
         else
-            output_ids.push_back(idx_to_id[col_idx]);
+            output_ids.push_back(idx_to_id[candidates[col_idx]]);
     }
     return output_ids;
 }